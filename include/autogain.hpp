@@ -12,11 +12,31 @@ class AutoGain : public PluginBase {
 
   GstElement* autogain = nullptr;
 
+  sigc::connection telemetry_connection;
+
   sigc::signal<void, float> momentary, shortterm, integrated, relative,
       loudness, range, gain;
 
+  void set_output_device(const std::string& name);
+
+  // used by the pipelines that process a single application
+  void set_app_name(const std::string& name);
+
+  // saves the measurements and selects the group of the current preset
+  void update_warm_start_group();
+
  private:
+  void create_bin() override;
+  void release_bin() override;
+
+  GSettings* app_settings = nullptr;
+
+  std::string output_device, app_name, warm_start_group;
+
   void bind_to_gsettings();
+
+  void load_warm_start();
+  void save_warm_start();
 };
 
 #endif
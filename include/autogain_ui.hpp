@@ -21,7 +21,7 @@ class AutoGainUi : public Gtk::Grid, public PluginUiBase {
 
  private:
   Glib::RefPtr<Gtk::Adjustment> input_gain, output_gain, target, weight_m,
-      weight_s, weight_i;
+      weight_s, weight_i, analysis_interval;
   Gtk::LevelBar *m_level, *s_level, *i_level, *r_level, *g_level, *l_level,
       *lra_level;
   Gtk::Label *m_label, *s_label, *i_label, *r_label, *g_label, *l_label,
@@ -19,6 +19,9 @@ class Compressor : public PluginBase {
   sigc::signal<void, double> reduction, sidechain, curve;
 
  private:
+  void create_bin() override;
+  void release_bin() override;
+
   void bind_to_gsettings();
 };
 
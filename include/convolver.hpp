@@ -12,7 +12,16 @@ class Convolver : public PluginBase {
 
   GstElement* convolver = nullptr;
 
+  sigc::connection frames_connection;
+
+  int original_n_frames = 0, kernel_n_frames = 0;  // last values emitted
+
+  sigc::signal<void, int, int> kernel_frames;  // original and convolved
+
  private:
+  void create_bin() override;
+  void release_bin() override;
+
   void bind_to_gsettings();
 };
 
@@ -21,18 +21,21 @@ class ConvolverUi : public Gtk::Grid, public PluginUiBase {
               const std::string& settings_name);
   virtual ~ConvolverUi();
 
+  void on_new_kernel_frames(int original, int frames);
+
  private:
   std::string log_tag = "convolver_ui: ";
 
-  Glib::RefPtr<Gtk::Adjustment> input_gain, output_gain, ir_width;
+  Glib::RefPtr<Gtk::Adjustment> input_gain, output_gain, ir_width,
+      trim_threshold;
   Gtk::ListBox* irs_listbox;
   Gtk::MenuButton* irs_menu_button;
   Gtk::ScrolledWindow* irs_scrolled_window;
   Gtk::Button* import_irs;
   Gtk::DrawingArea *left_plot, *right_plot;
   Gtk::Label *label_file_name, *label_sampling_rate, *label_samples,
-      *label_duration;
-  Gtk::ToggleButton* show_fft;
+      *label_duration, *label_convolved;
+  Gtk::ToggleButton *show_fft, *auto_tune, *trim_tail, *minimum_phase;
 
   Pango::FontDescription font;
 
@@ -13,6 +13,9 @@ class Crossfeed : public PluginBase {
   GstElement* crossfeed = nullptr;
 
  private:
+  void create_bin() override;
+  void release_bin() override;
+
   void bind_to_gsettings();
 };
 
@@ -17,6 +17,9 @@ class Deesser : public PluginBase {
   sigc::signal<void, double> compression, detected;
 
  private:
+  void create_bin() override;
+  void release_bin() override;
+
   void bind_to_gsettings();
 };
 
@@ -33,8 +33,15 @@ class EffectsBaseUi {
   template <typename T>
   void add_to_listbox(T p) {
     auto row = Gtk::manage(new Gtk::ListBoxRow());
+    auto box = Gtk::manage(new Gtk::Box(Gtk::ORIENTATION_HORIZONTAL, 6));
 
-    row->add(*p->listbox_control);
+    box->pack_start(*p->listbox_control, true, true);
+
+    add_boundary_button(box, p->name);
+
+    box->show();
+
+    row->add(*box);
     row->set_name(p->name);
     row->set_margin_bottom(6);
     row->set_margin_right(6);
@@ -51,6 +58,8 @@ class EffectsBaseUi {
   std::vector<AppInfoUi*> apps_list;
 
   int on_listbox_sort(Gtk::ListBoxRow* row1, Gtk::ListBoxRow* row2);
+
+  void add_boundary_button(Gtk::Box* box, const std::string& name);
 };
 
 #endif
@@ -18,6 +18,9 @@ class Equalizer : public PluginBase {
   void update_equalizer();
 
  private:
+  void create_bin() override;
+  void release_bin() override;
+
   GSettings *settings_left = nullptr, *settings_right = nullptr;
 
   void bind_band(GstElement* equalizer, const int index);
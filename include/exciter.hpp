@@ -17,6 +17,9 @@ class Exciter : public PluginBase {
   sigc::signal<void, double> harmonics;
 
  private:
+  void create_bin() override;
+  void release_bin() override;
+
   void bind_to_gsettings();
 };
 
@@ -17,6 +17,9 @@ class Gate : public PluginBase {
   sigc::signal<void, double> gating;
 
  private:
+  void create_bin() override;
+  void release_bin() override;
+
   void bind_to_gsettings();
 };
 
@@ -26,15 +26,16 @@ class GeneralSettingsUi : public Gtk::Grid {
  private:
   std::string log_tag = "general_settings_ui: ";
 
-  Glib::RefPtr<Gio::Settings> settings;
+  Glib::RefPtr<Gio::Settings> settings, sie_settings, soe_settings;
 
   Application* app;
 
   Gtk::Switch *enable_autostart, *enable_all_sinkinputs,
-      *enable_all_sourceoutputs, *theme_switch;
+      *enable_all_sourceoutputs, *parallel_sinkinputs, *theme_switch;
   Gtk::Button *reset_settings, *about_button;
   Gtk::SpinButton *realtime_priority_control, *niceness_control;
-  Gtk::ComboBoxText* priority_type;
+  Gtk::ComboBoxText *priority_type, *pipelining_sinkinputs,
+      *pipelining_sourceoutputs;
 
   Glib::RefPtr<Gtk::Adjustment> adjustment_priority, adjustment_niceness;
 
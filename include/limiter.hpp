@@ -19,6 +19,9 @@ class Limiter : public PluginBase {
   sigc::signal<void, double> attenuation;
 
  private:
+  void create_bin() override;
+  void release_bin() override;
+
   void bind_to_gsettings();
 };
 
@@ -17,6 +17,9 @@ class Maximizer : public PluginBase {
   sigc::signal<void, double> reduction;
 
  private:
+  void create_bin() override;
+  void release_bin() override;
+
   void bind_to_gsettings();
 };
 
@@ -24,6 +24,9 @@ class MultibandCompressor : public PluginBase {
       compression1, compression2, compression3;
 
  private:
+  void create_bin() override;
+  void release_bin() override;
+
   void bind_to_gsettings();
 };
 
@@ -24,6 +24,9 @@ class MultibandGate : public PluginBase {
       gating1, gating2, gating3;
 
  private:
+  void create_bin() override;
+  void release_bin() override;
+
   void bind_to_gsettings();
 };
 
@@ -48,10 +48,11 @@ class PipelineBase {
   std::array<double, 2> get_peak(GstMessage* message);
 
   void set_source_monitor_name(std::string name);
-  void set_output_sink_name(std::string name);
+  virtual void set_output_sink_name(std::string name);
   void set_null_pipeline();
   void update_pipeline_state();
   void get_latency();
+  GstClockTime get_queues_latency();
   void init_spectrum(const uint& sampling_rate);
   void update_spectrum_interval(const double& value);
 
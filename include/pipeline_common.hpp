@@ -3,6 +3,8 @@
 
 #include <gio/gio.h>
 #include <gst/gst.h>
+#include <algorithm>
+#include <cmath>
 #include <mutex>
 #include "util.hpp"
 
@@ -178,6 +180,213 @@ void on_plugins_order_changed(GSettings* settings, gchar* key, T* l) {
   g_object_unref(srcpad);
 }
 
+/*
+  Thread boundaries split the effects chain in stages that run on different
+  cores. A boundary after a plugin makes its queue push the data from a new
+  streaming thread. Each one adds one buffer of latency.
+*/
+
+constexpr auto pipelining_interval = 5;  // seconds
+
+// load of the busiest stage when we add or remove a boundary
+
+constexpr double max_stage_load = 0.5;
+constexpr double min_stage_load = 0.35;
+
+template <typename T>
+std::vector<std::string> get_boundaries(T* l) {
+  std::vector<std::string> boundaries;
+
+  for (auto& name : l->plugins_order) {
+    gboolean threaded;
+
+    g_object_get(l->plugin_bases[name]->queue, "threaded", &threaded, nullptr);
+
+    if (threaded) {
+      boundaries.push_back(name);
+    }
+  }
+
+  return boundaries;
+}
+
+template <typename T>
+std::vector<std::string> get_manual_boundaries(T* l) {
+  gchar* name;
+  GVariantIter* iter;
+  std::vector<std::string> list, boundaries;
+
+  g_settings_get(l->child_settings, "thread-boundaries", "as", &iter);
+
+  while (g_variant_iter_next(iter, "s", &name)) {
+    list.push_back(name);
+    g_free(name);
+  }
+
+  g_variant_iter_free(iter);
+
+  for (auto& name : l->plugins_order) {
+    if (std::find(list.begin(), list.end(), name) != list.end()) {
+      boundaries.push_back(name);
+    }
+  }
+
+  return boundaries;
+}
+
+template <typename T>
+double get_stages_load(T* l, const std::vector<std::string>& boundaries) {
+  double stage = 0.0, busiest = 0.0;
+
+  for (auto& name : l->plugins_order) {
+    stage += l->plugin_bases[name]->load;
+
+    if (std::find(boundaries.begin(), boundaries.end(), name) !=
+        boundaries.end()) {
+      busiest = std::max(busiest, stage);
+
+      stage = 0.0;
+    }
+  }
+
+  return std::max(busiest, stage);
+}
+
+/*
+  We use as few stages as possible because of the latency. The chain is cut
+  where the accumulated load reaches the average stage load.
+*/
+
+template <typename T>
+std::vector<std::string> get_auto_boundaries(T* l) {
+  double total = 0.0;
+
+  for (auto& name : l->plugins_order) {
+    total += l->plugin_bases[name]->load;
+  }
+
+  uint n_current = get_boundaries(l).size() + 1;
+  uint n_up = std::ceil(total / max_stage_load);
+  uint n_down = std::ceil(total / min_stage_load);
+  uint n_stages = n_current;
+
+  if (n_up > n_current) {
+    n_stages = n_up;
+  } else if (n_down < n_current) {
+    n_stages = n_down;
+  }
+
+  n_stages = std::min(std::max(n_stages, 1u), g_get_num_processors());
+
+  std::vector<std::string> boundaries;
+  double stage = 0.0, target = total / n_stages;
+
+  for (long unsigned int n = 0; n + 1 < l->plugins_order.size(); n++) {
+    auto& name = l->plugins_order[n];
+
+    stage += l->plugin_bases[name]->load;
+
+    if (stage >= target && boundaries.size() + 1 < n_stages) {
+      boundaries.push_back(name);
+
+      stage = 0.0;
+    }
+  }
+
+  return boundaries;
+}
+
+/*
+  The queues start or stop their threads between two buffers. So the
+  boundaries can be moved while we are playing without interrupting the audio.
+*/
+
+template <typename T>
+void set_boundaries(T* l, const std::vector<std::string>& boundaries) {
+  if (boundaries == get_boundaries(l)) {
+    return;
+  }
+
+  std::string list;
+
+  for (auto& name : l->plugins_order) {
+    bool threaded = std::find(boundaries.begin(), boundaries.end(), name) !=
+                    boundaries.end();
+
+    g_object_set(l->plugin_bases[name]->queue, "threaded", threaded, nullptr);
+
+    if (threaded) {
+      list += name + ",";
+    }
+  }
+
+  util::debug(l->log_tag + "thread boundaries after: [" + list + "]");
+}
+
+template <typename T>
+gboolean on_pipelining_timeout(gpointer user_data) {
+  auto l = static_cast<T*>(user_data);
+
+  GstState state, pending;
+
+  gst_element_get_state(l->pipeline, &state, &pending, 0);
+
+  // the plugins load is only measured while we are playing
+
+  if (state != GST_STATE_PLAYING) {
+    return G_SOURCE_CONTINUE;
+  }
+
+  auto current = get_boundaries(l);
+  auto boundaries = get_auto_boundaries(l);
+
+  if (boundaries == current) {
+    return G_SOURCE_CONTINUE;
+  }
+
+  // with the same number of stages we only move a boundary if it pays off
+
+  if (boundaries.size() == current.size() &&
+      get_stages_load(l, boundaries) > 0.8 * get_stages_load(l, current)) {
+    return G_SOURCE_CONTINUE;
+  }
+
+  set_boundaries(l, boundaries);
+
+  return G_SOURCE_CONTINUE;
+}
+
+template <typename T>
+void update_pipelining(T* l) {
+  auto mode = g_settings_get_enum(l->child_settings, "pipelining");
+
+  if (mode == 2) {  // Automatic
+    if (l->pipelining_source == 0) {
+      l->pipelining_source = g_timeout_add_seconds(
+          pipelining_interval, on_pipelining_timeout<T>, l);
+    }
+
+    return;
+  }
+
+  if (l->pipelining_source != 0) {
+    g_source_remove(l->pipelining_source);
+
+    l->pipelining_source = 0;
+  }
+
+  if (mode == 1) {  // Manual
+    set_boundaries(l, get_manual_boundaries(l));
+  } else {
+    set_boundaries(l, std::vector<std::string>());
+  }
+}
+
+template <typename T>
+void on_pipelining_changed(GSettings* settings, gchar* key, T* l) {
+  update_pipelining(l);
+}
+
 }  // namespace
 
 #endif
@@ -5,8 +5,10 @@
 #include <gst/gst.h>
 #include <sigc++/sigc++.h>
 #include <array>
+#include <atomic>
 #include <iostream>
 #include <mutex>
+#include <vector>
 
 class PluginBase {
  public:
@@ -17,19 +19,38 @@ class PluginBase {
 
   std::string log_tag, name;
   GstElement *plugin = nullptr, *bin = nullptr, *identity_in = nullptr,
-             *identity_out = nullptr;
+             *identity_out = nullptr, *queue = nullptr;
 
   std::mutex plugin_mutex;
 
+  // processing time as a fraction of the buffer duration
+
+  std::atomic<double> load{0.0};
+  gint64 buffer_start = 0;
+
   bool plugin_is_installed = false;
 
   void enable();
   void disable();
 
+  void release();
+
  protected:
   GSettings* settings = nullptr;
 
-  bool is_installed(GstElement* e);
+  bool is_installed(const std::string& factory_name);
+
+  virtual void create_bin() = 0;
+  virtual void release_bin() = 0;
+
+  GstElement* make_converter(GstElement* e, const std::string& pad_name);
+
+  void add_to_bin(const std::vector<GstElement*>& elements);
+
+ private:
+  guint release_source = 0;
+
+  void materialize();
 };
 
 #endif
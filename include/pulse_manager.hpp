@@ -8,7 +8,9 @@
 #include <algorithm>
 #include <array>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
 
 struct myServerInfo {
   std::string server_name;
@@ -78,6 +80,7 @@ class PulseManager {
   void find_sinks();
   void find_sources();
   void move_sink_input_to_pulseeffects(const std::string& name, uint idx);
+  bool move_sink_input_to_main(const std::string& name, uint idx);
   void remove_sink_input_from_pulseeffects(const std::string& name, uint idx);
   void move_source_output_to_pulseeffects(const std::string& name, uint idx);
   void remove_source_output_from_pulseeffects(const std::string& name,
@@ -93,6 +96,8 @@ class PulseManager {
                                 uint value);
   void set_source_output_mute(const std::string& name, uint idx, bool state);
   void get_sink_input_info(uint idx);
+  std::shared_ptr<mySinkInfo> load_app_sink(uint idx);
+  void unload_app_sink(uint idx);
 
   sigc::signal<void, std::shared_ptr<mySourceInfo>> source_added;
   sigc::signal<void, uint> source_removed;
@@ -115,6 +120,11 @@ class PulseManager {
   pa_mainloop_api* main_loop_api = nullptr;
   pa_context* context = nullptr;
 
+  // sinks of the applications that have their own effects pipeline
+
+  std::mutex app_sinks_mutex;
+  std::map<uint, std::shared_ptr<mySinkInfo>> app_sinks;
+
   std::array<std::string, 10> blacklist_apps = {"PulseEffects",
                                                 "pulseeffects",
                                                 "PulseEffectsWebrtcProbe",
@@ -152,6 +162,8 @@ class PulseManager {
 
   void unload_module(uint idx);
 
+  bool move_sink_input(const std::string& name, uint idx, uint sink_idx);
+
   void unload_sinks();
 
   void drain_context();
@@ -172,6 +184,10 @@ class PulseManager {
 
   uint get_latency(const pa_sink_input_info* info) { return info->sink_usec; }
 
+  static bool is_app_sink(const std::string& name) {
+    return name.rfind("PulseEffects_apps_", 0) == 0;
+  }
+
   uint get_latency(const pa_source_output_info* info) {
     return info->source_usec;
   }
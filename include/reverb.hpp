@@ -17,6 +17,9 @@ class Reverb : public PluginBase {
   sigc::signal<void, std::array<double, 2>> input_level, output_level;
 
  private:
+  void create_bin() override;
+  void release_bin() override;
+
   void bind_to_gsettings();
 };
 
@@ -27,6 +27,9 @@
 class SinkInputEffects : public PipelineBase {
  public:
   SinkInputEffects(PulseManager* pulse_manager);
+  SinkInputEffects(PulseManager* pulse_manager,
+                   const std::shared_ptr<mySinkInfo>& app_sink,
+                   const std::string& output_sink);
   virtual ~SinkInputEffects();
 
   std::string log_tag;
@@ -35,6 +38,9 @@ class SinkInputEffects : public PipelineBase {
 
   std::vector<std::string> plugins_order, plugins_order_old;
   std::map<std::string, GstElement*> plugins;
+  std::map<std::string, PluginBase*> plugin_bases;
+
+  guint pipelining_source = 0;
 
   std::unique_ptr<Limiter> limiter;
   std::unique_ptr<Compressor> compressor;
@@ -57,6 +63,10 @@ class SinkInputEffects : public PipelineBase {
   std::unique_ptr<AutoGain> autogain;
   std::unique_ptr<Delay> delay;
 
+  // effects pipelines of the applications in the parallel mode
+
+  std::map<uint, std::unique_ptr<SinkInputEffects>> app_pipelines;
+
   sigc::signal<void, std::array<double, 2>> equalizer_input_level;
   sigc::signal<void, std::array<double, 2>> equalizer_output_level;
   sigc::signal<void, std::array<double, 2>> pitch_input_level;
@@ -84,10 +94,20 @@ class SinkInputEffects : public PipelineBase {
   sigc::signal<void, std::array<double, 2>> delay_input_level;
   sigc::signal<void, std::array<double, 2>> delay_output_level;
 
+  void set_output_sink_name(std::string name) override;
+
  private:
+  void bind_to_gsettings();
+  void init_plugins();
   void add_plugins_to_pipeline();
 
   void on_app_added(const std::shared_ptr<AppInfo>& app_info);
+  void on_app_changed(const std::shared_ptr<AppInfo>& app_info);
+  void on_app_removed(uint idx);
+
+  bool update_app_pipeline(const std::shared_ptr<AppInfo>& app_info);
+  bool add_app_pipeline(const std::shared_ptr<AppInfo>& app_info);
+  void remove_app_pipeline(uint idx);
 };
 
 #endif
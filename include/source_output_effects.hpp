@@ -26,6 +26,9 @@ class SourceOutputEffects : public PipelineBase {
 
   std::vector<std::string> plugins_order, plugins_order_old;
   std::map<std::string, GstElement*> plugins;
+  std::map<std::string, PluginBase*> plugin_bases;
+
+  guint pipelining_source = 0;
 
   std::unique_ptr<Limiter> limiter;
   std::unique_ptr<Compressor> compressor;
@@ -17,6 +17,11 @@ class Webrtc : public PluginBase {
   void set_probe_src_device(std::string name);
 
  private:
+  std::string probe_src_device;
+
+  void create_bin() override;
+  void release_bin() override;
+
   void build_probe_bin();
   void build_dsp_bin();
   void bind_to_gsettings();
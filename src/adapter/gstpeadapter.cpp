@@ -1,5 +1,6 @@
 #include "gstpeadapter.hpp"
 #include <gst/audio/audio.h>
+#include <algorithm>
 #include "config.h"
 #include "util.hpp"
 
@@ -36,6 +37,20 @@ static void gst_peadapter_finalize(GObject* object);
 
 static GstFlowReturn gst_peadapter_process(GstPeadapter* peadapter);
 
+static void gst_peadapter_setup_pool(GstPeadapter* peadapter);
+
+static bool gst_peadapter_configure_pool(GstPeadapter* peadapter,
+                                         GstBufferPool* pool,
+                                         GstCaps* caps,
+                                         guint min_buffers,
+                                         guint max_buffers,
+                                         GstAllocator* allocator,
+                                         GstAllocationParams* params);
+
+static void gst_peadapter_free_pool(GstPeadapter* peadapter);
+
+static void gst_peadapter_choose_blocksize(GstPeadapter* peadapter);
+
 static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE(
     "sink",
     GST_PAD_SINK,
@@ -53,6 +68,7 @@ static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE(
 enum { PROP_BLOCKSIZE = 1 };
 
 enum {
+  BLOCKSIZE_AUTO = 0,
   BLOCKSIZE_64 = 64,
   BLOCKSIZE_128 = 128,
   BLOCKSIZE_256 = 256,
@@ -75,6 +91,7 @@ static GType gst_peadapter_blocksize_get_type(void) {
         {BLOCKSIZE_1024, "Block size 1024", "1024"},
         {BLOCKSIZE_2048, "Block size 2048", "2048"},
         {BLOCKSIZE_4096, "Block size 4096", "4096"},
+        {BLOCKSIZE_AUTO, "Chosen from the input period", "auto"},
         {0, NULL, NULL}};
 
     gtype = g_enum_register_static("GstPeadapterBlockSize", values);
@@ -125,8 +142,10 @@ static void gst_peadapter_init(GstPeadapter* peadapter) {
   peadapter->rate = -1;
   peadapter->bpf = -1;
   peadapter->blocksize = 512;
+  peadapter->auto_blocksize = false;
   peadapter->inbuf_n_samples = -1;
   peadapter->flag_discont = false;
+  peadapter->pool_dirty = true;
   peadapter->adapter = gst_adapter_new();
 
   peadapter->srcpad = gst_pad_new_from_static_template(&srctemplate, "src");
@@ -159,7 +178,18 @@ static void gst_peadapter_set_property(GObject* object,
 
   switch (prop_id) {
     case PROP_BLOCKSIZE:
-      peadapter->blocksize = g_value_get_enum(value);
+      if (g_value_get_enum(value) == BLOCKSIZE_AUTO) {
+        peadapter->auto_blocksize = true;
+
+        if (peadapter->inbuf_n_samples != -1) {
+          gst_peadapter_choose_blocksize(peadapter);
+        }
+      } else {
+        peadapter->auto_blocksize = false;
+        peadapter->blocksize = g_value_get_enum(value);
+      }
+
+      peadapter->pool_dirty = true;
 
       gst_element_post_message(
           GST_ELEMENT_CAST(peadapter),
@@ -178,9 +208,15 @@ static void gst_peadapter_get_property(GObject* object,
                                        GParamSpec* pspec) {
   GstPeadapter* peadapter = GST_PEADAPTER(object);
 
+  std::lock_guard<std::mutex> lock(peadapter->lock_guard);
+
   switch (prop_id) {
     case PROP_BLOCKSIZE:
-      g_value_set_enum(value, peadapter->blocksize);
+      if (peadapter->auto_blocksize) {
+        g_value_set_enum(value, BLOCKSIZE_AUTO);
+      } else {
+        g_value_set_enum(value, peadapter->blocksize);
+      }
       break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -214,6 +250,14 @@ static GstFlowReturn gst_peadapter_chain(GstPad* pad,
     util::debug("peadapter: pulseaudio block size " +
                 std::to_string(peadapter->inbuf_n_samples) + " frames");
 
+    if (peadapter->auto_blocksize) {
+      gst_peadapter_choose_blocksize(peadapter);
+
+      gst_element_post_message(
+          GST_ELEMENT_CAST(peadapter),
+          gst_message_new_latency(GST_OBJECT_CAST(peadapter)));
+    }
+
     util::debug("peadapter: we will read in chunks of " +
                 std::to_string(peadapter->blocksize) + " frames");
 
@@ -232,9 +276,35 @@ static GstFlowReturn gst_peadapter_process(GstPeadapter* peadapter) {
 
   gsize nbytes = peadapter->blocksize * peadapter->bpf;
 
-  while (gst_adapter_available(peadapter->adapter) > nbytes &&
+  if (peadapter->pool_dirty || gst_pad_check_reconfigure(peadapter->srcpad)) {
+    gst_peadapter_setup_pool(peadapter);
+  }
+
+  while (gst_adapter_available(peadapter->adapter) >= nbytes &&
          (ret == GST_FLOW_OK)) {
-    GstBuffer* b = gst_adapter_take_buffer(peadapter->adapter, nbytes);
+    GstBuffer* b = nullptr;
+
+    /*
+      Blocks are copied into buffers from our pool. In the steady state this
+      does not allocate memory and every element downstream gets aligned
+      data. If the pool can not give us a buffer the adapter allocates one.
+    */
+
+    if (peadapter->pool != nullptr &&
+        gst_buffer_pool_acquire_buffer(peadapter->pool, &b, nullptr) ==
+            GST_FLOW_OK) {
+      GstMapInfo map;
+
+      gst_buffer_map(b, &map, GST_MAP_WRITE);
+
+      gst_adapter_copy(peadapter->adapter, map.data, 0, nbytes);
+
+      gst_buffer_unmap(b, &map);
+
+      gst_adapter_flush(peadapter->adapter, nbytes);
+    } else {
+      b = gst_adapter_take_buffer(peadapter->adapter, nbytes);
+    }
 
     if (b != nullptr) {
       b = gst_buffer_make_writable(b);
@@ -264,6 +334,148 @@ static GstFlowReturn gst_peadapter_process(GstPeadapter* peadapter) {
   return ret;
 }
 
+/*
+  We ask downstream for a pool with an ALLOCATION query. If nobody proposes
+  one we make our own. Either way the buffers have blocksize frames and are
+  aligned to 64 bytes, whatever alignment downstream asked for.
+*/
+
+static void gst_peadapter_setup_pool(GstPeadapter* peadapter) {
+  gst_peadapter_free_pool(peadapter);
+
+  GstCaps* caps = gst_pad_get_current_caps(peadapter->srcpad);
+
+  if (caps == nullptr) {
+    return;  // we will try again after the caps event
+  }
+
+  peadapter->pool_dirty = false;
+
+  GstQuery* query = gst_query_new_allocation(caps, true);
+  GstBufferPool* pool = nullptr;
+  GstAllocator* allocator = nullptr;
+  GstAllocationParams params;
+  guint size = 0, min_buffers = 0, max_buffers = 0;
+
+  gst_allocation_params_init(&params);
+
+  if (gst_pad_peer_query(peadapter->srcpad, query)) {
+    if (gst_query_get_n_allocation_pools(query) > 0) {
+      gst_query_parse_nth_allocation_pool(query, 0, &pool, &size, &min_buffers,
+                                          &max_buffers);
+    }
+
+    if (gst_query_get_n_allocation_params(query) > 0) {
+      gst_query_parse_nth_allocation_param(query, 0, &allocator, &params);
+    }
+  }
+
+  params.align = std::max(params.align, (gsize)63);  // align is a mask
+
+  if (pool != nullptr &&
+      !gst_peadapter_configure_pool(peadapter, pool, caps, min_buffers,
+                                    max_buffers, allocator, &params)) {
+    util::debug("peadapter: the pool proposed downstream can not be used");
+
+    gst_object_unref(pool);
+
+    pool = nullptr;
+  }
+
+  if (pool == nullptr) {
+    pool = gst_buffer_pool_new();
+
+    if (!gst_peadapter_configure_pool(peadapter, pool, caps, 0, 0, allocator,
+                                      &params)) {
+      util::warning("peadapter: failed to configure the buffer pool");
+
+      gst_object_unref(pool);
+
+      pool = nullptr;
+    }
+  }
+
+  if (pool != nullptr) {
+    peadapter->pool = pool;
+
+    util::debug("peadapter: buffer pool with blocks of " +
+                std::to_string(peadapter->blocksize) + " frames");
+  }
+
+  if (allocator != nullptr) {
+    gst_object_unref(allocator);
+  }
+
+  gst_query_unref(query);
+  gst_caps_unref(caps);
+}
+
+static bool gst_peadapter_configure_pool(GstPeadapter* peadapter,
+                                         GstBufferPool* pool,
+                                         GstCaps* caps,
+                                         guint min_buffers,
+                                         guint max_buffers,
+                                         GstAllocator* allocator,
+                                         GstAllocationParams* params) {
+  guint size = peadapter->blocksize * peadapter->bpf;
+
+  // one buffer being processed and one waiting
+
+  min_buffers = std::max(min_buffers, 2u);
+
+  if (max_buffers != 0) {
+    max_buffers = std::max(max_buffers, min_buffers);
+  }
+
+  GstStructure* config = gst_buffer_pool_get_config(pool);
+
+  gst_buffer_pool_config_set_params(config, caps, size, min_buffers,
+                                    max_buffers);
+
+  gst_buffer_pool_config_set_allocator(config, allocator, params);
+
+  if (!gst_buffer_pool_set_config(pool, config)) {
+    return false;
+  }
+
+  return gst_buffer_pool_set_active(pool, true);
+}
+
+static void gst_peadapter_free_pool(GstPeadapter* peadapter) {
+  if (peadapter->pool != nullptr) {
+    gst_buffer_pool_set_active(peadapter->pool, false);
+
+    gst_object_unref(peadapter->pool);
+
+    peadapter->pool = nullptr;
+  }
+
+  peadapter->pool_dirty = true;
+}
+
+/*
+  The largest power of two that fits in the input period. Larger blocks cost
+  less per frame in the partitioned elements downstream and a block never
+  waits for more than one period of input.
+*/
+
+static void gst_peadapter_choose_blocksize(GstPeadapter* peadapter) {
+  uint period = std::max(peadapter->inbuf_n_samples, 1);
+  uint blocksize = BLOCKSIZE_64;
+
+  while (2 * blocksize <= period && blocksize < BLOCKSIZE_4096) {
+    blocksize *= 2;
+  }
+
+  if ((int)blocksize != peadapter->blocksize) {
+    peadapter->blocksize = blocksize;
+    peadapter->pool_dirty = true;
+  }
+
+  util::debug("peadapter: automatic block size " + std::to_string(blocksize) +
+              " frames");
+}
+
 static gboolean gst_peadapter_sink_event(GstPad* pad,
                                          GstObject* parent,
                                          GstEvent* event) {
@@ -288,6 +500,8 @@ static gboolean gst_peadapter_sink_event(GstPad* pad,
 
       ret = gst_pad_push_event(peadapter->srcpad, event);
 
+      peadapter->pool_dirty = true;
+
       break;
     case GST_EVENT_EOS:
       gst_peadapter_process(peadapter);
@@ -332,6 +546,8 @@ static GstStateChangeReturn gst_peadapter_change_state(
     case GST_STATE_CHANGE_PAUSED_TO_READY:
       gst_adapter_clear(peadapter->adapter);
 
+      gst_peadapter_free_pool(peadapter);
+
       peadapter->inbuf_n_samples = -1;
 
       break;
@@ -407,6 +623,8 @@ void gst_peadapter_finalize(GObject* object) {
   gst_adapter_clear(peadapter->adapter);
   g_object_unref(peadapter->adapter);
 
+  gst_peadapter_free_pool(peadapter);
+
   /* clean up object here */
 
   G_OBJECT_CLASS(gst_peadapter_parent_class)->finalize(object);
@@ -31,6 +31,7 @@ struct _GstPeadapter {
   /* properties */
 
   int blocksize;  // number of samples in the outout buffer
+  bool auto_blocksize;  // blocksize is chosen from the chain and the period
 
   /*< private >*/
 
@@ -38,8 +39,10 @@ struct _GstPeadapter {
   int bpf;              // bytes per frame : channels * bps
   int inbuf_n_samples;  // number of samples in the input buffer
   bool flag_discont;
+  bool pool_dirty;  // the pool has to be negotiated again
 
   GstAdapter* adapter = nullptr;
+  GstBufferPool* pool = nullptr;  // fixed size and 64 bytes aligned buffers
   GstPad* srcpad = nullptr;
   GstPad* sinkpad = nullptr;
 
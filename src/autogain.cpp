@@ -1,134 +1,145 @@
 #include "autogain.hpp"
 #include <glibmm/main.h>
+#include <algorithm>
+#include <cmath>
 #include "util.hpp"
 
 namespace {
 
-void on_m_changed(GObject* gobject, GParamSpec* pspec, AutoGain* a) {
-  float v;
+/*
+  The last loudness measurements are saved for each output device and preset
+  so the next session can start with the right gain.
+*/
 
-  g_object_get(a->autogain, "m", &v, nullptr);
-
-  Glib::signal_idle().connect_once([=] { a->momentary.emit(v); });
+std::string get_warm_start_dir() {
+  return std::string(g_get_user_cache_dir()) + "/PulseEffects";
 }
 
-void on_s_changed(GObject* gobject, GParamSpec* pspec, AutoGain* a) {
-  float v;
-
-  g_object_get(a->autogain, "s", &v, nullptr);
-
-  Glib::signal_idle().connect_once([=] { a->shortterm.emit(v); });
+std::string get_warm_start_path() {
+  return get_warm_start_dir() + "/autogain.ini";
 }
 
-void on_i_changed(GObject* gobject, GParamSpec* pspec, AutoGain* a) {
-  float v;
+/*
+  The measurements are polled from the main loop. This way the streaming
+  thread of peautogain never emits GObject signals.
+*/
+
+void on_post_messages_changed(GSettings* settings, gchar* key, AutoGain* a) {
+  auto post = g_settings_get_boolean(settings, key);
+
+  if (post) {
+    if (!a->telemetry_connection.connected()) {
+      a->telemetry_connection = Glib::signal_timeout().connect(
+          [a]() {
+            if (a->autogain == nullptr) {
+              return true;
+            }
+
+            float m, s, i, r, l, lra, g;
+
+            g_object_get(a->autogain, "m", &m, "s", &s, "i", &i, "r", &r, "l",
+                         &l, "lra", &lra, "g", &g, nullptr);
+
+            a->momentary.emit(m);
+            a->shortterm.emit(s);
+            a->integrated.emit(i);
+            a->relative.emit(r);
+            a->loudness.emit(l);
+            a->range.emit(lra);
+            a->gain.emit(g);
+
+            return true;
+          },
+          100);
+    }
+  } else {
+    a->telemetry_connection.disconnect();
+  }
+}
 
-  g_object_get(a->autogain, "i", &v, nullptr);
+/*
+  Measurements made with the previous preset are saved under its name before
+  we switch to the new one.
+*/
 
-  Glib::signal_idle().connect_once([=] { a->integrated.emit(v); });
+void on_last_used_preset_changed(GSettings* settings,
+                                 gchar* key,
+                                 AutoGain* a) {
+  a->update_warm_start_group();
 }
 
-void on_r_changed(GObject* gobject, GParamSpec* pspec, AutoGain* a) {
-  float v;
+}  // namespace
 
-  g_object_get(a->autogain, "r", &v, nullptr);
+AutoGain::AutoGain(const std::string& tag, const std::string& schema)
+    : PluginBase(tag, "autogain", schema) {
+  if (is_installed("peautogain")) {
+    g_signal_connect(settings, "changed::post-messages",
+                     G_CALLBACK(on_post_messages_changed), this);
 
-  Glib::signal_idle().connect_once([=] { a->relative.emit(v); });
-}
+    app_settings = g_settings_new("com.github.wwmm.pulseeffects");
+
+    g_signal_connect(app_settings, "changed::last-used-preset",
+                     G_CALLBACK(on_last_used_preset_changed), this);
 
-void on_l_changed(GObject* gobject, GParamSpec* pspec, AutoGain* a) {
-  float v;
+    // useless write just to force callback call
 
-  g_object_get(a->autogain, "l", &v, nullptr);
+    auto enable = g_settings_get_boolean(settings, "state");
 
-  Glib::signal_idle().connect_once([=] { a->loudness.emit(v); });
+    g_settings_set_boolean(settings, "state", enable);
+  }
 }
 
-void on_lra_changed(GObject* gobject, GParamSpec* pspec, AutoGain* a) {
-  float v;
+AutoGain::~AutoGain() {
+  telemetry_connection.disconnect();
+
+  save_warm_start();
 
-  g_object_get(a->autogain, "lra", &v, nullptr);
+  if (app_settings != nullptr) {
+    g_object_unref(app_settings);
+  }
 
-  Glib::signal_idle().connect_once([=] { a->range.emit(v); });
+  util::debug(log_tag + name + " destroyed");
 }
 
-void on_g_changed(GObject* gobject, GParamSpec* pspec, AutoGain* a) {
-  float v;
-
-  g_object_get(a->autogain, "g", &v, nullptr);
+void AutoGain::create_bin() {
+  autogain = gst_element_factory_make("peautogain", nullptr);
 
-  Glib::signal_idle().connect_once([=] { a->gain.emit(v); });
-}
+  auto in_level =
+      gst_element_factory_make("pegainmeter", "autogain_input_level");
+  auto out_level =
+      gst_element_factory_make("pegainmeter", "autogain_output_level");
+  auto audioconvert_in = make_converter(autogain, "sink");
+  auto audioconvert_out = make_converter(autogain, "src");
 
-}  // namespace
+  add_to_bin({in_level, audioconvert_in, autogain, audioconvert_out,
+              out_level});
 
-AutoGain::AutoGain(const std::string& tag, const std::string& schema)
-    : PluginBase(tag, "autogain", schema) {
-  autogain = gst_element_factory_make("peautogain", nullptr);
+  bind_to_gsettings();
 
-  if (is_installed(autogain)) {
-    auto input_gain = gst_element_factory_make("volume", nullptr);
-    auto in_level = gst_element_factory_make("level", "autogain_input_level");
-    auto output_gain = gst_element_factory_make("volume", nullptr);
-    auto out_level = gst_element_factory_make("level", "autogain_output_level");
-    auto audioconvert_in =
-        gst_element_factory_make("audioconvert", "autogain_audioconvert_in");
-    auto audioconvert_out =
-        gst_element_factory_make("audioconvert", "autogain_audioconvert_out");
-
-    gst_bin_add_many(GST_BIN(bin), input_gain, in_level, audioconvert_in,
-                     autogain, audioconvert_out, output_gain, out_level,
-                     nullptr);
-
-    gst_element_link_many(input_gain, in_level, audioconvert_in, autogain,
-                          audioconvert_out, output_gain, out_level, nullptr);
-
-    auto pad_sink = gst_element_get_static_pad(input_gain, "sink");
-    auto pad_src = gst_element_get_static_pad(out_level, "src");
-
-    gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad_sink));
-    gst_element_add_pad(bin, gst_ghost_pad_new("src", pad_src));
-
-    gst_object_unref(GST_OBJECT(pad_sink));
-    gst_object_unref(GST_OBJECT(pad_src));
-
-    bind_to_gsettings();
-
-    g_settings_bind(settings, "post-messages", in_level, "post-messages",
-                    G_SETTINGS_BIND_DEFAULT);
-    g_settings_bind(settings, "post-messages", out_level, "post-messages",
-                    G_SETTINGS_BIND_DEFAULT);
-    g_settings_bind(settings, "post-messages", autogain, "notify-host",
-                    G_SETTINGS_BIND_DEFAULT);
-
-    g_signal_connect(autogain, "notify::m", G_CALLBACK(on_m_changed), this);
-    g_signal_connect(autogain, "notify::s", G_CALLBACK(on_s_changed), this);
-    g_signal_connect(autogain, "notify::i", G_CALLBACK(on_i_changed), this);
-    g_signal_connect(autogain, "notify::r", G_CALLBACK(on_r_changed), this);
-    g_signal_connect(autogain, "notify::l", G_CALLBACK(on_l_changed), this);
-    g_signal_connect(autogain, "notify::lra", G_CALLBACK(on_lra_changed), this);
-    g_signal_connect(autogain, "notify::g", G_CALLBACK(on_g_changed), this);
-
-    g_settings_bind_with_mapping(
-        settings, "input-gain", input_gain, "volume", G_SETTINGS_BIND_DEFAULT,
-        util::db20_gain_to_linear_double, util::linear_double_gain_to_db20,
-        nullptr, nullptr);
-
-    g_settings_bind_with_mapping(
-        settings, "output-gain", output_gain, "volume", G_SETTINGS_BIND_DEFAULT,
-        util::db20_gain_to_linear_double, util::linear_double_gain_to_db20,
-        nullptr, nullptr);
+  g_settings_bind(settings, "post-messages", in_level, "post-messages",
+                  G_SETTINGS_BIND_DEFAULT);
+  g_settings_bind(settings, "post-messages", out_level, "post-messages",
+                  G_SETTINGS_BIND_DEFAULT);
 
-    // useless write just to force callback call
+  g_settings_bind_with_mapping(
+      settings, "input-gain", in_level, "volume", G_SETTINGS_BIND_DEFAULT,
+      util::db20_gain_to_linear_double, util::linear_double_gain_to_db20,
+      nullptr, nullptr);
 
-    auto enable = g_settings_get_boolean(settings, "state");
+  g_settings_bind_with_mapping(
+      settings, "output-gain", out_level, "volume", G_SETTINGS_BIND_DEFAULT,
+      util::db20_gain_to_linear_double, util::linear_double_gain_to_db20,
+      nullptr, nullptr);
 
-    g_settings_set_boolean(settings, "state", enable);
+  if (!warm_start_group.empty()) {
+    load_warm_start();
   }
 }
 
-AutoGain::~AutoGain() {
-  util::debug(log_tag + name + " destroyed");
+void AutoGain::release_bin() {
+  save_warm_start();
+
+  autogain = nullptr;
 }
 
 void AutoGain::bind_to_gsettings() {
@@ -144,4 +155,114 @@ void AutoGain::bind_to_gsettings() {
 
   g_settings_bind(settings, "weight-i", autogain, "weight-i",
                   G_SETTINGS_BIND_DEFAULT);
+
+  g_settings_bind(settings, "analysis-interval", autogain, "analysis-interval",
+                  G_SETTINGS_BIND_DEFAULT);
+}
+
+/*
+  The element only uses the warm start values when it is configured. So they
+  matter at startup or when the bin is created. Device and preset changes
+  later just select where the measurements are saved.
+*/
+
+void AutoGain::set_output_device(const std::string& name) {
+  output_device = name;
+
+  update_warm_start_group();
+}
+
+void AutoGain::set_app_name(const std::string& name) {
+  app_name = name;
+
+  update_warm_start_group();
+}
+
+void AutoGain::update_warm_start_group() {
+  if (!plugin_is_installed || output_device.empty()) {
+    return;
+  }
+
+  save_warm_start();
+
+  gchar* preset = g_settings_get_string(app_settings, "last-used-preset");
+
+  // group names can not have brackets
+
+  warm_start_group = output_device + "/" + preset;
+
+  if (!app_name.empty()) {
+    warm_start_group += "/" + app_name;
+  }
+
+  std::replace(warm_start_group.begin(), warm_start_group.end(), '[', '(');
+  std::replace(warm_start_group.begin(), warm_start_group.end(), ']', ')');
+
+  g_free(preset);
+
+  if (autogain != nullptr) {
+    load_warm_start();
+  }
+}
+
+void AutoGain::load_warm_start() {
+  GKeyFile* key_file = g_key_file_new();
+
+  auto group = warm_start_group.c_str();
+
+  if (g_key_file_load_from_file(key_file, get_warm_start_path().c_str(),
+                                G_KEY_FILE_NONE, nullptr) &&
+      g_key_file_has_group(key_file, group)) {
+    float s = g_key_file_get_double(key_file, group, "shortterm", nullptr);
+    float i = g_key_file_get_double(key_file, group, "integrated", nullptr);
+    float g = g_key_file_get_double(key_file, group, "gain", nullptr);
+
+    g_object_set(autogain, "warm-s", s, "warm-i", i, "warm-g", g, "warm-start",
+                 true, nullptr);
+
+    util::debug(log_tag + name + " warm start for " + warm_start_group +
+                ": gain " + std::to_string(g));
+  } else {
+    g_object_set(autogain, "warm-start", false, nullptr);
+  }
+
+  g_key_file_free(key_file);
+}
+
+void AutoGain::save_warm_start() {
+  if (autogain == nullptr || warm_start_group.empty()) {
+    return;
+  }
+
+  float s, i, g;
+
+  g_object_get(autogain, "s", &s, "i", &i, "g", &g, nullptr);
+
+  // nothing was measured
+
+  if (!std::isfinite(s) || !std::isfinite(i) || i >= 0.0f) {
+    return;
+  }
+
+  if (g_mkdir_with_parents(get_warm_start_dir().c_str(), 0755) != 0) {
+    return;
+  }
+
+  GKeyFile* key_file = g_key_file_new();
+
+  auto group = warm_start_group.c_str();
+
+  g_key_file_load_from_file(key_file, get_warm_start_path().c_str(),
+                            G_KEY_FILE_NONE, nullptr);
+
+  g_key_file_set_double(key_file, group, "shortterm", s);
+  g_key_file_set_double(key_file, group, "integrated", i);
+  g_key_file_set_double(key_file, group, "gain", g);
+
+  if (!g_key_file_save_to_file(key_file, get_warm_start_path().c_str(),
+                               nullptr)) {
+    util::warning(log_tag + name + " could not save the warm start values");
+  }
+
+  g_key_file_free(key_file);
 }
@@ -14,8 +14,11 @@
 
 #include <gst/audio/gstaudiofilter.h>
 #include <gst/gst.h>
+#include <algorithm>
 #include <cmath>
+#include <new>
 #include "config.h"
+#include "simd.hpp"
 // #include <iostream>
 #include "gstpeautogain.hpp"
 
@@ -45,6 +48,12 @@ static void gst_peautogain_finalize(GObject* object);
 static void gst_peautogain_process(GstPeautogain* peautogain,
                                    GstBuffer* buffer);
 
+static bool gst_peautogain_analyze(GstPeautogain* peautogain);
+
+static void gst_peautogain_publish(GstPeautogain* peautogain);
+
+static PeautogainSnapshot gst_peautogain_read(GstPeautogain* peautogain);
+
 enum {
   PROP_TARGET = 1,
   PROP_WEIGHT_M,
@@ -57,7 +66,12 @@ enum {
   PROP_L,
   PROP_G,
   PROP_LRA,
-  PROP_NOTIFY
+  PROP_NOTIFY,
+  PROP_INTERVAL,
+  PROP_WARM_START,
+  PROP_WARM_S,
+  PROP_WARM_I,
+  PROP_WARM_G
 };
 
 /* pad templates */
@@ -195,10 +209,49 @@ static void gst_peautogain_class_init(GstPeautogainClass* klass) {
   g_object_class_install_property(
       gobject_class, PROP_NOTIFY,
       g_param_spec_boolean("notify-host", "Notify Host",
-                           "Notify host of variable changes", true,
+                           "Unused. Measurements are always published", true,
+                           static_cast<GParamFlags>(G_PARAM_READWRITE |
+                                                    G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_INTERVAL,
+      g_param_spec_int("analysis-interval", "Analysis Interval",
+                       "Time between loudness analyses (in milliseconds)", 0,
+                       1000, 100,
+                       static_cast<GParamFlags>(G_PARAM_READWRITE |
+                                                G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_WARM_START,
+      g_param_spec_boolean("warm-start", "Warm Start",
+                           "Start from the warm-s, warm-i and warm-g values",
+                           false,
                            static_cast<GParamFlags>(G_PARAM_READWRITE |
                                                     G_PARAM_STATIC_STRINGS)));
 
+  g_object_class_install_property(
+      gobject_class, PROP_WARM_S,
+      g_param_spec_float("warm-s", "Warm Short Term Level",
+                         "Short term loudness level to start from (in LUFS)",
+                         -G_MAXFLOAT, G_MAXFLOAT, 0.0f,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE |
+                                                  G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_WARM_I,
+      g_param_spec_float("warm-i", "Warm Integrated Level",
+                         "Integrated loudness level to start from (in LUFS)",
+                         -G_MAXFLOAT, G_MAXFLOAT, 0.0f,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE |
+                                                  G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_WARM_G,
+      g_param_spec_float("warm-g", "Warm Gain", "Correction gain to start from",
+                         0.0f, G_MAXFLOAT, 1.0f,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE |
+                                                  G_PARAM_STATIC_STRINGS)));
+
   g_object_class_install_property(
       gobject_class, PROP_LRA,
       g_param_spec_float(
@@ -222,11 +275,29 @@ static void gst_peautogain_init(GstPeautogain* peautogain) {
   peautogain->loudness = 0.0f;
   peautogain->gain = 1.0f;
   peautogain->range = 0.0f;
+  peautogain->interval = 100;
+  peautogain->warm_start = false;
+  peautogain->warm_shortterm = 0.0f;
+  peautogain->warm_global = 0.0f;
+  peautogain->warm_gain = 1.0f;
+  peautogain->measured_samples = 0;
   peautogain->notify_samples = 0;
   peautogain->sample_count = 0;
+  peautogain->analysis_count = 0;
+  peautogain->next_gain = 1.0f;
+  peautogain->peak = 0.0;
+  peautogain->gain_step = 0.0f;
+  peautogain->analysis_failed = true;
   peautogain->notify = true;
   peautogain->ebur_state = nullptr;
 
+  /*
+    GObject allocates the instance without running C++ constructors. The
+    telemetry is constructed here and destroyed in finalize.
+  */
+
+  new (&peautogain->telemetry) PeautogainTelemetry();
+
   gst_base_transform_set_in_place(GST_BASE_TRANSFORM(peautogain), true);
 }
 
@@ -254,6 +325,21 @@ void gst_peautogain_set_property(GObject* object,
     case PROP_NOTIFY:
       peautogain->notify = g_value_get_boolean(value);
       break;
+    case PROP_INTERVAL:
+      peautogain->interval = g_value_get_int(value);
+      break;
+    case PROP_WARM_START:
+      peautogain->warm_start = g_value_get_boolean(value);
+      break;
+    case PROP_WARM_S:
+      peautogain->warm_shortterm = g_value_get_float(value);
+      break;
+    case PROP_WARM_I:
+      peautogain->warm_global = g_value_get_float(value);
+      break;
+    case PROP_WARM_G:
+      peautogain->warm_gain = g_value_get_float(value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
       break;
@@ -282,29 +368,44 @@ void gst_peautogain_get_property(GObject* object,
       g_value_set_int(value, peautogain->weight_i);
       break;
     case PROP_M:
-      g_value_set_float(value, peautogain->momentary);
+      g_value_set_float(value, gst_peautogain_read(peautogain).momentary);
       break;
     case PROP_S:
-      g_value_set_float(value, peautogain->shortterm);
+      g_value_set_float(value, gst_peautogain_read(peautogain).shortterm);
       break;
     case PROP_I:
-      g_value_set_float(value, peautogain->global);
+      g_value_set_float(value, gst_peautogain_read(peautogain).global);
       break;
     case PROP_R:
-      g_value_set_float(value, peautogain->relative);
+      g_value_set_float(value, gst_peautogain_read(peautogain).relative);
       break;
     case PROP_L:
-      g_value_set_float(value, peautogain->loudness);
+      g_value_set_float(value, gst_peautogain_read(peautogain).loudness);
       break;
     case PROP_G:
-      g_value_set_float(value, peautogain->gain);
+      g_value_set_float(value, gst_peautogain_read(peautogain).gain);
       break;
     case PROP_LRA:
-      g_value_set_float(value, peautogain->range);
+      g_value_set_float(value, gst_peautogain_read(peautogain).range);
       break;
     case PROP_NOTIFY:
       g_value_set_boolean(value, peautogain->notify);
       break;
+    case PROP_INTERVAL:
+      g_value_set_int(value, peautogain->interval);
+      break;
+    case PROP_WARM_START:
+      g_value_set_boolean(value, peautogain->warm_start);
+      break;
+    case PROP_WARM_S:
+      g_value_set_float(value, peautogain->warm_shortterm);
+      break;
+    case PROP_WARM_I:
+      g_value_set_float(value, peautogain->warm_global);
+      break;
+    case PROP_WARM_G:
+      g_value_set_float(value, peautogain->warm_gain);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
       break;
@@ -338,6 +439,24 @@ static gboolean gst_peautogain_setup(GstAudioFilter* filter,
     peautogain->notify_samples =
         GST_CLOCK_TIME_TO_FRAMES(GST_SECOND / 10, info->rate);
 
+    /*
+      The values saved by the host in the last session are used until the
+      loudness statistics are reliable. This way the gain is right from the
+      first buffer.
+    */
+
+    peautogain->measured_samples = 0;
+    peautogain->peak = 0.0;
+
+    if (peautogain->warm_start) {
+      peautogain->gain = peautogain->warm_gain;
+      peautogain->next_gain = peautogain->warm_gain;
+      peautogain->shortterm = peautogain->warm_shortterm;
+      peautogain->global = peautogain->warm_global;
+
+      gst_peautogain_publish(peautogain);
+    }
+
     peautogain->ready = true;
   }
 
@@ -368,20 +487,21 @@ void gst_peautogain_finalize(GObject* object) {
 
   peautogain->ready = false;
   peautogain->gain = 1.0f;
+  peautogain->next_gain = 1.0f;
 
   if (peautogain->ebur_state != nullptr) {
     ebur128_destroy(&peautogain->ebur_state);
     peautogain->ebur_state = nullptr;
   }
 
+  peautogain->telemetry.~PeautogainTelemetry();
+
   G_OBJECT_CLASS(gst_peautogain_parent_class)->finalize(object);
 }
 
 static void gst_peautogain_process(GstPeautogain* peautogain,
                                    GstBuffer* buffer) {
   GstMapInfo map;
-  double relative, momentary, range;
-  bool failed = false;
 
   gst_buffer_map(buffer, &map, GST_MAP_READWRITE);
 
@@ -389,8 +509,102 @@ static void gst_peautogain_process(GstPeautogain* peautogain,
 
   guint num_samples = map.size / peautogain->bpf;
 
+  // frames are always given to libebur128. Only the statistics are decimated
+
   ebur128_add_frames_float(peautogain->ebur_state, data, num_samples);
 
+  /*
+    libebur128 only keeps the peak of the last frames added. The clipping
+    guard needs the highest one of the whole analysis interval.
+  */
+
+  for (uint c = 0; c < 2; c++) {
+    double peak;
+
+    if (EBUR128_SUCCESS ==
+        ebur128_prev_sample_peak(peautogain->ebur_state, c, &peak)) {
+      peautogain->peak = std::max(peautogain->peak, peak);
+    }
+  }
+
+  peautogain->measured_samples += num_samples;
+
+  int interval_samples = peautogain->interval * peautogain->rate / 1000;
+
+  peautogain->analysis_count += num_samples;
+
+  bool analyzed = false;
+
+  if (peautogain->analysis_count >= interval_samples) {
+    peautogain->analysis_count = 0;
+
+    peautogain->analysis_failed = !gst_peautogain_analyze(peautogain);
+
+    peautogain->peak = 0.0;
+
+    analyzed = true;
+
+    peautogain->gain_step = (peautogain->next_gain - peautogain->gain) /
+                            std::max(interval_samples, 1);
+  }
+
+  // moving towards the gain computed in the last analysis
+
+  float previous_gain = peautogain->gain;
+
+  if (peautogain->gain != peautogain->next_gain) {
+    peautogain->gain += peautogain->gain_step * num_samples;
+
+    if ((peautogain->gain_step > 0.0f &&
+         peautogain->gain > peautogain->next_gain) ||
+        (peautogain->gain_step < 0.0f &&
+         peautogain->gain < peautogain->next_gain) ||
+        peautogain->gain_step == 0.0f) {
+      peautogain->gain = peautogain->next_gain;
+    }
+  }
+
+  /*
+    The gain is ramped sample by sample from the value used at the end of the
+    previous buffer. This way there are no steps at the buffer boundaries.
+  */
+
+  if (previous_gain != peautogain->gain) {
+    dsp::apply_gain_ramp(data, num_samples, previous_gain, peautogain->gain);
+  } else {
+    dsp::apply_gain(data, num_samples, peautogain->gain);
+  }
+
+  gst_buffer_unmap(buffer, &map);
+
+  if (!peautogain->analysis_failed) {
+    peautogain->sample_count += num_samples;
+
+    if (analyzed && peautogain->sample_count >= peautogain->notify_samples) {
+      peautogain->sample_count = 0;
+
+      // std::cout << "relative: " << peautogain->relative << std::endl;
+      // std::cout << "momentary: " << peautogain->momentary << std::endl;
+      // std::cout << "shortterm: " << peautogain->shortterm << std::endl;
+      // std::cout << "global: " << peautogain->global << std::endl;
+      // std::cout << "loudness: " << peautogain->loudness << std::endl;
+      // std::cout << "range: " << peautogain->range << std::endl;
+      // std::cout << "gain: " << peautogain->gain << std::endl;
+
+      gst_peautogain_publish(peautogain);
+    }
+  }
+}
+
+/*
+  Updates the loudness statistics and the gain we should be moving to.
+  Returns false if libebur128 failed to give us one of the values.
+*/
+
+static bool gst_peautogain_analyze(GstPeautogain* peautogain) {
+  double relative, momentary, range;
+  bool failed = false;
+
   if (EBUR128_SUCCESS !=
       ebur128_relative_threshold(peautogain->ebur_state, &relative)) {
     failed = true;
@@ -430,6 +644,36 @@ static void gst_peautogain_process(GstPeautogain* peautogain,
       peautogain->global = (float)global;
     }
 
+    /*
+      The short term window is 3 seconds long. For the integrated loudness we
+      wait 30 seconds of audio before forgetting the warm start values.
+    */
+
+    if (peautogain->warm_start && !failed) {
+      float t = (float)peautogain->measured_samples / peautogain->rate;
+
+      float ws = std::min(t / 3.0f, 1.0f);
+      float wi = std::min(t / 30.0f, 1.0f);
+
+      // no gated block yet
+
+      if (!std::isfinite(peautogain->shortterm)) {
+        ws = 0.0f;
+        peautogain->shortterm = 0.0f;
+      }
+
+      if (!std::isfinite(peautogain->global)) {
+        wi = 0.0f;
+        peautogain->global = 0.0f;
+      }
+
+      peautogain->shortterm =
+          ws * peautogain->shortterm + (1.0f - ws) * peautogain->warm_shortterm;
+
+      peautogain->global =
+          wi * peautogain->global + (1.0f - wi) * peautogain->warm_global;
+    }
+
     if (EBUR128_SUCCESS !=
         ebur128_prev_sample_peak(peautogain->ebur_state, 0, &peak_L)) {
       failed = true;
@@ -452,43 +696,65 @@ static void gst_peautogain_process(GstPeautogain* peautogain,
       // 10^(diff/20). The way below should be faster than using pow
       float gain = expf((diff / 20.0f) * logf(10.0f));
 
-      float peak = (peak_L > peak_R) ? peak_L : peak_R;
+      float peak = std::max({peak_L, peak_R, peautogain->peak});
 
       if (gain * peak < 1.0f) {
-        peautogain->gain = gain;
+        peautogain->next_gain = gain;
       }
     }
   }
 
-  for (unsigned int n = 0; n < 2 * num_samples; n++) {
-    data[n] = data[n] * peautogain->gain;
-  }
+  return !failed;
+}
 
-  gst_buffer_unmap(buffer, &map);
+/*
+  The host polls the measurements from its main loop. There is only one
+  writer, the streaming thread, so a sequence lock is enough. Readers retry
+  while the sequence is odd or changed during the read.
+*/
 
-  if (!failed && peautogain->notify) {
-    peautogain->sample_count += num_samples;
+static void gst_peautogain_publish(GstPeautogain* peautogain) {
+  auto& t = peautogain->telemetry;
 
-    if (peautogain->sample_count >= peautogain->notify_samples) {
-      peautogain->sample_count = 0;
+  uint sequence = t.sequence.load(std::memory_order_relaxed);
 
-      // std::cout << "relative: " << relative << std::endl;
-      // std::cout << "momentary: " << momentary << std::endl;
-      // std::cout << "shortterm: " << peautogain->shortterm << std::endl;
-      // std::cout << "global: " << peautogain->global << std::endl;
-      // std::cout << "loudness: " << peautogain->loudness << std::endl;
-      // std::cout << "range: " << peautogain->range << std::endl;
-      // std::cout << "gain: " << peautogain->gain << std::endl;
+  t.sequence.store(sequence + 1, std::memory_order_relaxed);
 
-      g_object_notify(G_OBJECT(peautogain), "m");
-      g_object_notify(G_OBJECT(peautogain), "s");
-      g_object_notify(G_OBJECT(peautogain), "i");
-      g_object_notify(G_OBJECT(peautogain), "r");
-      g_object_notify(G_OBJECT(peautogain), "l");
-      g_object_notify(G_OBJECT(peautogain), "lra");
-      g_object_notify(G_OBJECT(peautogain), "g");
-    }
-  }
+  std::atomic_thread_fence(std::memory_order_release);
+
+  t.momentary.store(peautogain->momentary, std::memory_order_relaxed);
+  t.shortterm.store(peautogain->shortterm, std::memory_order_relaxed);
+  t.global.store(peautogain->global, std::memory_order_relaxed);
+  t.relative.store(peautogain->relative, std::memory_order_relaxed);
+  t.loudness.store(peautogain->loudness, std::memory_order_relaxed);
+  t.gain.store(peautogain->gain, std::memory_order_relaxed);
+  t.range.store(peautogain->range, std::memory_order_relaxed);
+
+  t.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+static PeautogainSnapshot gst_peautogain_read(GstPeautogain* peautogain) {
+  auto& t = peautogain->telemetry;
+  PeautogainSnapshot snapshot;
+  uint s1, s2;
+
+  do {
+    s1 = t.sequence.load(std::memory_order_acquire);
+
+    snapshot.momentary = t.momentary.load(std::memory_order_relaxed);
+    snapshot.shortterm = t.shortterm.load(std::memory_order_relaxed);
+    snapshot.global = t.global.load(std::memory_order_relaxed);
+    snapshot.relative = t.relative.load(std::memory_order_relaxed);
+    snapshot.loudness = t.loudness.load(std::memory_order_relaxed);
+    snapshot.gain = t.gain.load(std::memory_order_relaxed);
+    snapshot.range = t.range.load(std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    s2 = t.sequence.load(std::memory_order_relaxed);
+  } while (s1 % 2 != 0 || s1 != s2);
+
+  return snapshot;
 }
 
 static gboolean plugin_init(GstPlugin* plugin) {
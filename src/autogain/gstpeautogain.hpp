@@ -3,6 +3,7 @@
 
 #include <ebur128.h>
 #include <gst/audio/gstaudiofilter.h>
+#include <atomic>
 #include <mutex>
 
 G_BEGIN_DECLS
@@ -20,6 +21,24 @@ G_BEGIN_DECLS
 typedef struct _GstPeautogain GstPeautogain;
 typedef struct _GstPeautogainClass GstPeautogainClass;
 
+/*
+  Snapshot of the measurements read by the host. It is written by the
+  streaming thread and protected by a sequence lock, so the audio thread never
+  waits for a reader nor emits GObject signals. It lives in the GObject
+  instance, so gst_peautogain_init constructs it with placement new.
+*/
+
+struct PeautogainTelemetry {
+  std::atomic<uint> sequence{0};  // odd while the streaming thread writes
+
+  std::atomic<float> momentary{0.0f}, shortterm{0.0f}, global{0.0f},
+      relative{0.0f}, loudness{0.0f}, gain{1.0f}, range{0.0f};
+};
+
+struct PeautogainSnapshot {
+  float momentary, shortterm, global, relative, loudness, gain, range;
+};
+
 struct _GstPeautogain {
   GstAudioFilter base_peautogain;
 
@@ -36,6 +55,12 @@ struct _GstPeautogain {
   float loudness;   // estimated loudness
   float gain;       // correction gain
   float range;      // loudness range
+  int interval;     // analysis interval in milliseconds
+
+  bool warm_start;       // start from the values below
+  float warm_shortterm;  // short term value saved by the host
+  float warm_global;     // integrated value saved by the host
+  float warm_gain;       // correction gain saved by the host
 
   /* < private > */
 
@@ -43,10 +68,26 @@ struct _GstPeautogain {
   int bpf;   // bytes per frame : channels * bps
   int rate;  // sampling rate
 
-  int notify_samples;  // number of samples to count before emit a notify
+  int notify_samples;  // number of samples to count before publishing
   int sample_count;
+
+  /*
+    The loudness statistics walk the whole ebur128 histogram. So they are
+    computed only once per analysis interval. In between the gain moves
+    linearly towards the last value computed.
+  */
+
+  int analysis_count;  // samples since the last analysis
+  float next_gain;     // gain computed by the last analysis
+  float gain_step;     // gain increment per sample
+  double peak;         // highest sample peak since the last analysis
+  bool analysis_failed;
+
+  guint64 measured_samples;  // used to fade out the warm start values
   ebur128_state* ebur_state = nullptr;
 
+  PeautogainTelemetry telemetry;
+
   std::mutex lock_guard_ebu;
 };
 
@@ -22,6 +22,9 @@ void AutoGainPreset::save(boost::property_tree::ptree& root,
   root.put(section + ".autogain.weight-s", settings->get_int("weight-s"));
 
   root.put(section + ".autogain.weight-i", settings->get_int("weight-i"));
+
+  root.put(section + ".autogain.analysis-interval",
+           settings->get_int("analysis-interval"));
 }
 
 void AutoGainPreset::load(boost::property_tree::ptree& root,
@@ -42,6 +45,9 @@ void AutoGainPreset::load(boost::property_tree::ptree& root,
   update_key<int>(root, settings, "weight-s", section + ".autogain.weight-s");
 
   update_key<int>(root, settings, "weight-i", section + ".autogain.weight-i");
+
+  update_key<int>(root, settings, "analysis-interval",
+                  section + ".autogain.analysis-interval");
 }
 
 void AutoGainPreset::write(PresetType preset_type,
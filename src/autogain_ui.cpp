@@ -31,6 +31,7 @@ AutoGainUi::AutoGainUi(BaseObjectType* cobject,
   get_object(builder, "weight_m", weight_m);
   get_object(builder, "weight_s", weight_s);
   get_object(builder, "weight_i", weight_i);
+  get_object(builder, "analysis_interval", analysis_interval);
 
   // gsettings bindings
 
@@ -43,6 +44,7 @@ AutoGainUi::AutoGainUi(BaseObjectType* cobject,
   settings->bind("weight-m", weight_m.get(), "value", flag);
   settings->bind("weight-s", weight_s.get(), "value", flag);
   settings->bind("weight-i", weight_i.get(), "value", flag);
+  settings->bind("analysis-interval", analysis_interval.get(), "value", flag);
 }
 
 AutoGainUi::~AutoGainUi() {
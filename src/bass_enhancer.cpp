@@ -13,6 +13,10 @@ void on_post_messages_changed(GSettings* settings,
     if (!l->harmonics_connection.connected()) {
       l->harmonics_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->bass_enhancer == nullptr) {
+              return true;
+            }
+
             float harmonics;
 
             g_object_get(l->bass_enhancer, "meter-drive", &harmonics, nullptr);
@@ -32,46 +36,10 @@ void on_post_messages_changed(GSettings* settings,
 
 BassEnhancer::BassEnhancer(const std::string& tag, const std::string& schema)
     : PluginBase(tag, "bass_enhancer", schema) {
-  bass_enhancer = gst_element_factory_make(
-      "calf-sourceforge-net-plugins-BassEnhancer", nullptr);
-
-  if (is_installed(bass_enhancer)) {
-    auto in_level =
-        gst_element_factory_make("level", "bass_enhancer_input_level");
-    auto out_level =
-        gst_element_factory_make("level", "bass_enhancer_output_level");
-    auto audioconvert_in = gst_element_factory_make(
-        "audioconvert", "bass_enhancer_audioconvert_in");
-    auto audioconvert_out = gst_element_factory_make(
-        "audioconvert", "bass_enhancer_audioconvert_out");
-
-    gst_bin_add_many(GST_BIN(bin), in_level, audioconvert_in, bass_enhancer,
-                     audioconvert_out, out_level, nullptr);
-
-    gst_element_link_many(in_level, audioconvert_in, bass_enhancer,
-                          audioconvert_out, out_level, nullptr);
-
-    auto pad_sink = gst_element_get_static_pad(in_level, "sink");
-    auto pad_src = gst_element_get_static_pad(out_level, "src");
-
-    gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad_sink));
-    gst_element_add_pad(bin, gst_ghost_pad_new("src", pad_src));
-
-    gst_object_unref(GST_OBJECT(pad_sink));
-    gst_object_unref(GST_OBJECT(pad_src));
-
-    g_object_set(bass_enhancer, "bypass", false, nullptr);
-
-    bind_to_gsettings();
-
+  if (is_installed("calf-sourceforge-net-plugins-BassEnhancer")) {
     g_signal_connect(settings, "changed::post-messages",
                      G_CALLBACK(on_post_messages_changed), this);
 
-    g_settings_bind(settings, "post-messages", in_level, "post-messages",
-                    G_SETTINGS_BIND_DEFAULT);
-    g_settings_bind(settings, "post-messages", out_level, "post-messages",
-                    G_SETTINGS_BIND_DEFAULT);
-
     // useless write just to force callback call
 
     auto enable = g_settings_get_boolean(settings, "state");
@@ -84,6 +52,34 @@ BassEnhancer::~BassEnhancer() {
   util::debug(log_tag + name + " destroyed");
 }
 
+void BassEnhancer::create_bin() {
+  bass_enhancer = gst_element_factory_make(
+      "calf-sourceforge-net-plugins-BassEnhancer", nullptr);
+
+  auto in_level =
+      gst_element_factory_make("pegainmeter", "bass_enhancer_input_level");
+  auto out_level =
+      gst_element_factory_make("pegainmeter", "bass_enhancer_output_level");
+  auto audioconvert_in = make_converter(bass_enhancer, "sink");
+  auto audioconvert_out = make_converter(bass_enhancer, "src");
+
+  add_to_bin({in_level, audioconvert_in, bass_enhancer, audioconvert_out,
+              out_level});
+
+  g_object_set(bass_enhancer, "bypass", false, nullptr);
+
+  bind_to_gsettings();
+
+  g_settings_bind(settings, "post-messages", in_level, "post-messages",
+                  G_SETTINGS_BIND_DEFAULT);
+  g_settings_bind(settings, "post-messages", out_level, "post-messages",
+                  G_SETTINGS_BIND_DEFAULT);
+}
+
+void BassEnhancer::release_bin() {
+  bass_enhancer = nullptr;
+}
+
 void BassEnhancer::bind_to_gsettings() {
   g_settings_bind_with_mapping(settings, "input-gain", bass_enhancer,
                                "level-in", G_SETTINGS_BIND_DEFAULT,
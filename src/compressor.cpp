@@ -11,6 +11,10 @@ void on_post_messages_changed(GSettings* settings, gchar* key, Compressor* l) {
     if (!l->input_level_connection.connected()) {
       l->input_level_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->compressor == nullptr) {
+              return true;
+            }
+
             float inL, inR;
 
             g_object_get(l->compressor, "ilm-l", &inL, nullptr);
@@ -28,6 +32,10 @@ void on_post_messages_changed(GSettings* settings, gchar* key, Compressor* l) {
     if (!l->output_level_connection.connected()) {
       l->output_level_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->compressor == nullptr) {
+              return true;
+            }
+
             float outL, outR;
 
             g_object_get(l->compressor, "olm-l", &outL, nullptr);
@@ -45,6 +53,10 @@ void on_post_messages_changed(GSettings* settings, gchar* key, Compressor* l) {
     if (!l->reduction_connection.connected()) {
       l->reduction_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->compressor == nullptr) {
+              return true;
+            }
+
             float compression;
 
             g_object_get(l->compressor, "rlm", &compression, nullptr);
@@ -59,6 +71,10 @@ void on_post_messages_changed(GSettings* settings, gchar* key, Compressor* l) {
     if (!l->sidechain_connection.connected()) {
       l->sidechain_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->compressor == nullptr) {
+              return true;
+            }
+
             float v;
 
             g_object_get(l->compressor, "slm", &v, nullptr);
@@ -73,6 +89,10 @@ void on_post_messages_changed(GSettings* settings, gchar* key, Compressor* l) {
     if (!l->curve_connection.connected()) {
       l->curve_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->compressor == nullptr) {
+              return true;
+            }
+
             float v;
 
             g_object_get(l->compressor, "clm", &v, nullptr);
@@ -96,38 +116,7 @@ void on_post_messages_changed(GSettings* settings, gchar* key, Compressor* l) {
 
 Compressor::Compressor(const std::string& tag, const std::string& schema)
     : PluginBase(tag, "compressor", schema) {
-  compressor = gst_element_factory_make(
-      "lsp-plug-in-plugins-lv2-compressor-stereo", nullptr);
-
-  if (is_installed(compressor)) {
-    auto audioconvert_in =
-        gst_element_factory_make("audioconvert", "compressor_audioconvert_in");
-    auto audioconvert_out =
-        gst_element_factory_make("audioconvert", "compressor_audioconvert_out");
-
-    gst_bin_add_many(GST_BIN(bin), audioconvert_in, compressor,
-                     audioconvert_out, nullptr);
-
-    gst_element_link_many(audioconvert_in, compressor, audioconvert_out,
-                          nullptr);
-
-    auto pad_sink = gst_element_get_static_pad(audioconvert_in, "sink");
-    auto pad_src = gst_element_get_static_pad(audioconvert_out, "src");
-
-    gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad_sink));
-    gst_element_add_pad(bin, gst_ghost_pad_new("src", pad_src));
-
-    gst_object_unref(GST_OBJECT(pad_sink));
-    gst_object_unref(GST_OBJECT(pad_src));
-
-    g_object_set(compressor, "bypass", false, nullptr);
-    g_object_set(compressor, "pause", true, nullptr);  // pause graph analysis
-    g_object_set(compressor, "rrl", 0.0f, nullptr);    // relative release level
-    g_object_set(compressor, "cdr", 0.0f, nullptr);    // dry gain
-    g_object_set(compressor, "cwt", 1.0f, nullptr);    /// wet gain
-
-    bind_to_gsettings();
-
+  if (is_installed("lsp-plug-in-plugins-lv2-compressor-stereo")) {
     g_signal_connect(settings, "changed::post-messages",
                      G_CALLBACK(on_post_messages_changed), this);
 
@@ -143,6 +132,28 @@ Compressor::~Compressor() {
   util::debug(log_tag + name + " destroyed");
 }
 
+void Compressor::create_bin() {
+  compressor = gst_element_factory_make(
+      "lsp-plug-in-plugins-lv2-compressor-stereo", nullptr);
+
+  auto audioconvert_in = make_converter(compressor, "sink");
+  auto audioconvert_out = make_converter(compressor, "src");
+
+  add_to_bin({audioconvert_in, compressor, audioconvert_out});
+
+  g_object_set(compressor, "bypass", false, nullptr);
+  g_object_set(compressor, "pause", true, nullptr);  // pause graph analysis
+  g_object_set(compressor, "rrl", 0.0f, nullptr);    // relative release level
+  g_object_set(compressor, "cdr", 0.0f, nullptr);    // dry gain
+  g_object_set(compressor, "cwt", 1.0f, nullptr);    /// wet gain
+
+  bind_to_gsettings();
+}
+
+void Compressor::release_bin() {
+  compressor = nullptr;
+}
+
 void Compressor::bind_to_gsettings() {
   g_settings_bind(settings, "mode", compressor, "cm", G_SETTINGS_BIND_DEFAULT);
 
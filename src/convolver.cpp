@@ -2,64 +2,105 @@
 #include <glibmm/main.h>
 #include "util.hpp"
 
+namespace {
+
+/*
+  The kernel size is polled from the main loop. This way the streaming
+  thread of peconvolver never emits GObject signals when it switches to a new
+  kernel.
+*/
+
+void on_post_messages_changed(GSettings* settings, gchar* key, Convolver* c) {
+  auto post = g_settings_get_boolean(settings, key);
+
+  if (post) {
+    if (!c->frames_connection.connected()) {
+      c->original_n_frames = -1;
+      c->kernel_n_frames = -1;
+
+      c->frames_connection = Glib::signal_timeout().connect(
+          [c]() {
+            if (c->convolver == nullptr) {
+              return true;
+            }
+
+            int original, frames;
+
+            g_object_get(c->convolver, "original-kernel-frames", &original,
+                         "kernel-frames", &frames, nullptr);
+
+            if (original != c->original_n_frames ||
+                frames != c->kernel_n_frames) {
+              c->original_n_frames = original;
+              c->kernel_n_frames = frames;
+
+              c->kernel_frames.emit(original, frames);
+            }
+
+            return true;
+          },
+          500);
+    }
+  } else {
+    c->frames_connection.disconnect();
+  }
+}
+
+}  // namespace
+
 Convolver::Convolver(const std::string& tag, const std::string& schema)
     : PluginBase(tag, "convolver", schema) {
-  convolver = gst_element_factory_make("peconvolver", "convolver");
-
-  if (is_installed(convolver)) {
-    auto input_gain = gst_element_factory_make("volume", nullptr);
-    auto in_level = gst_element_factory_make("level", "convolver_input_level");
-    auto out_level =
-        gst_element_factory_make("level", "convolver_output_level");
-    auto output_gain = gst_element_factory_make("volume", nullptr);
-    auto audioconvert_in =
-        gst_element_factory_make("audioconvert", "convolver_audioconvert_in");
-    auto audioconvert_out =
-        gst_element_factory_make("audioconvert", "convolver_audioconvert_out");
+  if (is_installed("peconvolver")) {
+    g_signal_connect(settings, "changed::post-messages",
+                     G_CALLBACK(on_post_messages_changed), this);
 
-    gst_bin_add_many(GST_BIN(bin), input_gain, in_level, audioconvert_in,
-                     convolver, audioconvert_out, output_gain, out_level,
-                     nullptr);
+    // useless write just to force callback call
 
-    gst_element_link_many(input_gain, in_level, audioconvert_in, convolver,
-                          audioconvert_out, output_gain, out_level, nullptr);
+    auto enable = g_settings_get_boolean(settings, "state");
 
-    auto pad_sink = gst_element_get_static_pad(input_gain, "sink");
-    auto pad_src = gst_element_get_static_pad(out_level, "src");
+    g_settings_set_boolean(settings, "state", enable);
+  }
+}
 
-    gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad_sink));
-    gst_element_add_pad(bin, gst_ghost_pad_new("src", pad_src));
+Convolver::~Convolver() {
+  frames_connection.disconnect();
 
-    gst_object_unref(GST_OBJECT(pad_sink));
-    gst_object_unref(GST_OBJECT(pad_src));
+  util::debug(log_tag + name + " destroyed");
+}
 
-    bind_to_gsettings();
+void Convolver::create_bin() {
+  convolver = gst_element_factory_make("peconvolver", "convolver");
 
-    g_settings_bind(settings, "post-messages", in_level, "post-messages",
-                    G_SETTINGS_BIND_DEFAULT);
-    g_settings_bind(settings, "post-messages", out_level, "post-messages",
-                    G_SETTINGS_BIND_DEFAULT);
+  auto in_level =
+      gst_element_factory_make("pegainmeter", "convolver_input_level");
+  auto out_level =
+      gst_element_factory_make("pegainmeter", "convolver_output_level");
+  auto audioconvert_in = make_converter(convolver, "sink");
+  auto audioconvert_out = make_converter(convolver, "src");
 
-    g_settings_bind_with_mapping(
-        settings, "input-gain", input_gain, "volume", G_SETTINGS_BIND_DEFAULT,
-        util::db20_gain_to_linear_double, util::linear_double_gain_to_db20,
-        nullptr, nullptr);
+  add_to_bin({in_level, audioconvert_in, convolver, audioconvert_out,
+              out_level});
 
-    g_settings_bind_with_mapping(
-        settings, "output-gain", output_gain, "volume", G_SETTINGS_BIND_DEFAULT,
-        util::db20_gain_to_linear_double, util::linear_double_gain_to_db20,
-        nullptr, nullptr);
+  bind_to_gsettings();
 
-    // useless write just to force callback call
+  g_settings_bind(settings, "post-messages", in_level, "post-messages",
+                  G_SETTINGS_BIND_DEFAULT);
+  g_settings_bind(settings, "post-messages", out_level, "post-messages",
+                  G_SETTINGS_BIND_DEFAULT);
 
-    auto enable = g_settings_get_boolean(settings, "state");
+  g_settings_bind_with_mapping(
+      settings, "input-gain", in_level, "volume", G_SETTINGS_BIND_DEFAULT,
+      util::db20_gain_to_linear_double, util::linear_double_gain_to_db20,
+      nullptr, nullptr);
 
-    g_settings_set_boolean(settings, "state", enable);
-  }
+  g_settings_bind_with_mapping(
+      settings, "output-gain", out_level, "volume", G_SETTINGS_BIND_DEFAULT,
+      util::db20_gain_to_linear_double, util::linear_double_gain_to_db20,
+      nullptr, nullptr);
 }
 
-Convolver::~Convolver() {
-  util::debug(log_tag + name + " destroyed");
+void Convolver::release_bin() {
+  convolver = nullptr;
 }
 
 void Convolver::bind_to_gsettings() {
@@ -68,4 +109,16 @@ void Convolver::bind_to_gsettings() {
 
   g_settings_bind(settings, "ir-width", convolver, "ir-width",
                   G_SETTINGS_BIND_DEFAULT);
+
+  g_settings_bind(settings, "auto-tune", convolver, "auto-tune",
+                  G_SETTINGS_BIND_DEFAULT);
+
+  g_settings_bind(settings, "trim-tail", convolver, "trim-tail",
+                  G_SETTINGS_BIND_DEFAULT);
+
+  g_settings_bind(settings, "trim-threshold", convolver, "trim-threshold",
+                  G_SETTINGS_BIND_DEFAULT);
+
+  g_settings_bind(settings, "minimum-phase", convolver, "minimum-phase",
+                  G_SETTINGS_BIND_DEFAULT);
 }
@@ -0,0 +1,144 @@
+#include <zita-convolver.h>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "simd.hpp"
+
+/*
+  Cost of a true stereo impulse response. Before 4 channel files were
+  supported two stereo convolvers had to be chained, each one with its own
+  Convproc and its own FFT of the input. Now a single Convproc with the 4
+  paths LL, LR, RL and RR does the same work sharing the input partitions.
+  SCHED_OTHER is used so no realtime privileges are needed.
+*/
+
+namespace {
+
+const int frames = 1024;
+const int kernel_size = 96000;  // 2 seconds at 48 kHz
+const uint iterations = 1000;
+
+using Path = std::array<int, 2>;
+
+Convproc* create_engine(const std::vector<Path>& paths, float* kernel) {
+  auto conv = new Convproc();
+  int ret;
+
+  conv->set_options(Convproc::OPT_VECTOR_MODE);
+
+#if ZITA_CONVOLVER_MAJOR_VERSION == 3
+  conv->set_density(0.0f);
+
+  ret = conv->configure(2, 2, kernel_size, frames, frames, Convproc::MAXPART);
+#endif
+
+#if ZITA_CONVOLVER_MAJOR_VERSION == 4
+  ret = conv->configure(2, 2, kernel_size, frames, frames, Convproc::MAXPART,
+                        0.0f);
+#endif
+
+  for (uint n = 0; n < paths.size() && ret == 0; n++) {
+    ret = conv->impdata_create(paths[n][0], paths[n][1], 1, kernel, 0,
+                               kernel_size);
+  }
+
+  if (ret == 0) {
+    ret = conv->start_process(0, SCHED_OTHER);
+  }
+
+  if (ret != 0) {
+    std::cerr << "can't initialise zita-convolver engine: " << ret
+              << std::endl;
+
+    exit(1);
+  }
+
+  return conv;
+}
+
+void destroy_engine(Convproc* conv) {
+  conv->stop_process();
+  conv->cleanup();
+
+  delete conv;
+}
+
+// what gst_peconvolver_process does with each buffer
+
+void process(Convproc* conv, float* data) {
+  dsp::deinterleave(data, conv->inpdata(0), conv->inpdata(1), frames);
+
+  conv->process(true);
+
+  dsp::interleave(conv->outdata(0), conv->outdata(1), data, frames);
+}
+
+template <typename Function>
+void measure(const std::string& name, Function f) {
+  f();  // warm up
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (uint n = 0; n < iterations; n++) {
+    f();
+  }
+
+  auto end = std::chrono::steady_clock::now();
+
+  double us = std::chrono::duration<double, std::micro>(end - start).count() /
+              iterations;
+
+  std::cout << std::left << std::setw(24) << name << std::right << std::fixed
+            << std::setprecision(1) << std::setw(10) << us << " us"
+            << std::endl;
+}
+
+}  // namespace
+
+int main() {
+  std::vector<float> input(2 * frames), data, kernel(kernel_size);
+
+  for (int n = 0; n < kernel_size; n++) {
+    kernel[n] = ((n * 7919) % 2001 - 1000) * 1e-6f;
+  }
+
+  for (uint n = 0; n < input.size(); n++) {
+    input[n] = (n % 7) * 0.1f - 0.3f;
+  }
+
+  std::cout << kernel_size << " frames kernel, " << frames
+            << " stereo frames per call" << std::endl;
+
+  {
+    auto direct = create_engine({{0, 0}, {1, 1}}, kernel.data());
+    auto cross = create_engine({{0, 1}, {1, 0}}, kernel.data());
+
+    measure("2 chained convolvers", [&]() {
+      data = input;
+
+      process(direct, data.data());
+      process(cross, data.data());
+    });
+
+    destroy_engine(direct);
+    destroy_engine(cross);
+  }
+
+  {
+    auto conv =
+        create_engine({{0, 0}, {0, 1}, {1, 0}, {1, 1}}, kernel.data());
+
+    measure("1 true stereo convolver", [&]() {
+      data = input;
+
+      process(conv, data.data());
+    });
+
+    destroy_engine(conv);
+  }
+
+  return 0;
+}
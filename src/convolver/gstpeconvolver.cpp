@@ -15,8 +15,14 @@
 #include "gstpeconvolver.hpp"
 #include <gst/audio/gstaudiofilter.h>
 #include <gst/gst.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include "config.h"
+#include "kernel_cache.hpp"
+#include "partition_tuning.hpp"
 #include "read_kernel.hpp"
+#include "simd.hpp"
 
 GST_DEBUG_CATEGORY_STATIC(gst_peconvolver_debug_category);
 #define GST_CAT_DEFAULT gst_peconvolver_debug_category
@@ -49,10 +55,65 @@ static void gst_peconvolver_set_kernel_path(GstPeconvolver* peconvolver,
 static void gst_peconvolver_set_ir_width(GstPeconvolver* peconvolver,
                                          const uint& value);
 
-static void gst_peconvolver_process(GstPeconvolver* peconvolver,
-                                    GstBuffer* buffer);
+static void gst_peconvolver_set_auto_tune(GstPeconvolver* peconvolver,
+                                          const bool& value);
 
-static void gst_peconvolver_setup_convolver(GstPeconvolver* peconvolver);
+static void gst_peconvolver_set_trim_tail(GstPeconvolver* peconvolver,
+                                          const bool& value);
+
+static void gst_peconvolver_set_trim_threshold(GstPeconvolver* peconvolver,
+                                               const float& value);
+
+static void gst_peconvolver_set_minimum_phase(GstPeconvolver* peconvolver,
+                                              const bool& value);
+
+static gboolean gst_peconvolver_src_query(GstPad* pad,
+                                          GstObject* parent,
+                                          GstQuery* query);
+
+static void gst_peconvolver_process(PeconvolverEngine* engine,
+                                    float* data,
+                                    const std::string& log_tag);
+
+static void gst_peconvolver_process_block(GstPeconvolver* peconvolver,
+                                          float* data);
+
+static void gst_peconvolver_process_fifo(GstPeconvolver* peconvolver,
+                                         float* data,
+                                         const uint& n_frames);
+
+static void gst_peconvolver_start_fifo(GstPeconvolver* peconvolver);
+
+static void gst_peconvolver_stop_fifo(GstPeconvolver* peconvolver,
+                                      float* data);
+
+static void gst_peconvolver_fifo_write(GstPeconvolver* peconvolver,
+                                       const float* data,
+                                       const uint& n_frames);
+
+static void gst_peconvolver_fifo_read(GstPeconvolver* peconvolver,
+                                      float* data,
+                                      const uint& n_frames);
+
+static void gst_peconvolver_crossfade(GstPeconvolver* peconvolver,
+                                      PeconvolverEngine* new_engine,
+                                      float* data);
+
+static void gst_peconvolver_request_engine(GstPeconvolver* peconvolver);
+
+static PeconvolverEngine* gst_peconvolver_create_engine(
+    const std::string& kernel_path,
+    const int& rate,
+    const uint& ir_width,
+    const uint& num_samples,
+    const bool& auto_tune,
+    const rk::Preprocess& preprocess,
+    const std::string& log_tag);
+
+static void gst_peconvolver_destroy_engine(PeconvolverEngine* engine);
+
+static void gst_peconvolver_retire_engine(GstPeconvolver* peconvolver,
+                                          PeconvolverEngine* engine);
 
 static void gst_peconvolver_finish_convolver(GstPeconvolver* peconvolver);
 
@@ -71,7 +132,16 @@ static void gst_peconvolver_finish_convolver(GstPeconvolver* peconvolver);
 #define CONVPROC_SCHEDULER_CLASS SCHED_FIFO
 #define THREAD_SYNC_MODE true
 
-enum { PROP_KERNEL_PATH = 1, PROP_IR_WIDTH };
+enum {
+  PROP_KERNEL_PATH = 1,
+  PROP_IR_WIDTH,
+  PROP_AUTO_TUNE,
+  PROP_TRIM_TAIL,
+  PROP_TRIM_THRESHOLD,
+  PROP_MINIMUM_PHASE,
+  PROP_KERNEL_FRAMES,
+  PROP_ORIGINAL_KERNEL_FRAMES
+};
 
 /* pad templates */
 
@@ -152,17 +222,90 @@ static void gst_peconvolver_class_init(GstPeconvolverClass* klass) {
                        0, 200, 100,
                        static_cast<GParamFlags>(G_PARAM_READWRITE |
                                                 G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_AUTO_TUNE,
+      g_param_spec_boolean(
+          "auto-tune", "Auto Tune",
+          "Benchmark the zita partition layouts and use the fastest one",
+          false,
+          static_cast<GParamFlags>(G_PARAM_READWRITE |
+                                   G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_TRIM_TAIL,
+      g_param_spec_boolean(
+          "trim-tail", "Trim Tail",
+          "Truncate the kernel where its energy decay reaches the threshold",
+          false,
+          static_cast<GParamFlags>(G_PARAM_READWRITE |
+                                   G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_TRIM_THRESHOLD,
+      g_param_spec_float("trim-threshold", "Trim Threshold",
+                         "Energy decay where the tail is cut (dB)", -120.0f,
+                         -20.0f, -60.0f,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE |
+                                                  G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_MINIMUM_PHASE,
+      g_param_spec_boolean(
+          "minimum-phase", "Minimum Phase",
+          "Convert the kernel to minimum phase", false,
+          static_cast<GParamFlags>(G_PARAM_READWRITE |
+                                   G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_KERNEL_FRAMES,
+      g_param_spec_int("kernel-frames", "Kernel Frames",
+                       "Number of frames being convolved", 0, G_MAXINT, 0,
+                       static_cast<GParamFlags>(G_PARAM_READABLE |
+                                                G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_ORIGINAL_KERNEL_FRAMES,
+      g_param_spec_int(
+          "original-kernel-frames", "Original Kernel Frames",
+          "Number of frames before the optional preprocessing", 0, G_MAXINT,
+          0,
+          static_cast<GParamFlags>(G_PARAM_READABLE |
+                                   G_PARAM_STATIC_STRINGS)));
 }
 
 static void gst_peconvolver_init(GstPeconvolver* peconvolver) {
   peconvolver->log_tag = "convolver: ";
   peconvolver->ready = false;
+  peconvolver->building = false;
   peconvolver->irs_fail_count = 0;
+  peconvolver->generation = 0;
+  peconvolver->engine = nullptr;
+  peconvolver->next_engine = nullptr;
   peconvolver->rate = 0;
   peconvolver->bpf = 0;
   peconvolver->kernel_path = nullptr;
   peconvolver->ir_width = 100;
+  peconvolver->auto_tune = false;
+  peconvolver->trim_tail = false;
+  peconvolver->trim_threshold = -60.0f;
+  peconvolver->minimum_phase = false;
+  peconvolver->kernel_n_frames = 0;
+  peconvolver->original_n_frames = 0;
   peconvolver->num_samples = 0;
+  peconvolver->use_fifo = false;
+  peconvolver->fifo_fade = false;
+  peconvolver->fifo_in_n_frames = 0;
+  peconvolver->fifo_out_pos = 0;
+  peconvolver->fifo_out_n_frames = 0;
+
+  peconvolver->sinkpad =
+      gst_element_get_static_pad(GST_ELEMENT(peconvolver), "sink");
+
+  peconvolver->srcpad =
+      gst_element_get_static_pad(GST_ELEMENT(peconvolver), "src");
+
+  gst_pad_set_query_function(peconvolver->srcpad, gst_peconvolver_src_query);
 
   gst_base_transform_set_in_place(GST_BASE_TRANSFORM(peconvolver), true);
 }
@@ -182,6 +325,19 @@ void gst_peconvolver_set_property(GObject* object,
     case PROP_IR_WIDTH:
       gst_peconvolver_set_ir_width(peconvolver, g_value_get_int(value));
       break;
+    case PROP_AUTO_TUNE:
+      gst_peconvolver_set_auto_tune(peconvolver, g_value_get_boolean(value));
+      break;
+    case PROP_TRIM_TAIL:
+      gst_peconvolver_set_trim_tail(peconvolver, g_value_get_boolean(value));
+      break;
+    case PROP_TRIM_THRESHOLD:
+      gst_peconvolver_set_trim_threshold(peconvolver, g_value_get_float(value));
+      break;
+    case PROP_MINIMUM_PHASE:
+      gst_peconvolver_set_minimum_phase(peconvolver,
+                                        g_value_get_boolean(value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
       break;
@@ -203,6 +359,24 @@ void gst_peconvolver_get_property(GObject* object,
     case PROP_IR_WIDTH:
       g_value_set_int(value, peconvolver->ir_width);
       break;
+    case PROP_AUTO_TUNE:
+      g_value_set_boolean(value, peconvolver->auto_tune);
+      break;
+    case PROP_TRIM_TAIL:
+      g_value_set_boolean(value, peconvolver->trim_tail);
+      break;
+    case PROP_TRIM_THRESHOLD:
+      g_value_set_float(value, peconvolver->trim_threshold);
+      break;
+    case PROP_MINIMUM_PHASE:
+      g_value_set_boolean(value, peconvolver->minimum_phase);
+      break;
+    case PROP_KERNEL_FRAMES:
+      g_value_set_int(value, peconvolver->kernel_n_frames);
+      break;
+    case PROP_ORIGINAL_KERNEL_FRAMES:
+      g_value_set_int(value, peconvolver->original_n_frames);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
       break;
@@ -254,33 +428,72 @@ static GstFlowReturn gst_peconvolver_transform_ip(GstBaseTransform* trans,
 
   GstMapInfo map;
 
-  gst_buffer_map(buffer, &map, GST_MAP_READ);
+  gst_buffer_map(buffer, &map, GST_MAP_READWRITE);
 
   guint num_samples = map.size / peconvolver->bpf;
 
-  gst_buffer_unmap(buffer, &map);
+  float* data = (float*)map.data;
 
-  if (peconvolver->ready) {
-    if (peconvolver->num_samples == num_samples) {
-      gst_peconvolver_process(peconvolver, buffer);
-    } else {
-      gst_peconvolver_finish_convolver(peconvolver);
+  bool discont = GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DISCONT);
+
+  if (peconvolver->num_samples == 0) {
+    /*
+      The zita block size is chosen only once, from the first buffer, and
+      rounded to a power of two. Buffers of any other size are handled by the
+      fifo, so the engine never has to be rebuilt because of them.
+    */
+
+    uint block_size = Convproc::MINPART;
+
+    while (block_size < num_samples && block_size < Convproc::MAXPART) {
+      block_size *= 2;
     }
-  } else if (peconvolver->irs_fail_count == 0) {
-    peconvolver->num_samples = num_samples;
 
-    auto f = [=]() {
-      std::lock_guard<std::mutex> lock(peconvolver->lock_guard_zita);
-      gst_peconvolver_setup_convolver(peconvolver);
-    };
+    peconvolver->num_samples = block_size;
+
+    // the fifo buffers are allocated here only
 
-    peconvolver->futures.clear();
+    peconvolver->fifo_in.assign(2 * block_size, 0.0f);
+    peconvolver->fifo_out.assign(4 * block_size, 0.0f);
+    peconvolver->last_block.assign(2 * block_size, 0.0f);
 
-    auto future = std::async(std::launch::async, f);
+    util::debug(peconvolver->log_tag + "zita block size: " +
+                std::to_string(block_size));
 
-    peconvolver->futures.push_back(std::move(future));
+    gst_peconvolver_request_engine(peconvolver);
+
+    // nothing was played yet. The fifo starts with silence
+
+    if (num_samples != block_size) {
+      gst_peconvolver_start_fifo(peconvolver);
+
+      peconvolver->fifo_fade = false;
+    }
+  } else if (!peconvolver->ready && !peconvolver->building &&
+             peconvolver->irs_fail_count == 0) {
+    gst_peconvolver_request_engine(peconvolver);
   }
 
+  if (peconvolver->use_fifo && discont &&
+      num_samples == peconvolver->num_samples) {
+    // the stream was interrupted anyway. A good moment to drop the latency
+
+    gst_peconvolver_stop_fifo(peconvolver, data);
+  } else if (!peconvolver->use_fifo &&
+             num_samples == peconvolver->num_samples) {
+    gst_peconvolver_process_block(peconvolver, data);
+
+    std::copy(data, data + 2 * num_samples, peconvolver->last_block.begin());
+  } else {
+    if (!peconvolver->use_fifo) {
+      gst_peconvolver_start_fifo(peconvolver);
+    }
+
+    gst_peconvolver_process_fifo(peconvolver, data, num_samples);
+  }
+
+  gst_buffer_unmap(buffer, &map);
+
   return GST_FLOW_OK;
 }
 
@@ -308,8 +521,11 @@ static void gst_peconvolver_set_kernel_path(GstPeconvolver* peconvolver,
 
       if (peconvolver->kernel_path != nullptr) {
         if (old_path != peconvolver->kernel_path) {
-          // resetting zita
-          gst_peconvolver_finish_convolver(peconvolver);
+          // the current engine keeps running until the new one is ready
+
+          peconvolver->irs_fail_count = 0;
+
+          gst_peconvolver_request_engine(peconvolver);
         }
       }
     } else {
@@ -327,153 +543,644 @@ static void gst_peconvolver_set_ir_width(GstPeconvolver* peconvolver,
 
     peconvolver->ir_width = value;
 
-    if (peconvolver->ready) {
-      // resetting zita
-      gst_peconvolver_finish_convolver(peconvolver);
+    // the current engine keeps running until the new one is ready
+
+    peconvolver->irs_fail_count = 0;
+
+    gst_peconvolver_request_engine(peconvolver);
+  }
+}
+
+static void gst_peconvolver_set_auto_tune(GstPeconvolver* peconvolver,
+                                          const bool& value) {
+  if (value != peconvolver->auto_tune) {
+    std::lock_guard<std::mutex> lock(peconvolver->lock_guard_zita);
+
+    peconvolver->auto_tune = value;
+
+    // the current engine keeps running until the new one is ready
+
+    peconvolver->irs_fail_count = 0;
+
+    gst_peconvolver_request_engine(peconvolver);
+  }
+}
+
+static void gst_peconvolver_set_trim_tail(GstPeconvolver* peconvolver,
+                                          const bool& value) {
+  if (value != peconvolver->trim_tail) {
+    std::lock_guard<std::mutex> lock(peconvolver->lock_guard_zita);
+
+    peconvolver->trim_tail = value;
+
+    peconvolver->irs_fail_count = 0;
+
+    gst_peconvolver_request_engine(peconvolver);
+  }
+}
+
+static void gst_peconvolver_set_trim_threshold(GstPeconvolver* peconvolver,
+                                               const float& value) {
+  if (value != peconvolver->trim_threshold) {
+    std::lock_guard<std::mutex> lock(peconvolver->lock_guard_zita);
+
+    peconvolver->trim_threshold = value;
+
+    peconvolver->irs_fail_count = 0;
+
+    // the threshold does nothing while the trimming is disabled
+
+    if (peconvolver->trim_tail) {
+      gst_peconvolver_request_engine(peconvolver);
     }
   }
 }
 
-static void gst_peconvolver_setup_convolver(GstPeconvolver* peconvolver) {
-  if (!peconvolver->ready && peconvolver->rate != 0 && peconvolver->bpf != 0) {
-    bool irs_ok = rk::read_file(peconvolver);
+static void gst_peconvolver_set_minimum_phase(GstPeconvolver* peconvolver,
+                                              const bool& value) {
+  if (value != peconvolver->minimum_phase) {
+    std::lock_guard<std::mutex> lock(peconvolver->lock_guard_zita);
 
-    if (irs_ok) {
-      bool failed = false;
-      float density = 0.0f;
-      int max_size = peconvolver->kernel_n_frames, ret;
+    peconvolver->minimum_phase = value;
 
-      peconvolver->irs_fail_count = 0;
+    peconvolver->irs_fail_count = 0;
 
-      peconvolver->conv = new Convproc();
+    gst_peconvolver_request_engine(peconvolver);
+  }
+}
 
-      unsigned int options = 0;
+/*
+  Must be called with lock_guard_zita held. The kernel settings are copied so
+  that the builder thread does not have to touch the element.
+*/
+
+static void gst_peconvolver_request_engine(GstPeconvolver* peconvolver) {
+  if (peconvolver->rate == 0 || peconvolver->bpf == 0 ||
+      peconvolver->num_samples == 0 || peconvolver->kernel_path == nullptr) {
+    return;
+  }
 
-      // depending on buffer and kernel size OPT_FFTW_MEASURE may make un crash
-      // options |= Convproc::OPT_FFTW_MEASURE;
-      options |= Convproc::OPT_VECTOR_MODE;
+  // forgetting about the builders that have already finished
 
-      peconvolver->conv->set_options(options);
+  peconvolver->futures.erase(
+      std::remove_if(peconvolver->futures.begin(), peconvolver->futures.end(),
+                     [](auto& f) {
+                       return f.wait_for(std::chrono::seconds(0)) ==
+                              std::future_status::ready;
+                     }),
+      peconvolver->futures.end());
 
-#if ZITA_CONVOLVER_MAJOR_VERSION == 3
-      peconvolver->conv->set_density(density);
+  uint generation = ++peconvolver->generation;
 
-      ret = peconvolver->conv->configure(
-          2, 2, max_size, peconvolver->num_samples, peconvolver->num_samples,
-          Convproc::MAXPART);
-#endif
+  std::string kernel_path = peconvolver->kernel_path;
+  int rate = peconvolver->rate;
+  uint ir_width = peconvolver->ir_width;
+  uint num_samples = peconvolver->num_samples;
+  bool auto_tune = peconvolver->auto_tune;
+  rk::Preprocess preprocess;
+  std::string log_tag = peconvolver->log_tag;
 
-#if ZITA_CONVOLVER_MAJOR_VERSION == 4
-      ret = peconvolver->conv->configure(
-          2, 2, max_size, peconvolver->num_samples, peconvolver->num_samples,
-          Convproc::MAXPART, density);
-#endif
+  preprocess.trim_tail = peconvolver->trim_tail;
+  preprocess.trim_threshold = peconvolver->trim_threshold;
+  preprocess.minimum_phase = peconvolver->minimum_phase;
 
-      if (ret != 0) {
-        failed = true;
-        util::debug(
-            peconvolver->log_tag +
-            "can't initialise zita-convolver engine: " + std::to_string(ret));
-      }
+  peconvolver->building = true;
 
-      ret = peconvolver->conv->impdata_create(0, 0, 1, peconvolver->kernel_L, 0,
-                                              peconvolver->kernel_n_frames);
+  auto f = [=]() {
+    auto engine = gst_peconvolver_create_engine(
+        kernel_path, rate, ir_width, num_samples, auto_tune, preprocess,
+        log_tag);
 
-      if (ret != 0) {
-        failed = true;
-        util::debug(peconvolver->log_tag +
-                    "left impdata_create failed: " + std::to_string(ret));
-      }
+    std::lock_guard<std::mutex> lock(peconvolver->lock_guard_next);
 
-      ret = peconvolver->conv->impdata_create(1, 1, 1, peconvolver->kernel_R, 0,
-                                              peconvolver->kernel_n_frames);
+    if (generation != peconvolver->generation) {
+      // the settings changed while we were working. Another builder is coming
 
-      if (ret != 0) {
-        failed = true;
-        util::debug(peconvolver->log_tag +
-                    "right impdata_create failed: " + std::to_string(ret));
+      if (engine != nullptr) {
+        gst_peconvolver_destroy_engine(engine);
       }
 
-      ret = peconvolver->conv->start_process(CONVPROC_SCHEDULER_PRIORITY,
-                                             CONVPROC_SCHEDULER_CLASS);
+      return;
+    }
 
-      if (ret != 0) {
-        failed = true;
-        util::debug(peconvolver->log_tag +
-                    "start_process failed: " + std::to_string(ret));
+    if (engine != nullptr) {
+      if (peconvolver->next_engine != nullptr) {
+        gst_peconvolver_destroy_engine(peconvolver->next_engine);
       }
 
-      peconvolver->ready = (failed) ? false : true;
+      peconvolver->next_engine = engine;
     } else {
-      util::debug(peconvolver->log_tag + "we will just passthrough data.");
+      util::debug(log_tag + "we will just passthrough data.");
 
-      peconvolver->ready = false;
       peconvolver->irs_fail_count++;
     }
-  }
+
+    peconvolver->building = false;
+  };
+
+  peconvolver->futures.push_back(std::async(std::launch::async, f));
 }
 
-static void gst_peconvolver_process(GstPeconvolver* peconvolver,
-                                    GstBuffer* buffer) {
-  if (peconvolver->ready) {
-    GstMapInfo map;
+static PeconvolverEngine* gst_peconvolver_create_engine(
+    const std::string& kernel_path,
+    const int& rate,
+    const uint& ir_width,
+    const uint& num_samples,
+    const bool& auto_tune,
+    const rk::Preprocess& preprocess,
+    const std::string& log_tag) {
+  std::vector<std::vector<float>> kernels;
+  std::vector<float*> data;
+  kc::MappedKernel cached;
+  int n_frames, original_n_frames;
+
+  auto preprocess_tag = preprocess.to_string();
+
+  if (kc::load(kernel_path, rate, preprocess_tag, cached)) {
+    n_frames = cached.n_frames;
+    original_n_frames = cached.original_n_frames;
+
+    // the cache file is mapped read only. The width needs a copy
+
+    if (ir_width != 100) {
+      for (auto& k : cached.kernels) {
+        kernels.emplace_back(k, k + n_frames);
+      }
+    } else {
+      data = cached.kernels;
+    }
+  } else {
+    if (!rk::read_file(kernel_path, rate, kernels)) {
+      return nullptr;
+    }
+
+    original_n_frames = kernels[0].size();
+
+    rk::preprocess(kernels, rate, preprocess);
 
-    gst_buffer_map(buffer, &map, GST_MAP_READWRITE);
+    kc::store(kernel_path, rate, preprocess_tag, original_n_frames, kernels);
 
-    // deinterleave
-    for (unsigned int n = 0; n < peconvolver->num_samples; n++) {
-      peconvolver->conv->inpdata(0)[n] = ((float*)map.data)[2 * n];
-      peconvolver->conv->inpdata(1)[n] = ((float*)map.data)[2 * n + 1];
+    n_frames = kernels[0].size();
+  }
+
+  if (data.empty()) {
+    for (auto& k : kernels) {
+      data.push_back(k.data());
     }
 
-    int ret = peconvolver->conv->process(THREAD_SYNC_MODE);
+    rk::set_width(data, n_frames, ir_width);
+  }
 
-    if (ret != 0) {
-      util::debug(peconvolver->log_tag +
-                  "IR: process failed: " + std::to_string(ret));
+  /*
+    The tuning pass is slow. It only runs once for each combination of
+    sampling rate, block size and kernel length. After that the stored layout
+    is used.
+  */
+
+  pt::Layout layout;
+
+  if (auto_tune) {
+    if (!pt::load(rate, num_samples, n_frames, data.size(), layout)) {
+      layout = pt::tune(data, rate, n_frames, num_samples, log_tag);
+
+      pt::store(rate, num_samples, n_frames, data.size(), layout);
     }
+  }
+
+  bool failed = false;
+  float density = 0.0f;
+  int ret;
+
+  auto engine = new PeconvolverEngine();
+
+  engine->conv = new Convproc();
+  engine->num_samples = num_samples;
+  engine->kernel_n_frames = n_frames;
+  engine->original_n_frames = original_n_frames;
+
+  int max_size = engine->kernel_n_frames;
+
+  unsigned int options = 0;
+
+  /*
+    depending on buffer and kernel size OPT_FFTW_MEASURE may make un crash. It
+    is only used when the tuning pass has seen it working for this layout.
+  */
+
+  if (layout.fftw_measure) {
+    options |= Convproc::OPT_FFTW_MEASURE;
+
+    pt::import_wisdom();
+  }
+
+  options |= Convproc::OPT_VECTOR_MODE;
+
+  engine->conv->set_options(options);
+
+#if ZITA_CONVOLVER_MAJOR_VERSION == 3
+  engine->conv->set_density(density);
+
+  ret = engine->conv->configure(2, 2, max_size, num_samples, num_samples,
+                                layout.max_part);
+#endif
+
+#if ZITA_CONVOLVER_MAJOR_VERSION == 4
+  ret = engine->conv->configure(2, 2, max_size, num_samples, num_samples,
+                                layout.max_part, density);
+#endif
+
+  if (ret != 0) {
+    failed = true;
+    util::debug(log_tag + "can't initialise zita-convolver engine: " +
+                std::to_string(ret));
+  }
+
+  /*
+    A stereo kernel only has the paths L -> L and R -> R. A true stereo kernel
+    also has the cross paths L -> R and R -> L. In both cases each input is
+    transformed only once and its partitions are shared by all its paths.
+  */
+
+  std::vector<std::array<uint, 2>> paths;  // {input, output}
+
+  if (data.size() == 4) {
+    paths = {{0, 0}, {0, 1}, {1, 0}, {1, 1}};
+  } else {
+    paths = {{0, 0}, {1, 1}};
+  }
 
-    // interleave
-    for (unsigned int n = 0; n < peconvolver->num_samples; n++) {
-      ((float*)map.data)[2 * n] = peconvolver->conv->outdata(0)[n];
-      ((float*)map.data)[2 * n + 1] = peconvolver->conv->outdata(1)[n];
+  for (uint n = 0; n < paths.size(); n++) {
+    ret = engine->conv->impdata_create(paths[n][0], paths[n][1], 1, data[n], 0,
+                                       engine->kernel_n_frames);
+
+    if (ret != 0) {
+      failed = true;
+      util::debug(log_tag + "impdata_create failed for path " +
+                  std::to_string(paths[n][0]) + " -> " +
+                  std::to_string(paths[n][1]) + ": " + std::to_string(ret));
     }
+  }
 
-    gst_buffer_unmap(buffer, &map);
+  ret = engine->conv->start_process(CONVPROC_SCHEDULER_PRIORITY,
+                                    CONVPROC_SCHEDULER_CLASS);
+
+  if (ret != 0) {
+    failed = true;
+    util::debug(log_tag + "start_process failed: " + std::to_string(ret));
   }
+
+  if (failed) {
+    gst_peconvolver_destroy_engine(engine);
+
+    return nullptr;
+  }
+
+  return engine;
 }
 
-static void gst_peconvolver_finish_convolver(GstPeconvolver* peconvolver) {
-  peconvolver->irs_fail_count = 0;
+static void gst_peconvolver_process(PeconvolverEngine* engine,
+                                    float* data,
+                                    const std::string& log_tag) {
+  dsp::deinterleave(data, engine->conv->inpdata(0), engine->conv->inpdata(1),
+                    engine->num_samples);
 
-  if (peconvolver->ready) {
-    peconvolver->ready = false;
+  int ret = engine->conv->process(THREAD_SYNC_MODE);
 
-    if (peconvolver->conv != nullptr) {
-      if (peconvolver->conv->state() != Convproc::ST_STOP) {
-        peconvolver->conv->stop_process();
+  if (ret != 0) {
+    util::debug(log_tag + "IR: process failed: " + std::to_string(ret));
+  }
 
-        peconvolver->conv->cleanup();
+  dsp::interleave(engine->conv->outdata(0), engine->conv->outdata(1), data,
+                  engine->num_samples);
+}
 
-        delete peconvolver->conv;
+/*
+  Processes num_samples frames. This is where a new engine built in the
+  background is picked. The streaming thread never waits for the builder. If
+  the lock is busy the new engine is picked in the next block.
+*/
 
-        peconvolver->conv = nullptr;
-      }
+static void gst_peconvolver_process_block(GstPeconvolver* peconvolver,
+                                          float* data) {
+  PeconvolverEngine* new_engine = nullptr;
+
+  if (peconvolver->lock_guard_next.try_lock()) {
+    new_engine = peconvolver->next_engine;
+
+    peconvolver->next_engine = nullptr;
+
+    peconvolver->lock_guard_next.unlock();
+  }
+
+  if (new_engine != nullptr) {
+    if (new_engine->num_samples == peconvolver->num_samples) {
+      gst_peconvolver_crossfade(peconvolver, new_engine, data);
+    } else {
+      gst_peconvolver_retire_engine(peconvolver, new_engine);
     }
+  } else if (peconvolver->ready) {
+    gst_peconvolver_process(peconvolver->engine, data, peconvolver->log_tag);
+  }
+}
+
+/*
+  Input frames are accumulated until there is a full block to process. The
+  output ring was primed with one block and the input is handled in chunks
+  that never go past a block boundary. So the ring always has the frames we
+  need and never holds more than two blocks.
+*/
+
+static void gst_peconvolver_process_fifo(GstPeconvolver* peconvolver,
+                                         float* data,
+                                         const uint& n_frames) {
+  uint block_size = peconvolver->num_samples;
+  uint consumed = 0;
 
-    if (peconvolver->kernel_L != nullptr) {
-      delete[] peconvolver->kernel_L;
+  while (consumed < n_frames) {
+    uint n = std::min(n_frames - consumed,
+                      block_size - peconvolver->fifo_in_n_frames);
+
+    float* chunk = data + 2 * consumed;
+
+    std::copy(chunk, chunk + 2 * n,
+              peconvolver->fifo_in.begin() + 2 * peconvolver->fifo_in_n_frames);
+
+    peconvolver->fifo_in_n_frames += n;
+
+    if (peconvolver->fifo_in_n_frames == block_size) {
+      float* block = peconvolver->fifo_in.data();
+
+      gst_peconvolver_process_block(peconvolver, block);
+
+      if (peconvolver->fifo_fade) {
+        // joining the mirrored block that was used to prime the ring
+
+        dsp::crossfade(peconvolver->last_block.data(), block, block_size);
+
+        peconvolver->fifo_fade = false;
+      }
+
+      gst_peconvolver_fifo_write(peconvolver, block, block_size);
+
+      peconvolver->fifo_in_n_frames = 0;
     }
 
-    if (peconvolver->kernel_R != nullptr) {
-      delete[] peconvolver->kernel_R;
+    gst_peconvolver_fifo_read(peconvolver, chunk, n);
+
+    consumed += n;
+  }
+}
+
+/*
+  The fifo adds one block of latency. When audio was already played through
+  the direct path there is no output for that block. Instead of silence it is
+  filled with the last block played in reverse order, which continues the
+  waveform without a step. It ends where that block started, so the first
+  block coming out of the fifo crossfades from it.
+*/
+
+static void gst_peconvolver_start_fifo(GstPeconvolver* peconvolver) {
+  uint block_size = peconvolver->num_samples;
+  float* mirror = peconvolver->fifo_out.data();
+  const float* last = peconvolver->last_block.data();
+
+  for (uint n = 0; n < block_size; n++) {
+    mirror[2 * n] = last[2 * (block_size - 1 - n)];
+    mirror[2 * n + 1] = last[2 * (block_size - 1 - n) + 1];
+  }
+
+  peconvolver->use_fifo = true;
+  peconvolver->fifo_fade = true;
+  peconvolver->fifo_in_n_frames = 0;
+  peconvolver->fifo_out_pos = 0;
+  peconvolver->fifo_out_n_frames = block_size;
+
+  util::debug(peconvolver->log_tag +
+              "the buffer size does not match the zita block size. Using a "
+              "fifo.");
+
+  gst_element_post_message(
+      GST_ELEMENT_CAST(peconvolver),
+      gst_message_new_latency(GST_OBJECT_CAST(peconvolver)));
+}
+
+/*
+  Back to the direct path after a discontinuity. The output still waiting in
+  the ring fades out while the direct output fades in.
+*/
+
+static void gst_peconvolver_stop_fifo(GstPeconvolver* peconvolver,
+                                      float* data) {
+  uint block_size = peconvolver->num_samples;
+  float* pending = peconvolver->last_block.data();
+
+  uint n = std::min(peconvolver->fifo_out_n_frames, block_size);
+
+  gst_peconvolver_fifo_read(peconvolver, pending, n);
+
+  std::fill(pending + 2 * n, pending + 2 * block_size, 0.0f);
+
+  gst_peconvolver_process_block(peconvolver, data);
+
+  dsp::crossfade(pending, data, block_size);
+
+  std::copy(data, data + 2 * block_size, pending);
+
+  peconvolver->use_fifo = false;
+  peconvolver->fifo_fade = false;
+  peconvolver->fifo_in_n_frames = 0;
+  peconvolver->fifo_out_pos = 0;
+  peconvolver->fifo_out_n_frames = 0;
+
+  util::debug(peconvolver->log_tag + "discontinuity. Leaving the fifo.");
+
+  gst_element_post_message(
+      GST_ELEMENT_CAST(peconvolver),
+      gst_message_new_latency(GST_OBJECT_CAST(peconvolver)));
+}
+
+static void gst_peconvolver_fifo_write(GstPeconvolver* peconvolver,
+                                       const float* data,
+                                       const uint& n_frames) {
+  uint size = peconvolver->fifo_out.size() / 2;
+  uint pos = peconvolver->fifo_out_pos + peconvolver->fifo_out_n_frames;
+
+  pos %= size;
+  uint first = std::min(n_frames, size - pos);
+
+  std::copy(data, data + 2 * first, peconvolver->fifo_out.begin() + 2 * pos);
+  std::copy(data + 2 * first, data + 2 * n_frames,
+            peconvolver->fifo_out.begin());
+
+  peconvolver->fifo_out_n_frames += n_frames;
+}
+
+static void gst_peconvolver_fifo_read(GstPeconvolver* peconvolver,
+                                      float* data,
+                                      const uint& n_frames) {
+  uint size = peconvolver->fifo_out.size() / 2;
+  uint pos = peconvolver->fifo_out_pos;
+  uint first = std::min(n_frames, size - pos);
+  auto ring = peconvolver->fifo_out.begin();
+
+  std::copy(ring + 2 * pos, ring + 2 * (pos + first), data);
+  std::copy(ring, ring + 2 * (n_frames - first), data + 2 * first);
+
+  peconvolver->fifo_out_pos = (pos + n_frames) % size;
+  peconvolver->fifo_out_n_frames -= n_frames;
+}
+
+/*
+  The buffer is processed by both the old and the new engine and the outputs
+  are mixed with a linear ramp. When there is no old engine the ramp goes from
+  the dry signal to the new one.
+*/
+
+static void gst_peconvolver_crossfade(GstPeconvolver* peconvolver,
+                                      PeconvolverEngine* new_engine,
+                                      float* data) {
+  uint num_samples = new_engine->num_samples;
+
+  peconvolver->crossfade_data.resize(2 * num_samples);
+
+  float* old_data = peconvolver->crossfade_data.data();
+
+  std::copy(data, data + 2 * num_samples, old_data);
+
+  if (peconvolver->ready) {
+    gst_peconvolver_process(peconvolver->engine, old_data,
+                            peconvolver->log_tag);
+  }
+
+  gst_peconvolver_process(new_engine, data, peconvolver->log_tag);
+
+  dsp::crossfade(old_data, data, num_samples);
+
+  gst_peconvolver_retire_engine(peconvolver, peconvolver->engine);
+
+  peconvolver->engine = new_engine;
+  peconvolver->ready = true;
+
+  peconvolver->kernel_n_frames = new_engine->kernel_n_frames;
+  peconvolver->original_n_frames = new_engine->original_n_frames;
+}
+
+static void gst_peconvolver_destroy_engine(PeconvolverEngine* engine) {
+  if (engine->conv != nullptr) {
+    if (engine->conv->state() != Convproc::ST_STOP) {
+      engine->conv->stop_process();
     }
 
-    peconvolver->futures.clear();
+    engine->conv->cleanup();
+
+    delete engine->conv;
   }
+
+  delete engine;
+}
+
+/*
+  Stopping zita threads may take a while. So we do it outside the streaming
+  thread.
+*/
+
+static void gst_peconvolver_retire_engine(GstPeconvolver* peconvolver,
+                                          PeconvolverEngine* engine) {
+  if (engine != nullptr) {
+    peconvolver->futures.push_back(std::async(
+        std::launch::async, [=]() { gst_peconvolver_destroy_engine(engine); }));
+  }
+}
+
+static void gst_peconvolver_finish_convolver(GstPeconvolver* peconvolver) {
+  peconvolver->irs_fail_count = 0;
+  peconvolver->ready = false;
+  peconvolver->num_samples = 0;
+  peconvolver->use_fifo = false;
+  peconvolver->fifo_fade = false;
+  peconvolver->fifo_in_n_frames = 0;
+  peconvolver->fifo_out_pos = 0;
+  peconvolver->fifo_out_n_frames = 0;
+  peconvolver->fifo_in.clear();
+  peconvolver->fifo_out.clear();
+  peconvolver->last_block.clear();
+
+  // builders still running will discard their result
+
+  peconvolver->generation++;
+
+  peconvolver->futures.clear();
+
+  if (peconvolver->engine != nullptr) {
+    gst_peconvolver_destroy_engine(peconvolver->engine);
+
+    peconvolver->engine = nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(peconvolver->lock_guard_next);
+
+  if (peconvolver->next_engine != nullptr) {
+    gst_peconvolver_destroy_engine(peconvolver->next_engine);
+
+    peconvolver->next_engine = nullptr;
+  }
+
+  peconvolver->building = false;
+}
+
+static gboolean gst_peconvolver_src_query(GstPad* pad,
+                                          GstObject* parent,
+                                          GstQuery* query) {
+  GstPeconvolver* peconvolver = GST_PECONVOLVER(parent);
+  bool ret = true;
+
+  switch (GST_QUERY_TYPE(query)) {
+    case GST_QUERY_LATENCY:
+      if (peconvolver->rate > 0) {
+        ret = gst_pad_peer_query(peconvolver->sinkpad, query);
+
+        if (ret && peconvolver->use_fifo) {
+          GstClockTime min, max;
+          gboolean live;
+          guint64 latency;
+
+          gst_query_parse_latency(query, &live, &min, &max);
+
+          /* add our own latency */
+
+          latency = gst_util_uint64_scale_round(peconvolver->num_samples,
+                                                GST_SECOND, peconvolver->rate);
+
+          min += latency;
+
+          if (max != GST_CLOCK_TIME_NONE) {
+            max += latency;
+          }
+
+          gst_query_set_latency(query, live, min, max);
+        }
+      } else {
+        ret = false;
+      }
+
+      break;
+    default:
+      /* just call the default handler */
+      ret = gst_pad_query_default(pad, parent, query);
+      break;
+  }
+
+  return ret;
 }
 
 static gboolean plugin_init(GstPlugin* plugin) {
+  /*
+    Every zita instance in the process shares the FFTW planner, which is not
+    thread safe. Engines are built from several threads and pipelines.
+  */
+
+  fftwf_make_planner_thread_safe();
+
   /* FIXME Remember to set the rank if it's an element that is meant
      to be autoplugged by decodebin. */
   return gst_element_register(plugin, "peconvolver", GST_RANK_NONE,
@@ -3,6 +3,7 @@
 
 #include <gst/audio/gstaudiofilter.h>
 #include <zita-convolver.h>
+#include <atomic>
 #include <future>
 #include <mutex>
 #include <vector>
@@ -22,29 +23,63 @@ G_BEGIN_DECLS
 typedef struct _GstPeconvolver GstPeconvolver;
 typedef struct _GstPeconvolverClass GstPeconvolverClass;
 
+/* a zita instance already loaded with an impulse response */
+
+struct PeconvolverEngine {
+  Convproc* conv = nullptr;
+  uint num_samples = 0;  // zita block size
+  int kernel_n_frames = 0;
+  int original_n_frames = 0;  // before trimming the tail
+};
+
 struct _GstPeconvolver {
   GstAudioFilter base_peconvolver;
 
   /* properties */
 
   gchar* kernel_path = nullptr;
-  unsigned int ir_width, num_samples;
+  unsigned int ir_width, num_samples;  // num_samples is the zita block size
+  bool auto_tune;
+  bool trim_tail, minimum_phase;
+  float trim_threshold;
+  std::atomic<int> kernel_n_frames, original_n_frames;  // read only
 
   /* < private > */
 
   bool ready;
-  int rate, kernel_n_frames, irs_fail_count;
-  int bpf;                    // bytes per frame : channels * bps
-  float* kernel_L = nullptr;  // left channel buffer
-  float* kernel_R = nullptr;  // right channel buffer
+  int rate;
+  int bpf;  // bytes per frame : channels * bps
+
+  std::atomic<bool> building;
+  std::atomic<int> irs_fail_count;
+  std::atomic<uint> generation;  // incremented when the kernel settings change
 
   std::string log_tag;
 
-  Convproc* conv = nullptr;
+  PeconvolverEngine* engine = nullptr;       // used by the streaming thread
+  PeconvolverEngine* next_engine = nullptr;  // built in the background
 
-  std::mutex lock_guard_zita;
+  std::vector<float> crossfade_data;
+
+  /*
+    When the buffers do not match the zita block size they go through these
+    fifos. The output one is a ring sized for two blocks when the block size
+    is chosen. While it is used the fifo adds num_samples frames of latency.
+  */
+
+  bool use_fifo;
+  bool fifo_fade;  // the first block out of the fifo fades in
+  uint fifo_in_n_frames;
+  uint fifo_out_pos, fifo_out_n_frames;  // ring read position and content
+  std::vector<float> fifo_in, fifo_out;
+
+  std::vector<float> last_block;  // last output of the direct path
+
+  std::mutex lock_guard_zita, lock_guard_next;
 
   std::vector<std::future<void>> futures;
+
+  GstPad *srcpad = nullptr, *sinkpad = nullptr;
 };
 
 struct _GstPeconvolverClass {
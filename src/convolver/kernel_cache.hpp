@@ -0,0 +1,301 @@
+#ifndef KERNEL_CACHE_HPP
+#define KERNEL_CACHE_HPP
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <glib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "util.hpp"
+
+/*
+  Disk cache for the kernels prepared by rk::read_file(). Resampling a long
+  impulse response with the best libsamplerate quality takes seconds. As the
+  convolver is rebuilt whenever the sampling rate or the buffer size changes we
+  store the final left and right kernels in the user cache directory.
+
+  File layout: Header followed by each kernel (L and R for stereo files, LL,
+  LR, RL and RR for true stereo ones) as native floats. This way a warm start
+  is just an mmap of the cache file. Kernels prepared with different
+  preprocessing options are stored in different files. The stereo width is
+  applied after loading so moving its slider does not create new files.
+
+  Loading a file updates its modification time. When the cache grows beyond
+  max_cache_size the files that were not used for the longest time are
+  removed.
+*/
+
+namespace kc {
+
+std::string cache_log_tag = "convolver cache: ";
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t rate;
+  uint32_t n_frames;
+  uint32_t n_kernels;
+  uint32_t original_n_frames;  // before the optional preprocessing
+  int64_t mtime_sec;   // modification time of the irs file
+  int64_t mtime_nsec;  // modification time of the irs file
+  int64_t file_size;   // size of the irs file
+};
+
+const char magic[8] = {'P', 'E', 'K', 'E', 'R', 'N', 'E', 'L'};
+const uint32_t version = 4;
+
+const off_t max_cache_size = 512 * 1024 * 1024;  // bytes
+
+class MappedKernel {
+ public:
+  MappedKernel() {}
+
+  MappedKernel(const MappedKernel&) = delete;
+
+  ~MappedKernel() {
+    if (data != nullptr) {
+      munmap(data, size);
+    }
+  }
+
+  std::vector<float*> kernels;
+  int n_frames = 0, original_n_frames = 0;
+
+  void* data = nullptr;
+  size_t size = 0;
+};
+
+std::string get_cache_dir() {
+  return std::string(g_get_user_cache_dir()) + "/PulseEffects/irs";
+}
+
+std::string get_cache_path(const std::string& irs_path,
+                           const int& rate,
+                           const std::string& options) {
+  std::ostringstream name;
+
+  name << get_cache_dir() << "/" << std::hex
+       << std::hash<std::string>{}(irs_path) << std::dec << "_" << rate
+       << options << ".kernel";
+
+  return name.str();
+}
+
+bool load(const std::string& irs_path,
+          const int& rate,
+          const std::string& options,
+          MappedKernel& mk) {
+  struct stat irs_stat;
+
+  if (stat(irs_path.c_str(), &irs_stat) != 0) {
+    return false;
+  }
+
+  auto cache_path = get_cache_path(irs_path, rate, options);
+
+  int fd = open(cache_path.c_str(), O_RDONLY);
+
+  if (fd == -1) {
+    return false;
+  }
+
+  struct stat cache_stat;
+
+  if (fstat(fd, &cache_stat) != 0 ||
+      (size_t)cache_stat.st_size < sizeof(Header)) {
+    close(fd);
+
+    return false;
+  }
+
+  void* data =
+      mmap(nullptr, cache_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  close(fd);
+
+  if (data == MAP_FAILED) {
+    return false;
+  }
+
+  auto header = static_cast<Header*>(data);
+
+  size_t expected_size = sizeof(Header) + (size_t)header->n_kernels *
+                                              header->n_frames * sizeof(float);
+
+  bool valid = std::memcmp(header->magic, magic, sizeof(magic)) == 0 &&
+               header->version == version && header->rate == (uint32_t)rate &&
+               header->n_frames > 0 &&
+               (header->n_kernels == 2 || header->n_kernels == 4) &&
+               header->mtime_sec == irs_stat.st_mtim.tv_sec &&
+               header->mtime_nsec == irs_stat.st_mtim.tv_nsec &&
+               header->file_size == irs_stat.st_size &&
+               (size_t)cache_stat.st_size == expected_size;
+
+  if (!valid) {
+    munmap(data, cache_stat.st_size);
+
+    util::debug(cache_log_tag + "stale cache file: " + cache_path);
+
+    return false;
+  }
+
+  mk.data = data;
+  mk.size = cache_stat.st_size;
+  mk.n_frames = header->n_frames;
+  mk.original_n_frames = header->original_n_frames;
+  auto first =
+      reinterpret_cast<float*>(static_cast<char*>(data) + sizeof(Header));
+
+  for (uint n = 0; n < header->n_kernels; n++) {
+    mk.kernels.push_back(first + n * mk.n_frames);
+  }
+
+  // marking the file as recently used
+
+  utimensat(AT_FDCWD, cache_path.c_str(), nullptr, 0);
+
+  util::debug(cache_log_tag + "using cached kernel: " + cache_path);
+
+  return true;
+}
+
+/*
+  Removes the least recently used files until the cache fits in
+  max_cache_size. The file given in keep is never removed.
+*/
+
+void evict(const std::string& keep) {
+  struct Entry {
+    std::string path;
+    off_t size;
+    time_t mtime;
+  };
+
+  std::vector<Entry> entries;
+  off_t total = 0;
+  auto cache_dir = get_cache_dir();
+
+  DIR* dir = opendir(cache_dir.c_str());
+
+  if (dir == nullptr) {
+    return;
+  }
+
+  while (auto entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    std::string suffix = ".kernel";
+    struct stat file_stat;
+
+    if (name.size() <= suffix.size() ||
+        name.compare(name.size() - suffix.size(), suffix.size(), suffix) !=
+            0) {
+      continue;
+    }
+
+    auto path = cache_dir + "/" + name;
+
+    if (stat(path.c_str(), &file_stat) == 0) {
+      entries.push_back({path, file_stat.st_size, file_stat.st_mtime});
+
+      total += file_stat.st_size;
+    }
+  }
+
+  closedir(dir);
+
+  std::sort(entries.begin(), entries.end(),
+            [](auto& a, auto& b) { return a.mtime < b.mtime; });
+
+  for (auto& e : entries) {
+    if (total <= max_cache_size) {
+      break;
+    }
+
+    if (e.path != keep && unlink(e.path.c_str()) == 0) {
+      total -= e.size;
+
+      util::debug(cache_log_tag + "evicted: " + e.path);
+    }
+  }
+}
+
+void store(const std::string& irs_path,
+           const int& rate,
+           const std::string& options,
+           const int& original_n_frames,
+           const std::vector<std::vector<float>>& kernels) {
+  struct stat irs_stat;
+
+  if (stat(irs_path.c_str(), &irs_stat) != 0) {
+    return;
+  }
+
+  if (g_mkdir_with_parents(get_cache_dir().c_str(), 0755) != 0) {
+    util::warning(cache_log_tag +
+                  "failed to create cache directory: " + get_cache_dir());
+
+    return;
+  }
+
+  Header header;
+
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.version = version;
+  header.rate = rate;
+  header.n_frames = kernels[0].size();
+  header.n_kernels = kernels.size();
+  header.original_n_frames = original_n_frames;
+  header.mtime_sec = irs_stat.st_mtim.tv_sec;
+  header.mtime_nsec = irs_stat.st_mtim.tv_nsec;
+  header.file_size = irs_stat.st_size;
+
+  auto cache_path = get_cache_path(irs_path, rate, options);
+
+  /*
+    The sink and source pipelines may be writing the same file. We write to a
+    temporary file and rename it so that readers never see a partial kernel.
+  */
+
+  std::string tmp_path = cache_path + ".XXXXXX";
+
+  int fd = mkstemp(&tmp_path[0]);
+
+  if (fd == -1) {
+    util::warning(cache_log_tag + "failed to create: " + tmp_path);
+
+    return;
+  }
+
+  size_t kernel_bytes = header.n_frames * sizeof(float);
+
+  bool ok = write(fd, &header, sizeof(Header)) == (ssize_t)sizeof(Header);
+
+  for (auto& k : kernels) {
+    ok = ok && write(fd, k.data(), kernel_bytes) == (ssize_t)kernel_bytes;
+  }
+
+  close(fd);
+
+  if (ok && std::rename(tmp_path.c_str(), cache_path.c_str()) == 0) {
+    util::debug(cache_log_tag + "saved kernel to: " + cache_path);
+
+    evict(cache_path);
+  } else {
+    unlink(tmp_path.c_str());
+
+    util::warning(cache_log_tag + "failed to save kernel to: " + cache_path);
+  }
+}
+
+}  // namespace kc
+
+#endif
@@ -0,0 +1,370 @@
+#ifndef PARTITION_TUNING_HPP
+#define PARTITION_TUNING_HPP
+
+#include <fftw3.h>
+#include <glib.h>
+#include <zita-convolver.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+#include "kernel_cache.hpp"
+#include "util.hpp"
+
+/*
+  Optional tuning of the zita partition layout. For a given sampling rate,
+  block size and kernel length we benchmark the candidate maximum partition
+  sizes with and without OPT_FFTW_MEASURE and keep the fastest one that did
+  not fail. Results are stored in the cache directory together with the FFTW
+  wisdom, so the measured plans do not have to be computed again.
+
+  Some layouts may crash zita. Before each one is tried it is written to the
+  tuning file. If it is still there in the next tuning pass the process died
+  while trying it and the layout is marked as unstable.
+*/
+
+namespace pt {
+
+std::string tuning_log_tag = "convolver tuning: ";
+
+// sink and source pipelines may update the tuning file at the same time
+
+std::mutex file_mutex;
+
+struct Layout {
+  uint max_part = Convproc::MAXPART;
+  bool fftw_measure = false;
+};
+
+std::string get_tuning_path() {
+  return kc::get_cache_dir() + "/tuning.ini";
+}
+
+std::string get_wisdom_path() {
+  return kc::get_cache_dir() + "/fftwf.wisdom";
+}
+
+std::string get_group_name(const int& rate,
+                           const uint& block_size,
+                           const int& n_frames,
+                           const uint& n_kernels) {
+  return std::to_string(rate) + "_" + std::to_string(block_size) + "_" +
+         std::to_string(n_frames) + "_" + std::to_string(n_kernels);
+}
+
+std::string get_layout_name(const Layout& layout) {
+  return std::to_string(layout.max_part) +
+         ((layout.fftw_measure) ? "_measure" : "");
+}
+
+void import_wisdom() {
+  fftwf_import_wisdom_from_filename(get_wisdom_path().c_str());
+}
+
+void export_wisdom() {
+  if (g_mkdir_with_parents(kc::get_cache_dir().c_str(), 0755) == 0) {
+    if (fftwf_export_wisdom_to_filename(get_wisdom_path().c_str()) == 0) {
+      util::warning(tuning_log_tag +
+                    "failed to save fftw wisdom to: " + get_wisdom_path());
+    }
+  }
+}
+
+bool load(const int& rate,
+          const uint& block_size,
+          const int& n_frames,
+          const uint& n_kernels,
+          Layout& layout) {
+  auto group = get_group_name(rate, block_size, n_frames, n_kernels);
+
+  std::lock_guard<std::mutex> lock(file_mutex);
+
+  GKeyFile* key_file = g_key_file_new();
+
+  bool found = false;
+
+  if (g_key_file_load_from_file(key_file, get_tuning_path().c_str(),
+                                G_KEY_FILE_NONE, nullptr) &&
+      g_key_file_has_group(key_file, group.c_str())) {
+    int max_part = g_key_file_get_integer(key_file, group.c_str(),
+                                          "max-part", nullptr);
+
+    if (max_part >= (int)block_size && max_part <= Convproc::MAXPART) {
+      layout.max_part = max_part;
+      layout.fftw_measure = g_key_file_get_boolean(key_file, group.c_str(),
+                                                   "fftw-measure", nullptr);
+
+      found = true;
+    }
+  }
+
+  g_key_file_free(key_file);
+
+  return found;
+}
+
+void store(const int& rate,
+           const uint& block_size,
+           const int& n_frames,
+           const uint& n_kernels,
+           const Layout& layout) {
+  auto group = get_group_name(rate, block_size, n_frames, n_kernels);
+
+  if (g_mkdir_with_parents(kc::get_cache_dir().c_str(), 0755) != 0) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(file_mutex);
+
+  GKeyFile* key_file = g_key_file_new();
+
+  g_key_file_load_from_file(key_file, get_tuning_path().c_str(),
+                            G_KEY_FILE_NONE, nullptr);
+
+  g_key_file_set_integer(key_file, group.c_str(), "max-part", layout.max_part);
+  g_key_file_set_boolean(key_file, group.c_str(), "fftw-measure",
+                         layout.fftw_measure);
+
+  if (!g_key_file_save_to_file(key_file, get_tuning_path().c_str(), nullptr)) {
+    util::warning(tuning_log_tag +
+                  "failed to save tuning results to: " + get_tuning_path());
+  }
+
+  g_key_file_free(key_file);
+}
+
+/*
+  Writes the layout about to be tried to the tuning file. An empty name clears
+  it. Returns the layouts that crashed in previous passes, including the one
+  that was left in the file.
+*/
+
+std::vector<std::string> set_trying(const std::string& group,
+                                    const std::string& name) {
+  std::vector<std::string> unstable;
+
+  if (g_mkdir_with_parents(kc::get_cache_dir().c_str(), 0755) != 0) {
+    return unstable;
+  }
+
+  std::lock_guard<std::mutex> lock(file_mutex);
+
+  GKeyFile* key_file = g_key_file_new();
+
+  g_key_file_load_from_file(key_file, get_tuning_path().c_str(),
+                            G_KEY_FILE_NONE, nullptr);
+
+  gsize length = 0;
+
+  gchar** list = g_key_file_get_string_list(key_file, group.c_str(),
+                                            "unstable", &length, nullptr);
+
+  for (gsize n = 0; n < length; n++) {
+    unstable.push_back(list[n]);
+  }
+
+  g_strfreev(list);
+
+  gchar* trying =
+      g_key_file_get_string(key_file, group.c_str(), "trying", nullptr);
+
+  if (trying != nullptr) {
+    std::string crashed = trying;
+
+    g_free(trying);
+
+    if (!crashed.empty() &&
+        std::find(unstable.begin(), unstable.end(), crashed) ==
+            unstable.end()) {
+      util::warning(tuning_log_tag + "layout " + crashed + " of " + group +
+                    " crashed in a previous pass. It will not be used");
+
+      unstable.push_back(crashed);
+    }
+  }
+
+  std::vector<const gchar*> values;
+
+  for (auto& u : unstable) {
+    values.push_back(u.c_str());
+  }
+
+  if (!values.empty()) {
+    g_key_file_set_string_list(key_file, group.c_str(), "unstable",
+                               values.data(), values.size());
+  }
+
+  g_key_file_set_string(key_file, group.c_str(), "trying", name.c_str());
+
+  if (!g_key_file_save_to_file(key_file, get_tuning_path().c_str(), nullptr)) {
+    util::warning(tuning_log_tag +
+                  "failed to save tuning state to: " + get_tuning_path());
+  }
+
+  g_key_file_free(key_file);
+
+  return unstable;
+}
+
+/*
+  Returns the average time in seconds that a zita cycle takes with this layout
+  or a negative number if the engine failed. In sync mode process() waits for
+  the threads computing the longer partitions, so their cost is included.
+*/
+
+double benchmark(const std::vector<float*>& kernels,
+                 const int& n_frames,
+                 const uint& block_size,
+                 const Layout& layout) {
+  int ret;
+  float density = 0.0f;
+  unsigned int options = Convproc::OPT_VECTOR_MODE;
+
+  if (layout.fftw_measure) {
+    options |= Convproc::OPT_FFTW_MEASURE;
+  }
+
+  Convproc conv;
+
+  conv.set_options(options);
+
+#if ZITA_CONVOLVER_MAJOR_VERSION == 3
+  conv.set_density(density);
+
+  ret = conv.configure(2, 2, n_frames, block_size, block_size, layout.max_part);
+#endif
+
+#if ZITA_CONVOLVER_MAJOR_VERSION == 4
+  ret = conv.configure(2, 2, n_frames, block_size, block_size, layout.max_part,
+                       density);
+#endif
+
+  bool failed = ret != 0;
+
+  if (!failed) {
+    std::vector<std::array<uint, 2>> paths;  // {input, output}
+
+    if (kernels.size() == 4) {
+      paths = {{0, 0}, {0, 1}, {1, 0}, {1, 1}};
+    } else {
+      paths = {{0, 0}, {1, 1}};
+    }
+
+    for (uint n = 0; n < paths.size() && !failed; n++) {
+      failed = conv.impdata_create(paths[n][0], paths[n][1], 1, kernels[n], 0,
+                                   n_frames) != 0;
+    }
+  }
+
+  if (!failed) {
+    failed = conv.start_process(0, SCHED_FIFO) != 0;
+  }
+
+  double elapsed = 0.0;
+
+  if (!failed) {
+    // enough cycles for the longest partitions to be computed a few times
+
+    uint n_cycles = 4 * layout.max_part / block_size + 32;
+
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (uint c = 0; c < n_cycles && !failed; c++) {
+      for (uint n = 0; n < block_size; n++) {
+        conv.inpdata(0)[n] = dist(gen);
+        conv.inpdata(1)[n] = dist(gen);
+      }
+
+      failed = conv.process(true) != 0;
+
+      for (uint n = 0; n < block_size && !failed; n++) {
+        failed = !std::isfinite(conv.outdata(0)[n]) ||
+                 !std::isfinite(conv.outdata(1)[n]);
+      }
+    }
+
+    auto t1 = std::chrono::steady_clock::now();
+
+    elapsed = std::chrono::duration<double>(t1 - t0).count() / n_cycles;
+  }
+
+  if (conv.state() != Convproc::ST_STOP) {
+    conv.stop_process();
+  }
+
+  conv.cleanup();
+
+  return (failed) ? -1.0 : elapsed;
+}
+
+Layout tune(const std::vector<float*>& kernels,
+            const int& rate,
+            const int& n_frames,
+            const uint& block_size,
+            const std::string& log_tag) {
+  Layout best;
+  double best_time = -1.0;
+
+  auto group = get_group_name(rate, block_size, n_frames, kernels.size());
+
+  import_wisdom();
+
+  for (uint max_part = block_size; max_part <= Convproc::MAXPART;
+       max_part *= 2) {
+    for (bool fftw_measure : {false, true}) {
+      Layout layout;
+
+      layout.max_part = max_part;
+      layout.fftw_measure = fftw_measure;
+
+      auto name = get_layout_name(layout);
+
+      auto unstable = set_trying(group, name);
+
+      if (std::find(unstable.begin(), unstable.end(), name) !=
+          unstable.end()) {
+        util::debug(log_tag + "skipping the unstable layout " + name);
+
+        continue;
+      }
+
+      double t = benchmark(kernels, n_frames, block_size, layout);
+
+      util::debug(log_tag + "max partition " + std::to_string(max_part) +
+                  ((fftw_measure) ? " (fftw measure): " : ": ") +
+                  ((t < 0.0) ? "failed" : std::to_string(t * 1e6) + " us"));
+
+      if (t >= 0.0 && (best_time < 0.0 || t < best_time)) {
+        best = layout;
+        best_time = t;
+      }
+    }
+
+    // longer partitions than the kernel itself are useless
+
+    if ((int)max_part >= n_frames) {
+      break;
+    }
+  }
+
+  set_trying(group, "");
+
+  export_wisdom();
+
+  util::debug(log_tag + "best max partition: " +
+              std::to_string(best.max_part) +
+              ((best.fftw_measure) ? " with fftw measure" : ""));
+
+  return best;
+}
+
+}  // namespace pt
+
+#endif
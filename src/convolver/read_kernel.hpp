@@ -1,36 +1,46 @@
 #ifndef READ_KERNEL_HPP
 #define READ_KERNEL_HPP
 
+#include <gst/fft/gstfftf32.h>
 #include <samplerate.h>
+#include <algorithm>
 #include <cmath>
+#include <complex>
 #include <cstdint>
 #include <cstring>
 #include <iostream>
 #include <sndfile.hh>
-#include "gstpeconvolver.hpp"
+#include <sstream>
+#include <vector>
 #include "util.hpp"
 
 namespace rk {
 
 std::string log_tag = "convolver: ";
 
-void autogain(float* left, float* right, int length) {
+void autogain(std::vector<std::vector<float>>& kernels) {
     float power = 0.0f, peak = 0.0f;
 
-    for (int n = 0; n < length; n++) {
-        peak = (left[n] > peak) ? left[n] : peak;
-        peak = (right[n] > peak) ? right[n] : peak;
+    for (auto& k : kernels) {
+        for (auto& v : k) {
+            peak = (v > peak) ? v : peak;
+        }
     }
 
     // normalize
-    for (int n = 0; n < length; n++) {
-        left[n] /= peak;
-        right[n] /= peak;
+    for (auto& k : kernels) {
+        for (auto& v : k) {
+            v /= peak;
+        }
     }
 
-    // find average power
-    for (int n = 0; n < length; n++) {
-        power += left[n] * left[n] + right[n] * right[n];
+    /* find average power per output channel. A stereo kernel has one path per
+       output and a true stereo kernel has two
+    */
+    for (auto& k : kernels) {
+        for (auto& v : k) {
+            power += v * v;
+        }
     }
 
     power *= 0.5f;
@@ -39,9 +49,10 @@ void autogain(float* left, float* right, int length) {
 
     util::debug(log_tag + "autogain factor: " + std::to_string(autogain));
 
-    for (int n = 0; n < length; n++) {
-        left[n] *= autogain;
-        right[n] *= autogain;
+    for (auto& k : kernels) {
+        for (auto& v : k) {
+            v *= autogain;
+        }
     }
 }
 
@@ -61,124 +72,342 @@ void ms_stereo(float width, float* left, float* right, int length) {
     }
 }
 
-bool read_file(_GstPeconvolver* peconvolver) {
-    if (peconvolver->kernel_path == nullptr) {
+/* The width is applied to the outputs of each input channel. It is the last
+   step so that the cached kernels can be used with any width
+*/
+void set_width(std::vector<float*>& kernels,
+               const int& n_frames,
+               const uint& ir_width) {
+    for (uint n = 0; n + 1 < kernels.size(); n += 2) {
+        ms_stereo(ir_width, kernels[n], kernels[n + 1], n_frames);
+    }
+}
+
+/* Optional steps applied to the kernels after they are read. Both reduce the
+   number of frames that have to be convolved
+*/
+struct Preprocess {
+    bool trim_tail = false;
+    float trim_threshold = -60.0f;  // decibels below the total energy
+    bool minimum_phase = false;
+
+    // used to tell apart cached kernels prepared with different options
+    std::string to_string() const {
+        std::ostringstream s;
+
+        s << ((trim_tail) ? "t" + std::to_string(trim_threshold) : "")
+          << ((minimum_phase) ? "m" : "");
+
+        return s.str();
+    }
+};
+
+/* The energy decay curve is calculated through the backward integration of
+   the squared kernels (Schroeder integral). The kernels are truncated where it
+   falls below the threshold and a short half cosine fade is applied to the
+   new end.
+*/
+void trim_tail(std::vector<std::vector<float>>& kernels,
+               const int& rate,
+               const float& threshold) {
+    int n_frames = kernels[0].size();
+
+    std::vector<double> decay(n_frames);
+
+    double energy = 0.0;
+
+    for (int n = n_frames - 1; n >= 0; n--) {
+        for (auto& k : kernels) {
+            energy += k[n] * k[n];
+        }
+
+        decay[n] = energy;
+    }
+
+    if (energy == 0.0) {
+        return;
+    }
+
+    double limit = energy * std::pow(10.0, threshold / 10.0);
+
+    int length = n_frames;
+
+    while (length > 1 && decay[length - 1] < limit) {
+        length--;
+    }
+
+    int fade_length = std::min((int)(0.005f * rate), length / 2);
+
+    for (auto& k : kernels) {
+        k.resize(length);
+
+        for (int n = 0; n < fade_length; n++) {
+            float w = 0.5f * (1.0f + cosf(M_PI * (n + 1) / fade_length));
+
+            k[length - fade_length + n] *= w;
+        }
+    }
+
+    util::debug(log_tag + "irs tail trimmed from " + std::to_string(n_frames) +
+                " to " + std::to_string(length) + " frames");
+}
+
+/* Minimum phase version of the kernel through the folded real cepstrum. The
+   magnitude response is kept and the energy is moved to the beginning of the
+   kernel, what makes the tail trimming much more effective. The fft size is
+   4 times the kernel size to reduce cepstral aliasing.
+*/
+void minimum_phase(std::vector<float>& kernel) {
+    int n_frames = kernel.size();
+    int nfft = gst_fft_next_fast_length(4 * n_frames);
+    int nbins = nfft / 2 + 1;
+
+    GstFFTF32* fft = gst_fft_f32_new(nfft, false);
+    GstFFTF32* ifft = gst_fft_f32_new(nfft, true);
+
+    std::vector<float> timedata(nfft, 0.0f);
+    std::vector<GstFFTF32Complex> freqdata(nbins);
+
+    std::copy(kernel.begin(), kernel.end(), timedata.begin());
+
+    gst_fft_f32_fft(fft, timedata.data(), freqdata.data());
+
+    // log magnitude with a -120 dB floor relative to the peak
+
+    float peak = 0.0f;
+
+    for (auto& v : freqdata) {
+        v.r = std::sqrt(v.r * v.r + v.i * v.i);
+        v.i = 0.0f;
+
+        peak = std::max(peak, v.r);
+    }
+
+    if (peak == 0.0f) {
+        gst_fft_f32_free(fft);
+        gst_fft_f32_free(ifft);
+
+        return;
+    }
+
+    for (auto& v : freqdata) {
+        v.r = std::log(std::max(v.r, 1e-6f * peak));
+    }
+
+    // real cepstrum. The gstreamer inverse fft is not normalized
+
+    gst_fft_f32_inverse_fft(ifft, freqdata.data(), timedata.data());
+
+    for (int n = 0; n < nfft; n++) {
+        float w = 0.0f;
+
+        if (n == 0 || n == nfft / 2) {
+            w = 1.0f;
+        } else if (n < nfft / 2) {
+            w = 2.0f;
+        }
+
+        timedata[n] *= w / nfft;
+    }
+
+    gst_fft_f32_fft(fft, timedata.data(), freqdata.data());
+
+    for (auto& v : freqdata) {
+        auto h = std::exp(std::complex<float>(v.r, v.i));
+
+        v.r = h.real();
+        v.i = h.imag();
+    }
+
+    gst_fft_f32_inverse_fft(ifft, freqdata.data(), timedata.data());
+
+    for (int n = 0; n < n_frames; n++) {
+        kernel[n] = timedata[n] / nfft;
+    }
+
+    gst_fft_f32_free(fft);
+    gst_fft_f32_free(ifft);
+}
+
+void preprocess(std::vector<std::vector<float>>& kernels,
+                const int& rate,
+                const Preprocess& options) {
+    if (options.minimum_phase) {
+        for (auto& k : kernels) {
+            minimum_phase(k);
+        }
+
+        util::debug(log_tag + "irs converted to minimum phase");
+    }
+
+    if (options.trim_tail) {
+        trim_tail(kernels, rate, options.trim_threshold);
+    }
+}
+
+/* The kernel is read into plain vectors instead of the element structure so
+   that a new convolver can be prepared in a background thread while the
+   current one is still processing audio.
+
+   Stereo files give the kernels [L, R]. True stereo files (4 channels) give
+   [LL, LR, RL, RR] where the first letter is the input channel and the second
+   one is the output channel.
+*/
+bool read_file(const std::string& path,
+               const int& rate,
+               std::vector<std::vector<float>>& kernels) {
+    if (path.empty()) {
         util::debug(log_tag + "irs file path is null");
 
         return false;
     }
 
-    SndfileHandle file = SndfileHandle(peconvolver->kernel_path);
+    SndfileHandle file = SndfileHandle(path);
 
     if (file.channels() == 0 || file.frames() == 0) {
         util::debug(log_tag + "irs file does not exists or it is empty: " +
-                    peconvolver->kernel_path);
+                    path);
 
         return false;
     }
 
-    util::debug(log_tag + "irs file: " + peconvolver->kernel_path);
+    util::debug(log_tag + "irs file: " + path);
     util::debug(log_tag + "irs rate: " + std::to_string(file.samplerate()) +
                 " Hz");
     util::debug(log_tag + "irs channels: " + std::to_string(file.channels()));
     util::debug(log_tag + "irs frames: " + std::to_string(file.frames()));
 
-    // for now only stereo irs files are supported
-
-    if (file.channels() == 2) {
-        bool resample = false;
-        float resample_ratio = 1.0f, *buffer, *kernel;
-        int total_frames_in, total_frames_out, frames_in, frames_out;
+    if (file.channels() == 2 || file.channels() == 4) {
+        int nchannels = file.channels();
+        int frames_in = file.frames();
+        bool resample = file.samplerate() != rate;
+        double resample_ratio = (double)rate / file.samplerate();
+        int frames_out = ceil(frames_in * resample_ratio);
 
-        frames_in = file.frames();
-        total_frames_in = file.channels() * frames_in;
+        /* The file is streamed in chunks and each chunk goes straight to
+           the planar kernels. Only the small interleaved chunk buffers are
+           allocated besides the kernels themselves.
+        */
 
-        buffer = new float[total_frames_in];
+        const int chunk_frames = 8192;
+        int chunk_frames_out = ceil(chunk_frames * resample_ratio) + 1;
 
-        file.readf(buffer, frames_in);
+        std::vector<float> chunk_in(nchannels * chunk_frames);
+        std::vector<float> chunk_out;
 
-        if (file.samplerate() != peconvolver->rate) {
-            resample = true;
+        kernels.resize(nchannels);
 
-            resample_ratio = (float)peconvolver->rate / file.samplerate();
+        // the resampler may give a few frames more than the estimate
 
-            frames_out = ceil(file.frames() * resample_ratio);
-            total_frames_out = file.channels() * frames_out;
-        } else {
-            frames_out = frames_in;
-            total_frames_out = file.channels() * frames_out;
+        for (auto& k : kernels) {
+            k.clear();
+            k.reserve(frames_out + chunk_frames_out);
         }
 
-        // allocate arrays
+        auto deinterleave = [&](const float* data, const int& n_frames) {
+            for (int c = 0; c < nchannels; c++) {
+                auto& k = kernels[c];
 
-        kernel = new float[total_frames_out];
-        peconvolver->kernel_L = new float[frames_out];
-        peconvolver->kernel_R = new float[frames_out];
-        peconvolver->kernel_n_frames = frames_out;
+                for (int n = 0; n < n_frames; n++) {
+                    k.push_back(data[nchannels * n + c]);
+                }
+            }
+        };
 
-        // resample if necessary
+        SRC_STATE* src_state = nullptr;
+        SRC_DATA src_data;
 
         if (resample) {
             util::debug(log_tag + "resampling irs to " +
-                        std::to_string(peconvolver->rate) + " Hz");
+                        std::to_string(rate) + " Hz");
+
+            int error = 0;
+
+            src_state = src_new(SRC_SINC_BEST_QUALITY, nchannels, &error);
+
+            if (src_state == nullptr) {
+                util::debug(log_tag + "libsamplerate error: " +
+                            src_strerror(error));
+
+                return false;
+            }
+
+            chunk_out.resize(nchannels * chunk_frames_out);
+
+            // Equal to output_sample_rate / input_sample_rate
+            src_data.src_ratio = resample_ratio;
+        } else {
+            util::debug(log_tag + "irs file does not need resampling");
+        }
+
+        bool end_of_input = false;
 
-            SRC_STATE* src_state =
-                src_new(SRC_SINC_BEST_QUALITY, file.channels(), nullptr);
+        while (!end_of_input) {
+            int n_read = file.readf(chunk_in.data(), chunk_frames);
 
-            SRC_DATA src_data;
+            end_of_input = n_read < chunk_frames;
 
-            /* code from
+            if (!resample) {
+                deinterleave(chunk_in.data(), n_read);
+
+                continue;
+            }
+
+            /* code based on
              * https://github.com/x42/convoLV2/blob/master/convolution.cc
+             * The converter may keep part of the chunk in its internal
+             * buffers. We call it until the chunk is consumed and, at the
+             * end of the file, until there is nothing left to flush.
              */
 
-            // The number of frames of data pointed to by data_in
-            src_data.input_frames = frames_in;
+            src_data.data_in = chunk_in.data();
+            src_data.input_frames = n_read;
+            src_data.end_of_input = (end_of_input) ? 1 : 0;
 
-            // A pointer to the input data samples
-            src_data.data_in = buffer;
+            do {
+                src_data.data_out = chunk_out.data();
+                src_data.output_frames = chunk_frames_out;
 
-            // Maximum number of frames pointer to by data_out
-            src_data.output_frames = frames_out;
+                int error = src_process(src_state, &src_data);
 
-            // A pointer to the output data samples
-            src_data.data_out = kernel;
+                if (error != 0) {
+                    util::debug(log_tag + "libsamplerate error: " +
+                                src_strerror(error));
 
-            // Equal to output_sample_rate / input_sample_rate
-            src_data.src_ratio = resample_ratio;
+                    src_delete(src_state);
 
-            // Equal to 0 if more input data is available and 1 otherwise
-            src_data.end_of_input = 1;
+                    return false;
+                }
 
-            src_process(src_state, &src_data);
+                deinterleave(chunk_out.data(), src_data.output_frames_gen);
 
+                src_data.data_in += nchannels * src_data.input_frames_used;
+                src_data.input_frames -= src_data.input_frames_used;
+            } while (src_data.input_frames > 0 ||
+                     (end_of_input && src_data.output_frames_gen > 0));
+        }
+
+        if (resample) {
             src_delete(src_state);
 
             util::debug(log_tag + "irs frames after resampling " +
-                        std::to_string(frames_out));
-        } else {
-            util::debug(log_tag + "irs file does not need resampling");
-
-            std::memcpy(kernel, buffer, total_frames_in * sizeof(float));
+                        std::to_string(kernels[0].size()));
         }
 
-        // deinterleave
-        for (int n = 0; n < frames_out; n++) {
-            peconvolver->kernel_L[n] = kernel[2 * n];
-            peconvolver->kernel_R[n] = kernel[2 * n + 1];
-        }
-
-        autogain(peconvolver->kernel_L, peconvolver->kernel_R, frames_out);
+        if (kernels[0].empty()) {
+            util::debug(log_tag + "could not read the irs file: " + path);
 
-        ms_stereo(peconvolver->ir_width, peconvolver->kernel_L,
-                  peconvolver->kernel_R, frames_out);
+            return false;
+        }
 
-        delete[] buffer;
-        delete[] kernel;
+        autogain(kernels);
 
         return true;
     } else {
-        util::debug(log_tag + "only stereo impulse responses are supported." +
-                    "The impulse file was not loaded!");
+        util::debug(log_tag +
+                    "only stereo and true stereo (4 channels) impulse "
+                    "responses are supported. The impulse file was not "
+                    "loaded!");
 
         return false;
     }
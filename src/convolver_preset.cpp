@@ -19,6 +19,18 @@ void ConvolverPreset::save(boost::property_tree::ptree& root,
            settings->get_string("kernel-path"));
 
   root.put(section + ".convolver.ir-width", settings->get_int("ir-width"));
+
+  root.put(section + ".convolver.auto-tune",
+           settings->get_boolean("auto-tune"));
+
+  root.put(section + ".convolver.trim-tail",
+           settings->get_boolean("trim-tail"));
+
+  root.put(section + ".convolver.trim-threshold",
+           settings->get_double("trim-threshold"));
+
+  root.put(section + ".convolver.minimum-phase",
+           settings->get_boolean("minimum-phase"));
 }
 
 void ConvolverPreset::load(boost::property_tree::ptree& root,
@@ -36,6 +48,18 @@ void ConvolverPreset::load(boost::property_tree::ptree& root,
                     section + ".convolver.kernel-path");
 
   update_key<int>(root, settings, "ir-width", section + ".convolver.ir-width");
+
+  update_key<bool>(root, settings, "auto-tune",
+                   section + ".convolver.auto-tune");
+
+  update_key<bool>(root, settings, "trim-tail",
+                   section + ".convolver.trim-tail");
+
+  update_key<double>(root, settings, "trim-threshold",
+                     section + ".convolver.trim-threshold");
+
+  update_key<bool>(root, settings, "minimum-phase",
+                   section + ".convolver.minimum-phase");
 }
 
 void ConvolverPreset::write(PresetType preset_type,
@@ -27,11 +27,16 @@ ConvolverUi::ConvolverUi(BaseObjectType* cobject,
   builder->get_widget("sampling_rate", label_sampling_rate);
   builder->get_widget("samples", label_samples);
   builder->get_widget("duration", label_duration);
+  builder->get_widget("convolved", label_convolved);
   builder->get_widget("show_fft", show_fft);
+  builder->get_widget("auto_tune", auto_tune);
+  builder->get_widget("trim_tail", trim_tail);
+  builder->get_widget("minimum_phase", minimum_phase);
 
   get_object(builder, "input_gain", input_gain);
   get_object(builder, "output_gain", output_gain);
   get_object(builder, "ir_width", ir_width);
+  get_object(builder, "trim_threshold", trim_threshold);
 
   font.set_family("Monospace");
   font.set_weight(Pango::WEIGHT_BOLD);
@@ -83,6 +88,10 @@ ConvolverUi::ConvolverUi(BaseObjectType* cobject,
   settings->bind("input-gain", input_gain.get(), "value", flag);
   settings->bind("output-gain", output_gain.get(), "value", flag);
   settings->bind("ir-width", ir_width.get(), "value", flag);
+  settings->bind("auto-tune", auto_tune, "active", flag);
+  settings->bind("trim-tail", trim_tail, "active", flag);
+  settings->bind("trim-threshold", trim_threshold.get(), "value", flag);
+  settings->bind("minimum-phase", minimum_phase, "active", flag);
 
   settings->set_boolean("post-messages", true);
 
@@ -160,8 +169,9 @@ void ConvolverUi::import_irs_file(const std::string& file_path) {
   if (boost::filesystem::is_regular_file(p)) {
     SndfileHandle file = SndfileHandle(file_path);
 
-    if (file.channels() != 2 || file.frames() == 0) {
-      util::warning(log_tag + " Only stereo impulse files are supported!");
+    if ((file.channels() != 2 && file.channels() != 4) || file.frames() == 0) {
+      util::warning(log_tag + " Only stereo and true stereo impulse files " +
+                    "are supported!");
       util::warning(log_tag + file_path + " loading failed");
 
       return;
@@ -302,7 +312,7 @@ void ConvolverUi::get_irs_info() {
 
   SndfileHandle file = SndfileHandle(path);
 
-  if (file.channels() != 2 || file.frames() == 0) {
+  if ((file.channels() != 2 && file.channels() != 4) || file.frames() == 0) {
     // warning user that there is a problem
 
     Glib::signal_idle().connect_once([=]() {
@@ -317,6 +327,7 @@ void ConvolverUi::get_irs_info() {
     return;
   }
 
+  uint nchannels = file.channels();
   uint frames_in = file.frames();
   uint total_frames_in = file.channels() * frames_in;
   uint rate = file.samplerate();
@@ -341,7 +352,9 @@ void ConvolverUi::get_irs_info() {
 
   max_time = *std::max_element(time_axis.begin(), time_axis.end());
 
-  // deinterleaving channels and calculating each amplitude in decibel
+  /* deinterleaving channels and calculating each amplitude in decibel. For
+     true stereo files we plot the direct paths LL and RR
+  */
 
   left_mag.resize(frames_in);
   right_mag.resize(frames_in);
@@ -350,8 +363,9 @@ void ConvolverUi::get_irs_info() {
   right_mag.shrink_to_fit();
 
   for (uint n = 0; n < frames_in; n++) {
-    left_mag[n] = util::linear_to_db(kernel[2 * n]);
-    right_mag[n] = util::linear_to_db(kernel[2 * n + 1]);
+    left_mag[n] = util::linear_to_db(kernel[nchannels * n]);
+    right_mag[n] =
+        util::linear_to_db(kernel[nchannels * n + nchannels - 1]);
   }
 
   /*interpolating because we can not plot all the data in the irs file. It
@@ -419,6 +433,20 @@ void ConvolverUi::get_irs_info() {
   delete[] kernel;
 }
 
+void ConvolverUi::on_new_kernel_frames(int original, int frames) {
+  std::ostringstream msg;
+
+  msg << frames;
+
+  if (original > 0 && frames < original) {
+    msg.precision(0);
+    msg << std::fixed << " (-" << 100.0f * (original - frames) / original
+        << " %)";
+  }
+
+  label_convolved->set_text(msg.str());
+}
+
 void ConvolverUi::get_irs_spectrum(const int& rate) {
   int nfft = left_mag.size();  // right_mag.size() should have the same value
 
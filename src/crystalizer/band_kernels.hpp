@@ -0,0 +1,135 @@
+#ifndef BAND_KERNELS_HPP
+#define BAND_KERNELS_HPP
+
+#include <sys/types.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/*
+  Inner loops of the crystalizer. The band buffers are planar and the two
+  samples before x[0] hold the end of the previous buffer. For each band we
+  compute
+
+  y[m] = x[m - 1] + k * (2 * x[m - 1] - x[m - 2] - x[m]), k = intensity / 2
+
+  and add it to the output sum in the same pass. A bypassed band is just a
+  band with k = 0. The best implementation for the cpu is chosen at runtime.
+  The sum buffer must be 64 bytes aligned.
+*/
+
+namespace bk {
+
+using EnhanceFunction = void (*)(const float* x,
+                                 float* sum,
+                                 const uint& n,
+                                 const float& k);
+
+void enhance_add_scalar(const float* x,
+                        float* sum,
+                        const uint& n,
+                        const float& k) {
+  const float* x1 = x - 1;
+  const float* x2 = x - 2;
+
+  for (uint m = 0; m < n; m++) {
+    sum[m] += x1[m] + k * (2.0f * x1[m] - x2[m] - x[m]);
+  }
+}
+
+#if defined(__x86_64__)
+
+void enhance_add_sse2(const float* x,
+                      float* sum,
+                      const uint& n,
+                      const float& k) {
+  __m128 vk = _mm_set1_ps(k);
+  __m128 two = _mm_set1_ps(2.0f);
+  uint m = 0;
+
+  for (; m + 4 <= n; m += 4) {
+    __m128 c = _mm_loadu_ps(x + m - 1);
+    __m128 d = _mm_sub_ps(_mm_mul_ps(two, c),
+                          _mm_add_ps(_mm_loadu_ps(x + m - 2),
+                                     _mm_loadu_ps(x + m)));
+
+    __m128 s = _mm_add_ps(_mm_load_ps(sum + m),
+                          _mm_add_ps(c, _mm_mul_ps(vk, d)));
+
+    _mm_store_ps(sum + m, s);
+  }
+
+  enhance_add_scalar(x + m, sum + m, n - m, k);
+}
+
+__attribute__((target("avx2"))) void enhance_add_avx2(const float* x,
+                                                      float* sum,
+                                                      const uint& n,
+                                                      const float& k) {
+  __m256 vk = _mm256_set1_ps(k);
+  __m256 two = _mm256_set1_ps(2.0f);
+  uint m = 0;
+
+  for (; m + 8 <= n; m += 8) {
+    __m256 c = _mm256_loadu_ps(x + m - 1);
+    __m256 d = _mm256_sub_ps(_mm256_mul_ps(two, c),
+                             _mm256_add_ps(_mm256_loadu_ps(x + m - 2),
+                                           _mm256_loadu_ps(x + m)));
+
+    __m256 s = _mm256_add_ps(_mm256_load_ps(sum + m),
+                             _mm256_add_ps(c, _mm256_mul_ps(vk, d)));
+
+    _mm256_store_ps(sum + m, s);
+  }
+
+  enhance_add_scalar(x + m, sum + m, n - m, k);
+}
+
+#elif defined(__ARM_NEON)
+
+void enhance_add_neon(const float* x,
+                      float* sum,
+                      const uint& n,
+                      const float& k) {
+  float32x4_t vk = vdupq_n_f32(k);
+  float32x4_t two = vdupq_n_f32(2.0f);
+  uint m = 0;
+
+  for (; m + 4 <= n; m += 4) {
+    float32x4_t c = vld1q_f32(x + m - 1);
+    float32x4_t d =
+        vsubq_f32(vmulq_f32(two, c),
+                  vaddq_f32(vld1q_f32(x + m - 2), vld1q_f32(x + m)));
+
+    float32x4_t s = vaddq_f32(vld1q_f32(sum + m), vmlaq_f32(c, vk, d));
+
+    vst1q_f32(sum + m, s);
+  }
+
+  enhance_add_scalar(x + m, sum + m, n - m, k);
+}
+
+#endif
+
+EnhanceFunction get_enhance_add() {
+#if defined(__x86_64__)
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx2")) {
+    return enhance_add_avx2;
+  }
+
+  return enhance_add_sse2;
+#elif defined(__ARM_NEON)
+  return enhance_add_neon;
+#else
+  return enhance_add_scalar;
+#endif
+}
+
+}  // namespace bk
+
+#endif
@@ -0,0 +1,188 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "band_kernels.hpp"
+#include "simd.hpp"
+
+/*
+  Enhancement and summation of the 13 crystalizer bands. The interleaved
+  version is the loop we had before the band data became planar. The planar
+  versions run enhance_add on each band and interleave the sums, like
+  gst_pecrystalizer_process does. Filtering is not included.
+*/
+
+namespace {
+
+const uint nbands = 13;
+const uint frames = 1024;
+const uint iterations = 5000;
+
+template <typename Function>
+void measure(const std::string& name, Function f) {
+  f();  // warm up
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (uint n = 0; n < iterations; n++) {
+    f();
+  }
+
+  auto end = std::chrono::steady_clock::now();
+
+  double us = std::chrono::duration<double, std::micro>(end - start).count() /
+              iterations;
+
+  std::cout << std::left << std::setw(20) << name << std::right << std::fixed
+            << std::setprecision(2) << std::setw(10) << us << " us"
+            << std::endl;
+}
+
+struct Interleaved {
+  std::vector<std::vector<float>> band_data, last_data;
+  std::vector<float> last_L, last_R, intensities;
+
+  Interleaved()
+      : band_data(nbands, std::vector<float>(2 * frames)),
+        last_data(nbands, std::vector<float>(2 * frames)),
+        last_L(nbands, 0.0f),
+        last_R(nbands, 0.0f),
+        intensities(nbands, 2.0f) {
+    for (uint n = 0; n < nbands; n++) {
+      for (uint m = 0; m < 2 * frames; m++) {
+        band_data[n][m] = ((m + n) % 11) * 0.01f;
+        last_data[n][m] = band_data[n][m];
+      }
+    }
+  }
+
+  void process(float* data) {
+    for (uint n = 0; n < nbands; n++) {
+      for (uint m = 0; m < frames; m++) {
+        float L = last_data[n][2 * m];
+        float R = last_data[n][2 * m + 1];
+
+        float v1_L = L + (L - last_L[n]) * intensities[n];
+        float v1_R = R + (R - last_R[n]) * intensities[n];
+        float v2_L, v2_R;
+
+        if (m < frames - 1) {
+          float L_upper = last_data[n][2 * (m + 1)];
+          float R_upper = last_data[n][2 * (m + 1) + 1];
+
+          v2_L = L + (L - L_upper) * intensities[n];
+          v2_R = R + (R - R_upper) * intensities[n];
+        } else {
+          v2_L = L + (L - band_data[n][0]) * intensities[n];
+          v2_R = R + (R - band_data[n][1]) * intensities[n];
+        }
+
+        last_data[n][2 * m] = 0.5f * (v1_L + v2_L);
+        last_data[n][2 * m + 1] = 0.5f * (v1_R + v2_R);
+
+        last_L[n] = L;
+        last_R[n] = R;
+      }
+    }
+
+    for (uint n = 0; n < 2 * frames; n++) {
+      data[n] = 0.0f;
+
+      for (uint m = 0; m < nbands; m++) {
+        data[n] += last_data[m][n];
+      }
+    }
+
+    for (uint n = 0; n < nbands; n++) {
+      memcpy(last_data[n].data(), band_data[n].data(),
+             2 * frames * sizeof(float));
+    }
+  }
+};
+
+struct Planar {
+  bk::EnhanceFunction enhance_add;
+  float* buffer;
+  float* sum_L;
+  float* sum_R;
+  std::vector<float*> bands;
+
+  // each band keeps 16 floats before its data for the history samples
+
+  explicit Planar(bk::EnhanceFunction f) : enhance_add(f) {
+    uint stride = frames + 16;
+
+    buffer = static_cast<float*>(
+        aligned_alloc(64, (2 * nbands * stride + 2 * frames) * sizeof(float)));
+
+    for (uint n = 0; n < 2 * nbands; n++) {
+      bands.push_back(buffer + n * stride + 16);
+
+      for (uint m = 0; m < frames; m++) {
+        bands[n][m] = ((m + n) % 11) * 0.01f;
+      }
+    }
+
+    sum_L = buffer + 2 * nbands * stride;
+    sum_R = sum_L + frames;
+  }
+
+  ~Planar() { free(buffer); }
+
+  void process(float* data) {
+    memset(sum_L, 0, frames * sizeof(float));
+    memset(sum_R, 0, frames * sizeof(float));
+
+    for (uint n = 0; n < 2 * nbands; n++) {
+      float* x = bands[n];
+
+      enhance_add(x, (n % 2 == 0) ? sum_L : sum_R, frames, 1.0f);
+
+      float last = x[frames - 2];
+
+      x[-1] = x[frames - 1];
+      x[-2] = last;
+    }
+
+    dsp::interleave(sum_L, sum_R, data, frames);
+  }
+};
+
+}  // namespace
+
+int main() {
+  std::vector<float> data(2 * frames);
+
+  std::cout << nbands << " bands, " << frames << " stereo frames per call"
+            << std::endl;
+
+  Interleaved interleaved;
+
+  measure("interleaved", [&]() { interleaved.process(data.data()); });
+
+  Planar scalar(bk::enhance_add_scalar);
+
+  measure("planar scalar", [&]() { scalar.process(data.data()); });
+
+#if defined(__x86_64__)
+  Planar sse2(bk::enhance_add_sse2);
+
+  measure("planar sse2", [&]() { sse2.process(data.data()); });
+
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx2")) {
+    Planar avx2(bk::enhance_add_avx2);
+
+    measure("planar avx2", [&]() { avx2.process(data.data()); });
+  }
+#elif defined(__ARM_NEON)
+  Planar neon(bk::enhance_add_neon);
+
+  measure("planar neon", [&]() { neon.process(data.data()); });
+#endif
+
+  return 0;
+}
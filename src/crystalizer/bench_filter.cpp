@@ -0,0 +1,213 @@
+#include <dirent.h>
+#include <zita-convolver.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "simd.hpp"
+
+/*
+  Filter bank of the crystalizer before and after it used a single zita
+  instance. Before there were 13 Convproc with 2 inputs and 2 outputs and
+  the input was copied for each one of them. Now there is one Convproc with
+  2 inputs and 26 outputs. The kernels have the size the crystalizer uses at
+  48 kHz. SCHED_OTHER is used so no realtime privileges are needed.
+*/
+
+namespace {
+
+const uint nbands = 13;
+const int frames = 1024;
+const int kernel_size = 1921;  // 100 Hz transition band at 48 kHz
+const uint iterations = 2000;
+
+// number of threads of this process
+
+int count_threads() {
+  int count = 0;
+  DIR* dir = opendir("/proc/self/task");
+
+  if (dir == nullptr) {
+    return -1;
+  }
+
+  while (auto entry = readdir(dir)) {
+    if (entry->d_name[0] != '.') {
+      count++;
+    }
+  }
+
+  closedir(dir);
+
+  return count;
+}
+
+std::vector<float> make_kernel(const uint& band) {
+  std::vector<float> kernel(kernel_size);
+  float fc = 0.01f * (band + 1);
+
+  for (int n = 0; n < kernel_size; n++) {
+    float x = n - (kernel_size - 1) / 2;
+    float w = 0.42f - 0.5f * cosf(2.0f * M_PI * n / (kernel_size - 1)) +
+              0.08f * cosf(4.0f * M_PI * n / (kernel_size - 1));
+
+    kernel[n] = (x == 0.0f) ? 2.0f * fc
+                            : sinf(2.0f * M_PI * fc * x) / (M_PI * x);
+    kernel[n] *= w;
+  }
+
+  return kernel;
+}
+
+Convproc* create_engine(const std::vector<std::vector<float>>& kernels) {
+  auto conv = new Convproc();
+  int nout = 2 * kernels.size();
+  int ret;
+
+  conv->set_options(Convproc::OPT_VECTOR_MODE);
+
+#if ZITA_CONVOLVER_MAJOR_VERSION == 3
+  conv->set_density(0.0f);
+
+  ret = conv->configure(2, nout, kernel_size, frames, frames,
+                        Convproc::MAXPART);
+#endif
+
+#if ZITA_CONVOLVER_MAJOR_VERSION == 4
+  ret = conv->configure(2, nout, kernel_size, frames, frames,
+                        Convproc::MAXPART, 0.0f);
+#endif
+
+  for (uint n = 0; n < kernels.size() && ret == 0; n++) {
+    for (int c = 0; c < 2 && ret == 0; c++) {
+      ret = conv->impdata_create(c, 2 * n + c, 1,
+                                 const_cast<float*>(kernels[n].data()), 0,
+                                 kernel_size);
+    }
+  }
+
+  if (ret == 0) {
+    ret = conv->start_process(0, SCHED_OTHER);
+  }
+
+  if (ret != 0) {
+    std::cerr << "can't initialise zita-convolver engine: " << ret
+              << std::endl;
+
+    exit(1);
+  }
+
+  return conv;
+}
+
+void destroy_engine(Convproc* conv) {
+  conv->stop_process();
+  conv->cleanup();
+
+  delete conv;
+}
+
+template <typename Function>
+void measure(const std::string& name, Function f) {
+  f();  // warm up
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (uint n = 0; n < iterations; n++) {
+    f();
+  }
+
+  auto end = std::chrono::steady_clock::now();
+
+  double us = std::chrono::duration<double, std::micro>(end - start).count() /
+              iterations;
+
+  std::cout << std::left << std::setw(20) << name << std::right << std::fixed
+            << std::setprecision(1) << std::setw(10) << us << " us"
+            << std::endl;
+}
+
+}  // namespace
+
+int main() {
+  std::vector<float> data(2 * frames);
+  std::vector<std::vector<float>> kernels;
+  std::vector<std::vector<float>> band_data(nbands,
+                                            std::vector<float>(2 * frames));
+
+  for (uint n = 0; n < nbands; n++) {
+    kernels.push_back(make_kernel(n));
+  }
+
+  for (uint n = 0; n < data.size(); n++) {
+    data[n] = (n % 7) * 0.1f - 0.3f;
+  }
+
+  std::cout << nbands << " bands, " << frames << " stereo frames per call"
+            << std::endl;
+
+  // one engine per band
+
+  {
+    int threads = count_threads();
+    std::vector<Convproc*> engines;
+
+    for (uint n = 0; n < nbands; n++) {
+      engines.push_back(create_engine({kernels[n]}));
+    }
+
+    std::cout << "13 engines: " << count_threads() - threads
+              << " new threads" << std::endl;
+
+    measure("13 engines", [&]() {
+      for (uint n = 0; n < nbands; n++) {
+        float* band = band_data[n].data();
+
+        memcpy(band, data.data(), data.size() * sizeof(float));
+
+        dsp::deinterleave(band, engines[n]->inpdata(0),
+                          engines[n]->inpdata(1), frames);
+
+        engines[n]->process(true);
+
+        dsp::interleave(engines[n]->outdata(0), engines[n]->outdata(1), band,
+                        frames);
+      }
+    });
+
+    for (auto& conv : engines) {
+      destroy_engine(conv);
+    }
+  }
+
+  // a single engine with two outputs per band
+
+  {
+    int threads = count_threads();
+    auto conv = create_engine(kernels);
+
+    std::cout << "1 engine: " << count_threads() - threads << " new threads"
+              << std::endl;
+
+    measure("1 engine", [&]() {
+      dsp::deinterleave(data.data(), conv->inpdata(0), conv->inpdata(1),
+                        frames);
+
+      conv->process(true);
+
+      for (uint n = 0; n < nbands; n++) {
+        std::copy_n(conv->outdata(2 * n), frames, band_data[n].data());
+        std::copy_n(conv->outdata(2 * n + 1), frames,
+                    band_data[n].data() + frames);
+      }
+    });
+
+    destroy_engine(conv);
+  }
+
+  return 0;
+}
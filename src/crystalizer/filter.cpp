@@ -1,6 +1,8 @@
 #include "filter.hpp"
 #include <boost/math/constants/constants.hpp>
 #include <boost/math/special_functions/sinc.hpp>
+#include <algorithm>
+#include "simd.hpp"
 
 #define CONVPROC_SCHEDULER_PRIORITY 0
 #define CONVPROC_SCHEDULER_CLASS SCHED_FIFO
@@ -8,6 +10,11 @@
 
 const float PI = boost::math::constants::pi<float>();
 
+enum { LOWPASS_KERNEL, HIGHPASS_KERNEL, BANDPASS_KERNEL };
+
+std::map<Filter::KernelKey, std::vector<float>> Filter::kernel_cache;
+std::mutex Filter::kernel_cache_mutex;
+
 Filter::Filter(const std::string& tag) : log_tag(tag) {}
 
 Filter::~Filter() {
@@ -16,24 +23,19 @@ Filter::~Filter() {
   finish();
 }
 
-void Filter::create_lowpass_kernel(const float& rate,
-                                   const float& cutoff,
-                                   const float& transition_band) {
+std::vector<float> Filter::create_lowpass_kernel(
+    const float& rate,
+    const float& cutoff,
+    const float& transition_band) {
   float b = transition_band / rate;
 
-  kernel_size = std::ceil(4.0f / b);
+  int kernel_size = std::ceil(4.0f / b);
 
   kernel_size = (kernel_size % 2 == 0) ? kernel_size + 1 : kernel_size;
 
   float fc = cutoff / rate;
 
-  if (kernel != nullptr) {
-    delete[] kernel;
-
-    kernel = nullptr;
-  }
-
-  kernel = new float[kernel_size];
+  std::vector<float> kernel(kernel_size);
 
   float sum = 0.0f;
 
@@ -52,94 +54,109 @@ void Filter::create_lowpass_kernel(const float& rate,
   for (int n = 0; n < kernel_size; n++) {
     kernel[n] /= sum;
   }
-}
-
-void Filter::create_highpass_kernel(const float& rate,
-                                    const float& cutoff,
-                                    const float& transition_band) {
-  create_lowpass_kernel(rate, cutoff, transition_band);
-
-  for (int n = 0; n < kernel_size; n++) {
-    kernel[n] *= -1;
-  }
 
-  kernel[(kernel_size - 1) / 2] += 1;
+  return kernel;
 }
 
-void Filter::create_bandpass_kernel(const float& rate,
-                                    const float& cutoff1,
-                                    const float& cutoff2,
-                                    const float& transition_band) {
-  create_lowpass_kernel(rate, cutoff2, transition_band);
-
-  float* lowpass_kernel = new float[kernel_size];
+std::vector<float> Filter::create_highpass_kernel(
+    const float& rate,
+    const float& cutoff,
+    const float& transition_band) {
+  auto kernel = create_lowpass_kernel(rate, cutoff, transition_band);
 
-  memcpy(lowpass_kernel, kernel, kernel_size * sizeof(float));
-
-  create_highpass_kernel(rate, cutoff1, transition_band);
+  for (auto& v : kernel) {
+    v *= -1;
+  }
 
-  float* highpass_kernel = new float[kernel_size];
+  kernel[(kernel.size() - 1) / 2] += 1;
 
-  memcpy(highpass_kernel, kernel, kernel_size * sizeof(float));
+  return kernel;
+}
 
-  delete[] kernel;
+/*
+  Closed form windowed sinc bandpass: the difference between two lowpass
+  kernels with the same size. All kernels have the same size and delay and
+  the sum of all the bands is a delayed unit impulse.
+*/
 
-  kernel_size = 2 * kernel_size - 1;
+std::vector<float> Filter::create_bandpass_kernel(
+    const float& rate,
+    const float& cutoff1,
+    const float& cutoff2,
+    const float& transition_band) {
+  auto kernel = create_lowpass_kernel(rate, cutoff2, transition_band);
 
-  kernel = new float[kernel_size];
+  auto lowpass_kernel = create_lowpass_kernel(rate, cutoff1, transition_band);
 
-  direct_conv(lowpass_kernel, highpass_kernel, kernel, kernel_size);
+  for (uint n = 0; n < kernel.size(); n++) {
+    kernel[n] -= lowpass_kernel[n];
+  }
 
-  delete[] lowpass_kernel;
-  delete[] highpass_kernel;
+  return kernel;
 }
 
-void Filter::direct_conv(float*& a, float*& b, float*& c, const int& N) {
-  int M = (N + 1) / 2;
+const std::vector<float>& Filter::get_kernel(const int& type,
+                                             const float& rate,
+                                             const float& cutoff1,
+                                             const float& cutoff2,
+                                             const float& transition_band) {
+  std::lock_guard<std::mutex> lock(kernel_cache_mutex);
 
-  for (int n = 0; n < N; n++) {
-    c[n] = 0.0f;
+  auto key = std::make_tuple(type, rate, cutoff1, cutoff2, transition_band);
 
-    for (int m = 0; m < M; m++) {
-      if (n > m && n - m < M) {
-        c[n] += a[n - m] * b[m];
-      }
-    }
+  auto it = kernel_cache.find(key);
+
+  if (it != kernel_cache.end()) {
+    return it->second;
   }
-}
 
-void Filter::create_lowpass(const int& nsamples,
-                            const float& rate,
-                            const float& cutoff,
-                            const float& transition_band) {
-  create_lowpass_kernel(rate, cutoff, transition_band);
+  std::vector<float> kernel;
+
+  switch (type) {
+    case LOWPASS_KERNEL:
+      kernel = create_lowpass_kernel(rate, cutoff1, transition_band);
+      break;
+    case HIGHPASS_KERNEL:
+      kernel = create_highpass_kernel(rate, cutoff1, transition_band);
+      break;
+    default:
+      kernel = create_bandpass_kernel(rate, cutoff1, cutoff2, transition_band);
+      break;
+  }
 
-  // util::debug(log_tag + " kernel size = " + std::to_string(kernel_size));
+  // std::map references stay valid when other kernels are inserted
 
-  init_zita(nsamples);
+  return kernel_cache.emplace(key, std::move(kernel)).first->second;
 }
 
-void Filter::create_highpass(const int& nsamples,
-                             const float& rate,
-                             const float& cutoff,
-                             const float& transition_band) {
-  create_highpass_kernel(rate, cutoff, transition_band);
+int Filter::get_delay(const float& rate, const float& transition_band) {
+  int kernel_size = std::ceil(4.0f * rate / transition_band);
 
-  // util::debug(log_tag + " kernel size = " + std::to_string(kernel_size));
+  kernel_size = (kernel_size % 2 == 0) ? kernel_size + 1 : kernel_size;
 
-  init_zita(nsamples);
+  return (kernel_size - 1) / 2;
 }
 
-void Filter::create_bandpass(const int& nsamples,
-                             const float& rate,
-                             const float& cutoff1,
-                             const float& cutoff2,
-                             const float& transition_band) {
-  create_bandpass_kernel(rate, cutoff1, cutoff2, transition_band);
+void Filter::add_lowpass(const float& rate,
+                         const float& cutoff,
+                         const float& transition_band) {
+  kernels.push_back(
+      get_kernel(LOWPASS_KERNEL, rate, cutoff, 0.0f, transition_band));
+}
 
-  // util::debug(log_tag + " kernel size = " + std::to_string(kernel_size));
+void Filter::add_highpass(const float& rate,
+                          const float& cutoff,
+                          const float& transition_band) {
+  kernels.push_back(
+      get_kernel(HIGHPASS_KERNEL, rate, cutoff, 0.0f, transition_band));
+}
 
-  init_zita(nsamples);
+void Filter::add_bandpass(const float& rate,
+                          const float& cutoff1,
+                          const float& cutoff2,
+                          const float& transition_band) {
+  kernels.push_back(
+      get_kernel(BANDPASS_KERNEL, rate, cutoff1, cutoff2, transition_band));
 }
 
 void Filter::init_zita(const int& num_samples) {
@@ -150,6 +167,13 @@ void Filter::init_zita(const int& num_samples) {
 
   nsamples = num_samples;
 
+  int n_bands = kernels.size();
+  int max_size = 0;
+
+  for (auto& k : kernels) {
+    max_size = std::max(max_size, (int)k.size());
+  }
+
   // depending on buffer and kernel size OPT_FFTW_MEASURE may make un crash
   // options |= Convproc::OPT_FFTW_MEASURE;
   options |= Convproc::OPT_VECTOR_MODE;
@@ -158,15 +182,20 @@ void Filter::init_zita(const int& num_samples) {
 
   conv->set_options(options);
 
+  /*
+    2 inputs and 2 outputs per band. Output 2 * n is the left channel of band
+    n and 2 * n + 1 its right channel.
+  */
+
 #if ZITA_CONVOLVER_MAJOR_VERSION == 3
   conv->set_density(density);
 
-  ret =
-      conv->configure(2, 2, kernel_size, nsamples, nsamples, Convproc::MAXPART);
+  ret = conv->configure(2, 2 * n_bands, max_size, nsamples, nsamples,
+                        Convproc::MAXPART);
 #endif
 
 #if ZITA_CONVOLVER_MAJOR_VERSION == 4
-  ret = conv->configure(2, 2, kernel_size, nsamples, nsamples,
+  ret = conv->configure(2, 2 * n_bands, max_size, nsamples, nsamples,
                         Convproc::MAXPART, density);
 #endif
 
@@ -176,55 +205,59 @@ void Filter::init_zita(const int& num_samples) {
                 std::to_string(ret));
   }
 
-  ret = conv->impdata_create(0, 0, 1, kernel, 0, kernel_size);
+  for (int n = 0; n < n_bands && !failed; n++) {
+    for (int c = 0; c < 2; c++) {
+      ret = conv->impdata_create(c, 2 * n + c, 1, kernels[n].data(), 0,
+                                 kernels[n].size());
 
-  if (ret != 0) {
-    failed = true;
-    util::debug(log_tag + "left impdata_create failed: " + std::to_string(ret));
+      if (ret != 0) {
+        failed = true;
+        util::debug(log_tag + "band " + std::to_string(n) +
+                    " impdata_create failed: " + std::to_string(ret));
+      }
+    }
   }
 
-  ret = conv->impdata_create(1, 1, 1, kernel, 0, kernel_size);
+  if (!failed) {
+    ret = conv->start_process(CONVPROC_SCHEDULER_PRIORITY,
+                              CONVPROC_SCHEDULER_CLASS);
 
-  if (ret != 0) {
-    failed = true;
-    util::debug(log_tag +
-                "right impdata_create failed: " + std::to_string(ret));
+    if (ret != 0) {
+      failed = true;
+      util::debug(log_tag + "start_process failed: " + std::to_string(ret));
+    }
   }
 
-  ret = conv->start_process(CONVPROC_SCHEDULER_PRIORITY,
-                            CONVPROC_SCHEDULER_CLASS);
+  ready = !failed;
+}
 
-  if (ret != 0) {
-    failed = true;
-    util::debug(log_tag + "start_process failed: " + std::to_string(ret));
-  }
+void Filter::process(float* data, const std::vector<float*>& band_data) {
+  if (ready) {
+    dsp::deinterleave(data, conv->inpdata(0), conv->inpdata(1), nsamples);
 
-  if (failed) {
-    ready = false;
-  } else {
-    ready = true;
+    int ret = conv->process(THREAD_SYNC_MODE);
+
+    if (ret != 0) {
+      util::debug(log_tag + "IR: process failed: " + std::to_string(ret));
+    }
+
+    // each band is copied to its planar L and R buffers
+    for (uint m = 0; m < kernels.size(); m++) {
+      std::copy_n(conv->outdata(2 * m), nsamples, band_data[2 * m]);
+      std::copy_n(conv->outdata(2 * m + 1), nsamples, band_data[2 * m + 1]);
+    }
   }
 }
 
-void Filter::process(float* data) {
+void Filter::feed(float* data) {
   if (ready) {
-    // deinterleave
-    for (int n = 0; n < nsamples; n++) {
-      conv->inpdata(0)[n] = data[2 * n];
-      conv->inpdata(1)[n] = data[2 * n + 1];
-    }
+    dsp::deinterleave(data, conv->inpdata(0), conv->inpdata(1), nsamples);
 
     int ret = conv->process(THREAD_SYNC_MODE);
 
     if (ret != 0) {
       util::debug(log_tag + "IR: process failed: " + std::to_string(ret));
     }
-
-    // interleave
-    for (int n = 0; n < nsamples; n++) {
-      data[2 * n] = conv->outdata(0)[n];
-      data[2 * n + 1] = conv->outdata(1)[n];
-    }
   }
 }
 
@@ -234,18 +267,14 @@ void Filter::finish() {
   if (conv != nullptr) {
     if (conv->state() != Convproc::ST_STOP) {
       conv->stop_process();
+    }
 
-      conv->cleanup();
+    conv->cleanup();
 
-      delete conv;
+    delete conv;
 
-      conv = nullptr;
-    }
+    conv = nullptr;
   }
 
-  if (kernel != nullptr) {
-    delete[] kernel;
-
-    kernel = nullptr;
-  }
+  kernels.clear();
 }
@@ -2,8 +2,18 @@
 #define FILTER_HPP
 
 #include <zita-convolver.h>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
 #include "util.hpp"
 
+/*
+  Bank of linear phase FIR filters sharing a single zita instance. Each band
+  is a pair of outputs (L and R) of the same Convproc. This way the input is
+  transformed only once no matter how many bands we have.
+*/
+
 class Filter {
  public:
   Filter(const std::string& tag);
@@ -12,50 +22,69 @@ class Filter {
 
   bool ready = false;
 
-  void create_lowpass(const int& nsamples,
-                      const float& rate,
-                      const float& cutoff,
-                      const float& transition_band);
+  void add_lowpass(const float& rate,
+                   const float& cutoff,
+                   const float& transition_band);
+
+  void add_highpass(const float& rate,
+                    const float& cutoff,
+                    const float& transition_band);
+
+  void add_bandpass(const float& rate,
+                    const float& cutoff1,
+                    const float& cutoff2,
+                    const float& transition_band);
+
+  void init_zita(const int& num_samples);
 
-  void create_highpass(const int& nsamples,
-                       const float& rate,
-                       const float& cutoff,
-                       const float& transition_band);
+  // band_data must have two planar buffers (L and R) for each band
+  void process(float* data, const std::vector<float*>& band_data);
 
-  void create_bandpass(const int& nsamples,
-                       const float& rate,
-                       const float& cutoff1,
-                       const float& cutoff2,
-                       const float& transition_band);
+  // runs the engine without reading its outputs. Used to fill its history
+  void feed(float* data);
 
-  void process(float* data);
+  // delay in samples added by the kernels designed for this transition band
+  static int get_delay(const float& rate, const float& transition_band);
 
   void finish();
 
  private:
   std::string log_tag;
 
-  int kernel_size, nsamples;
-  float* kernel = nullptr;
+  int nsamples;
+
+  std::vector<std::vector<float>> kernels;
 
   Convproc* conv = nullptr;
 
-  void create_lowpass_kernel(const float& rate,
-                             const float& cutoff,
-                             const float& transition_band);
+  std::vector<float> create_lowpass_kernel(const float& rate,
+                                           const float& cutoff,
+                                           const float& transition_band);
 
-  void create_highpass_kernel(const float& rate,
-                              const float& cutoff,
-                              const float& transition_band);
+  std::vector<float> create_highpass_kernel(const float& rate,
+                                            const float& cutoff,
+                                            const float& transition_band);
 
-  void create_bandpass_kernel(const float& rate,
-                              const float& cutoff1,
-                              const float& cutoff2,
-                              const float& transition_band);
+  std::vector<float> create_bandpass_kernel(const float& rate,
+                                            const float& cutoff1,
+                                            const float& cutoff2,
+                                            const float& transition_band);
 
-  void init_zita(const int& num_samples);
+  /*
+    Designed kernels are kept for the lifetime of the process. The key is
+    (kernel type, rate, cutoff1, cutoff2, transition band).
+  */
+
+  using KernelKey = std::tuple<int, float, float, float, float>;
+
+  static std::map<KernelKey, std::vector<float>> kernel_cache;
+  static std::mutex kernel_cache_mutex;
 
-  void direct_conv(float*& a, float*& b, float*& c, const int& N);
+  const std::vector<float>& get_kernel(const int& type,
+                                       const float& rate,
+                                       const float& cutoff1,
+                                       const float& cutoff2,
+                                       const float& transition_band);
 };
 
 #endif
@@ -13,10 +13,17 @@
  */
 
 #include "gstpecrystalizer.hpp"
+#include <fftw3.h>
 #include <gst/audio/gstaudiofilter.h>
 #include <gst/gst.h>
+#include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include "band_kernels.hpp"
 #include "config.h"
+#include "simd.hpp"
 
 GST_DEBUG_CATEGORY_STATIC(gst_pecrystalizer_debug_category);
 #define GST_CAT_DEFAULT gst_pecrystalizer_debug_category
@@ -41,10 +48,47 @@ static GstFlowReturn gst_pecrystalizer_transform_ip(GstBaseTransform* trans,
 
 static gboolean gst_pecrystalizer_stop(GstBaseTransform* base);
 
-static void gst_pecrystalizer_setup_filters(GstPecrystalizer* pecrystalizer);
+static void gst_pecrystalizer_request_filters(GstPecrystalizer* pecrystalizer);
+
+static PecrystalizerFilters* gst_pecrystalizer_create_filters(
+    const int& rate,
+    const uint& nsamples,
+    const std::array<bool, NBANDS>& mute,
+    const std::array<float, NBANDS - 1>& freqs);
+
+static void gst_pecrystalizer_destroy_filters(PecrystalizerFilters* filters);
+
+static void gst_pecrystalizer_builder(GstPecrystalizer* pecrystalizer);
+
+static void gst_pecrystalizer_pick_filters(GstPecrystalizer* pecrystalizer);
+
+static bool gst_pecrystalizer_primed(GstPecrystalizer* pecrystalizer,
+                                     PecrystalizerFilters* filters);
+
+static void gst_pecrystalizer_alloc_bands(GstPecrystalizer* pecrystalizer);
+
+static void gst_pecrystalizer_set_band_outputs(
+    GstPecrystalizer* pecrystalizer,
+    PecrystalizerFilters* filters);
+
+static void gst_pecrystalizer_save_history(
+    GstPecrystalizer* pecrystalizer,
+    std::array<float, 4 * NBANDS>& history);
+
+static void gst_pecrystalizer_restore_history(
+    GstPecrystalizer* pecrystalizer,
+    const std::array<float, 4 * NBANDS>& history);
 
 static void gst_pecrystalizer_process(GstPecrystalizer* pecrystalizer,
-                                      GstBuffer* buffer);
+                                      PecrystalizerFilters* filters,
+                                      float* data);
+
+static void gst_pecrystalizer_feed(GstPecrystalizer* pecrystalizer,
+                                   PecrystalizerFilters* filters,
+                                   float* data);
+
+static void gst_pecrystalizer_process_delay(GstPecrystalizer* pecrystalizer,
+                                            float* data);
 
 static gboolean gst_pecrystalizer_src_query(GstPad* pad,
                                             GstObject* parent,
@@ -52,8 +96,21 @@ static gboolean gst_pecrystalizer_src_query(GstPad* pad,
 
 static void gst_pecrystalizer_finish_filters(GstPecrystalizer* pecrystalizer);
 
+static bool gst_pecrystalizer_delay_only(GstPecrystalizer* pecrystalizer);
+
 static void gst_pecrystalizer_finalize(GObject* object);
 
+/*
+  All filters use the same transition band. This way they have the same size
+  and delay.
+*/
+
+const float transition_band = 100.0f;  // Hz
+
+// chosen at runtime for the cpu we are running on
+
+const bk::EnhanceFunction enhance_add = bk::get_enhance_add();
+
 enum {
   PROP_INTENSITY_BAND0 = 1,
   PROP_INTENSITY_BAND1,
@@ -201,9 +258,25 @@ static void gst_pecrystalizer_class_init(GstPecrystalizerClass* klass) {
 }
 
 static void gst_pecrystalizer_init(GstPecrystalizer* pecrystalizer) {
-  pecrystalizer->ready = false;
+  pecrystalizer->delay_only = false;
+  pecrystalizer->filtered = false;
+  pecrystalizer->delay_pos = 0;
+  pecrystalizer->filters = nullptr;
+  pecrystalizer->pending_filters = nullptr;
+  pecrystalizer->retiring_filters = nullptr;
+  pecrystalizer->next_filters = nullptr;
+  pecrystalizer->retired_filters = nullptr;
+  pecrystalizer->prime_frames = 0;
+  pecrystalizer->requested_nsamples = 0;
+  pecrystalizer->builder_quit = false;
+  pecrystalizer->build_requested = false;
+  pecrystalizer->generation = 0;
+  pecrystalizer->build_rate = 0;
+  pecrystalizer->build_nsamples = 0;
+  pecrystalizer->rate = 0;
   pecrystalizer->bpf = 0;
   pecrystalizer->nsamples = 0;
+  pecrystalizer->delay = 0;
 
   pecrystalizer->freqs[0] = 500.0f;
   pecrystalizer->freqs[1] = 1000.0f;
@@ -219,14 +292,11 @@ static void gst_pecrystalizer_init(GstPecrystalizer* pecrystalizer) {
   pecrystalizer->freqs[11] = 15000.0f;
 
   for (uint n = 0; n < NBANDS; n++) {
-    pecrystalizer->filters[n] =
-        new Filter("crystalizer band" + std::to_string(n));
-
     pecrystalizer->intensities[n] = 1.0f;
     pecrystalizer->mute[n] = false;
     pecrystalizer->bypass[n] = false;
-    pecrystalizer->last_L[n] = 0.0f;
-    pecrystalizer->last_R[n] = 0.0f;
+    pecrystalizer->requested_mute[n] = false;
+    pecrystalizer->build_mute[n] = false;
   }
 
   pecrystalizer->sinkpad =
@@ -239,6 +309,13 @@ static void gst_pecrystalizer_init(GstPecrystalizer* pecrystalizer) {
                              gst_pecrystalizer_src_query);
 
   gst_base_transform_set_in_place(GST_BASE_TRANSFORM(pecrystalizer), true);
+
+  // GObject does not run C++ constructors. The builder is destroyed in finalize
+
+  new (&pecrystalizer->builder_cond) std::condition_variable();
+
+  new (&pecrystalizer->builder)
+      std::thread(gst_pecrystalizer_builder, pecrystalizer);
 }
 
 void gst_pecrystalizer_set_property(GObject* object,
@@ -520,6 +597,23 @@ static gboolean gst_pecrystalizer_setup(GstAudioFilter* filter,
 
   gst_pecrystalizer_finish_filters(pecrystalizer);
 
+  // the filters delay plus the one sample lookahead of the crystalizer
+
+  pecrystalizer->delay =
+      Filter::get_delay(pecrystalizer->rate, transition_band) + 1;
+
+  pecrystalizer->delay_line.assign(2 * pecrystalizer->delay, 0.0f);
+  pecrystalizer->delay_pos = 0;
+  pecrystalizer->filtered = false;
+
+  // the kernels have 2 * delay - 1 taps
+
+  pecrystalizer->prime_frames = 2 * pecrystalizer->delay;
+
+  gst_element_post_message(
+      GST_ELEMENT_CAST(pecrystalizer),
+      gst_message_new_latency(GST_OBJECT_CAST(pecrystalizer)));
+
   return true;
 }
 
@@ -533,35 +627,153 @@ static GstFlowReturn gst_pecrystalizer_transform_ip(GstBaseTransform* trans,
 
   GstMapInfo map;
 
-  gst_buffer_map(buffer, &map, GST_MAP_READ);
+  gst_buffer_map(buffer, &map, GST_MAP_READWRITE);
 
   guint num_samples = map.size / pecrystalizer->bpf;
 
-  gst_buffer_unmap(buffer, &map);
+  if (pecrystalizer->nsamples != num_samples) {
+    pecrystalizer->nsamples = num_samples;
 
-  bool filters_ready = true;
+    gst_pecrystalizer_alloc_bands(pecrystalizer);
 
-  for (uint n = 0; n < NBANDS; n++) {
-    filters_ready = filters_ready && pecrystalizer->filters[n]->ready;
+    /*
+      The banks pointed to the old buffers. The current one is kept because
+      the size may come back to the one it was built for.
+    */
+
+    gst_pecrystalizer_set_band_outputs(pecrystalizer, pecrystalizer->filters);
+    gst_pecrystalizer_set_band_outputs(pecrystalizer,
+                                       pecrystalizer->pending_filters);
+  }
+
+  bool delay_only = gst_pecrystalizer_delay_only(pecrystalizer);
+
+  if (delay_only != pecrystalizer->delay_only) {
+    pecrystalizer->delay_only = delay_only;
+
+    if (delay_only) {
+      util::debug("crystalizer: all bands bypassed. Using a delay line");
+    }
+  }
+
+  /*
+    A new filter bank is requested when the buffer size changes or when a
+    band is muted or unmuted. Other bypass changes do not affect the filters.
+    While it is being built the current bank keeps running if it can handle
+    this buffer size. Otherwise the delay line is used.
+  */
+
+  if (!delay_only &&
+      (pecrystalizer->requested_nsamples != pecrystalizer->nsamples ||
+       pecrystalizer->requested_mute != pecrystalizer->mute)) {
+    gst_pecrystalizer_request_filters(pecrystalizer);
   }
 
-  if (filters_ready) {
-    if (pecrystalizer->nsamples == num_samples) {
-      gst_pecrystalizer_process(pecrystalizer, buffer);
+  gst_pecrystalizer_pick_filters(pecrystalizer);
+
+  float* data = (float*)map.data;
+  auto& delayed = pecrystalizer->delayed_data;
+  auto filters = pecrystalizer->filters;
+  auto pending = pecrystalizer->pending_filters;
+
+  std::copy_n(data, 2 * num_samples, delayed.begin());
+
+  gst_pecrystalizer_process_delay(pecrystalizer, delayed.data());
+
+  bool can_filter = filters != nullptr && filters->nsamples == num_samples;
+
+  /*
+    Switching between the filters and the delay line is done through a
+    crossfade over one buffer. The filters are not fed while the delay line
+    is used. So their history has to be filled again before they come back.
+  */
+
+  if (delay_only) {
+    if (can_filter && pecrystalizer->filtered) {
+      gst_pecrystalizer_process(pecrystalizer, filters, data);
+
+      dsp::crossfade(data, delayed.data(), num_samples);
+    }
+
+    std::copy(delayed.begin(), delayed.end(), data);
+
+    if (filters != nullptr) {
+      filters->fed = 0;
+    }
+
+    if (pending != nullptr) {
+      pending->fed = 0;
+    }
+
+    pecrystalizer->filtered = false;
+
+    gst_buffer_unmap(buffer, &map);
+
+    return GST_FLOW_OK;
+  }
+
+  if (pending != nullptr && gst_pecrystalizer_primed(pecrystalizer, pending) &&
+      pecrystalizer->retiring_filters == nullptr) {
+    /*
+      The new bank has a full history. Both banks process this buffer from
+      the same crystalizer state and the output crossfades between them. The
+      delay line stands in for the old bank when it can not be used.
+    */
+
+    auto& blend = pecrystalizer->blend_data;
+
+    std::copy_n(data, 2 * num_samples, blend.begin());
+
+    if (can_filter && pecrystalizer->filtered) {
+      std::array<float, 4 * NBANDS> history;
+
+      gst_pecrystalizer_save_history(pecrystalizer, history);
+
+      gst_pecrystalizer_process(pecrystalizer, filters, data);
+
+      gst_pecrystalizer_restore_history(pecrystalizer, history);
     } else {
-      gst_pecrystalizer_finish_filters(pecrystalizer);
+      std::copy(delayed.begin(), delayed.end(), data);
     }
+
+    gst_pecrystalizer_process(pecrystalizer, pending, blend.data());
+
+    dsp::crossfade(data, blend.data(), num_samples);
+
+    std::copy(blend.begin(), blend.end(), data);
+
+    pecrystalizer->retiring_filters = filters;
+    pecrystalizer->filters = pending;
+    pecrystalizer->pending_filters = nullptr;
+    pecrystalizer->filtered = true;
   } else {
-    pecrystalizer->nsamples = num_samples;
+    if (pending != nullptr) {
+      gst_pecrystalizer_feed(pecrystalizer, pending, data);
+    }
+
+    if (can_filter && gst_pecrystalizer_primed(pecrystalizer, filters)) {
+      gst_pecrystalizer_process(pecrystalizer, filters, data);
+
+      if (!pecrystalizer->filtered) {
+        dsp::crossfade(delayed.data(), data, num_samples);
+      }
+
+      pecrystalizer->filtered = true;
+    } else {
+      if (can_filter) {
+        gst_pecrystalizer_feed(pecrystalizer, filters, data);
+      } else if (filters != nullptr) {
+        filters->fed = 0;  // it is missing this buffer
+      }
 
-    gst_pecrystalizer_finish_filters(pecrystalizer);
-    gst_pecrystalizer_setup_filters(pecrystalizer);
+      std::copy(delayed.begin(), delayed.end(), data);
 
-    gst_element_post_message(
-        GST_ELEMENT_CAST(pecrystalizer),
-        gst_message_new_latency(GST_OBJECT_CAST(pecrystalizer)));
+      pecrystalizer->filtered = false;
+    }
   }
 
+  gst_buffer_unmap(buffer, &map);
+
   return GST_FLOW_OK;
 }
 
@@ -575,147 +787,390 @@ static gboolean gst_pecrystalizer_stop(GstBaseTransform* base) {
   return true;
 }
 
-static void gst_pecrystalizer_setup_filters(GstPecrystalizer* pecrystalizer) {
-  if (pecrystalizer->rate != 0) {
-    for (uint n = 0; n < NBANDS; n++) {
-      pecrystalizer->band_data[n].resize(2 * pecrystalizer->nsamples);
+/*
+  Must be called with the element mutex held. The settings are copied so that
+  the builder thread does not have to touch the element. If the builder holds
+  its lock the request is made again in the next buffer.
+*/
+
+static void gst_pecrystalizer_request_filters(
+    GstPecrystalizer* pecrystalizer) {
+  if (pecrystalizer->rate == 0 || pecrystalizer->nsamples == 0) {
+    return;
+  }
+
+  if (!pecrystalizer->lock_guard_next.try_lock()) {
+    return;
+  }
+
+  pecrystalizer->generation++;
+
+  pecrystalizer->build_requested = true;
+  pecrystalizer->build_rate = pecrystalizer->rate;
+  pecrystalizer->build_nsamples = pecrystalizer->nsamples;
+  pecrystalizer->build_mute = pecrystalizer->mute;
+
+  pecrystalizer->requested_nsamples = pecrystalizer->nsamples;
+  pecrystalizer->requested_mute = pecrystalizer->mute;
+
+  pecrystalizer->builder_cond.notify_one();
+
+  pecrystalizer->lock_guard_next.unlock();
+}
 
-      pecrystalizer->last_data[n].resize(2 * pecrystalizer->nsamples);
+/*
+  Creating filter banks and stopping zita threads may take a while. Both are
+  done in this thread, started with the element.
+*/
+
+static void gst_pecrystalizer_builder(GstPecrystalizer* pecrystalizer) {
+  std::unique_lock<std::mutex> lock(pecrystalizer->lock_guard_next);
+
+  while (true) {
+    pecrystalizer->builder_cond.wait(lock, [=]() {
+      return pecrystalizer->builder_quit || pecrystalizer->build_requested ||
+             pecrystalizer->retired_filters != nullptr;
+    });
+
+    bool quit = pecrystalizer->builder_quit;
+    bool build = pecrystalizer->build_requested && !quit;
+
+    auto retired = pecrystalizer->retired_filters;
+    uint generation = pecrystalizer->generation;
+    int rate = pecrystalizer->build_rate;
+    uint nsamples = pecrystalizer->build_nsamples;
+    auto mute = pecrystalizer->build_mute;
+    auto freqs = pecrystalizer->freqs;
+
+    pecrystalizer->retired_filters = nullptr;
+    pecrystalizer->build_requested = false;
+
+    lock.unlock();
+
+    if (retired != nullptr) {
+      gst_pecrystalizer_destroy_filters(retired);
     }
 
-    /*
-      Bandpass transition band has to be twice the value used for lowpass and
-      highpass. This way all filters will have the same delay.
-    */
+    PecrystalizerFilters* discarded = nullptr;
+
+    if (build) {
+      auto filters =
+          gst_pecrystalizer_create_filters(rate, nsamples, mute, freqs);
+
+      lock.lock();
+
+      if (generation == pecrystalizer->generation) {
+        discarded = pecrystalizer->next_filters;
 
-    float transition_band = 100.0f;  // Hz
-
-    for (uint n = 0; n < NBANDS; n++) {
-      if (n == 0) {
-        pecrystalizer->filters[0]->create_lowpass(
-            pecrystalizer->nsamples, pecrystalizer->rate,
-            pecrystalizer->freqs[0], transition_band);
-      } else if (n == pecrystalizer->filters.size() - 1) {
-        pecrystalizer->filters[n]->create_highpass(
-            pecrystalizer->nsamples, pecrystalizer->rate,
-            pecrystalizer->freqs.back(), transition_band);
+        pecrystalizer->next_filters = filters;
       } else {
-        pecrystalizer->filters[n]->create_bandpass(
-            pecrystalizer->nsamples, pecrystalizer->rate,
-            pecrystalizer->freqs[n - 1], pecrystalizer->freqs[n],
-            2.0f * transition_band);
+        // the settings changed while we were working. Another build is coming
+
+        discarded = filters;
       }
+
+      lock.unlock();
+    }
+
+    if (discarded != nullptr) {
+      gst_pecrystalizer_destroy_filters(discarded);
+    }
+
+    lock.lock();
+
+    if (quit) {
+      break;
     }
   }
 }
 
-static void gst_pecrystalizer_process(GstPecrystalizer* pecrystalizer,
-                                      GstBuffer* buffer) {
-  GstMapInfo map;
+static PecrystalizerFilters* gst_pecrystalizer_create_filters(
+    const int& rate,
+    const uint& nsamples,
+    const std::array<bool, NBANDS>& mute,
+    const std::array<float, NBANDS - 1>& freqs) {
+  auto filters = new PecrystalizerFilters();
 
-  gst_buffer_map(buffer, &map, GST_MAP_READWRITE);
-
-  float* data = (float*)map.data;
+  filters->nsamples = nsamples;
+  filters->mute = mute;
 
   for (uint n = 0; n < NBANDS; n++) {
-    memcpy(pecrystalizer->band_data[n].data(), data, map.size);
+    if (!mute[n]) {
+      filters->bands.push_back(n);
+    }
+  }
+
+  filters->band_outputs.resize(2 * filters->bands.size());
 
-    pecrystalizer->filters[n]->process(pecrystalizer->band_data[n].data());
+  if (filters->bands.empty()) {
+    return filters;  // all bands muted
   }
 
-  if (!pecrystalizer->ready) {
-    for (uint n = 0; n < NBANDS; n++) {
-      pecrystalizer->last_L[n] = pecrystalizer->band_data[n][0];
-      pecrystalizer->last_R[n] = pecrystalizer->band_data[n][1];
+  filters->filter = new Filter("crystalizer: ");
 
-      memcpy(pecrystalizer->last_data[n].data(),
-             pecrystalizer->band_data[n].data(), map.size);
+  for (auto& n : filters->bands) {
+    if (n == 0) {
+      filters->filter->add_lowpass(rate, freqs[0], transition_band);
+    } else if (n == NBANDS - 1) {
+      filters->filter->add_highpass(rate, freqs.back(), transition_band);
+    } else {
+      filters->filter->add_bandpass(rate, freqs[n - 1], freqs[n],
+                                    transition_band);
     }
+  }
 
-    pecrystalizer->ready = true;
+  filters->filter->init_zita(nsamples);
 
-    gst_buffer_unmap(buffer, &map);
+  if (!filters->filter->ready) {
+    gst_pecrystalizer_destroy_filters(filters);
 
-    gst_buffer_resize(buffer, 0, 0);
+    return nullptr;
+  }
+
+  return filters;
+}
+
+static void gst_pecrystalizer_destroy_filters(PecrystalizerFilters* filters) {
+  if (filters->filter != nullptr) {
+    delete filters->filter;
+  }
+
+  delete filters;
+}
+
+/*
+  The streaming thread never waits for the builder. If the lock is busy the
+  new filter bank is picked and the old one handed over in the next buffer.
+*/
+
+static void gst_pecrystalizer_pick_filters(GstPecrystalizer* pecrystalizer) {
+  bool picked = false;
+
+  if (pecrystalizer->lock_guard_next.try_lock()) {
+    if (pecrystalizer->retiring_filters != nullptr &&
+        pecrystalizer->retired_filters == nullptr) {
+      pecrystalizer->retired_filters = pecrystalizer->retiring_filters;
+      pecrystalizer->retiring_filters = nullptr;
+
+      pecrystalizer->builder_cond.notify_one();
+    }
+
+    if (pecrystalizer->pending_filters == nullptr &&
+        pecrystalizer->next_filters != nullptr) {
+      pecrystalizer->pending_filters = pecrystalizer->next_filters;
+      pecrystalizer->next_filters = nullptr;
+
+      picked = true;
+    }
+
+    pecrystalizer->lock_guard_next.unlock();
+  }
+
+  auto pending = pecrystalizer->pending_filters;
 
+  if (pending == nullptr) {
     return;
   }
 
-  /*This algorithm is based on the one from FFMPEG crystalizer plugin
-   *https://git.ffmpeg.org/gitweb/ffmpeg.git/blob_plain/HEAD:/libavfilter/af_crystalizer.c
-   */
+  if (pending->nsamples != pecrystalizer->nsamples) {
+    // built for a buffer size that is not used anymore
+
+    if (pecrystalizer->retiring_filters == nullptr) {
+      pecrystalizer->retiring_filters = pending;
+      pecrystalizer->pending_filters = nullptr;
+    }
+
+    return;
+  }
+
+  if (picked) {
+    pending->fed = 0;
+
+    gst_pecrystalizer_set_band_outputs(pecrystalizer, pending);
+  }
+}
 
+// true when the bank has seen enough input for its output to be valid
+
+static bool gst_pecrystalizer_primed(GstPecrystalizer* pecrystalizer,
+                                     PecrystalizerFilters* filters) {
+  return filters->filter == nullptr ||
+         filters->fed >= pecrystalizer->prime_frames;
+}
+
+// the filter bank writes each of its bands to their planar buffers
+
+static void gst_pecrystalizer_set_band_outputs(
+    GstPecrystalizer* pecrystalizer,
+    PecrystalizerFilters* filters) {
+  if (filters == nullptr) {
+    return;
+  }
+
+  for (uint m = 0; m < filters->bands.size(); m++) {
+    uint n = filters->bands[m];
+
+    filters->band_outputs[2 * m] = pecrystalizer->band_L[n];
+    filters->band_outputs[2 * m + 1] = pecrystalizer->band_R[n];
+  }
+}
+
+/*
+  The two samples kept before each band buffer are the crystalizer state.
+  They are restored when a second bank processes the same buffer.
+*/
+
+static void gst_pecrystalizer_save_history(
+    GstPecrystalizer* pecrystalizer,
+    std::array<float, 4 * NBANDS>& history) {
   for (uint n = 0; n < NBANDS; n++) {
-    if (!pecrystalizer->bypass[n]) {
-      for (uint m = 0; m < pecrystalizer->nsamples; m++) {
-        float v1_L = 0.0f, v1_R = 0.0f, v2_L = 0.0f, v2_R = 0.0f;
-
-        float L = pecrystalizer->last_data[n][2 * m];
-        float R = pecrystalizer->last_data[n][2 * m + 1];
-
-        // ffmpeg algorithm
-
-        v1_L =
-            L + (L - pecrystalizer->last_L[n]) * pecrystalizer->intensities[n];
-        v1_R =
-            R + (R - pecrystalizer->last_R[n]) * pecrystalizer->intensities[n];
-
-        /*
-         The modification below avoids time shifts in the signal and a few
-         undesirable distortions in the waveform. See the graph made by
-         /util/crystalizer.py. But there is a catch. In other to apply ffmpeg
-         algorithm in reverse order to a live stream we need information from
-         the future. In other words we need to know the first data point of the
-         next audio buffer! That is why we are delaying the output by 1 buffer.
-         What will add latency :-( It is life...
-        */
-
-        if (m < pecrystalizer->nsamples - 1) {
-          float L_upper = pecrystalizer->last_data[n][2 * (m + 1)];
-          float R_upper = pecrystalizer->last_data[n][2 * (m + 1) + 1];
-
-          v2_L = L + (L - L_upper) * pecrystalizer->intensities[n];
-          v2_R = R + (R - R_upper) * pecrystalizer->intensities[n];
-        } else {
-          float l = pecrystalizer->band_data[n][0];
-          float r = pecrystalizer->band_data[n][1];
-
-          v2_L = L + (L - l) * pecrystalizer->intensities[n];
-          v2_R = R + (R - r) * pecrystalizer->intensities[n];
-        }
+    history[4 * n] = pecrystalizer->band_L[n][-1];
+    history[4 * n + 1] = pecrystalizer->band_L[n][-2];
+    history[4 * n + 2] = pecrystalizer->band_R[n][-1];
+    history[4 * n + 3] = pecrystalizer->band_R[n][-2];
+  }
+}
 
-        pecrystalizer->last_data[n][2 * m] = 0.5f * (v1_L + v2_L);
-        pecrystalizer->last_data[n][2 * m + 1] = 0.5f * (v1_R + v2_R);
+static void gst_pecrystalizer_restore_history(
+    GstPecrystalizer* pecrystalizer,
+    const std::array<float, 4 * NBANDS>& history) {
+  for (uint n = 0; n < NBANDS; n++) {
+    pecrystalizer->band_L[n][-1] = history[4 * n];
+    pecrystalizer->band_L[n][-2] = history[4 * n + 1];
+    pecrystalizer->band_R[n][-1] = history[4 * n + 2];
+    pecrystalizer->band_R[n][-2] = history[4 * n + 3];
+  }
+}
 
-        pecrystalizer->last_L[n] = L;
-        pecrystalizer->last_R[n] = R;
-      }
-    } else {
-      pecrystalizer->last_L[n] =
-          pecrystalizer->last_data[n][2 * pecrystalizer->nsamples - 2];
-      pecrystalizer->last_R[n] =
-          pecrystalizer->last_data[n][2 * pecrystalizer->nsamples - 1];
-    }
+// the bank output is not used. It only fills its history
+
+static void gst_pecrystalizer_feed(GstPecrystalizer* pecrystalizer,
+                                   PecrystalizerFilters* filters,
+                                   float* data) {
+  if (filters->filter != nullptr) {
+    filters->filter->feed(data);
   }
 
-  // add bands
+  if (filters->fed < pecrystalizer->prime_frames) {
+    filters->fed += pecrystalizer->nsamples;
+  }
+}
+
+static void gst_pecrystalizer_process_delay(GstPecrystalizer* pecrystalizer,
+                                            float* data) {
+  float* delay_line = pecrystalizer->delay_line.data();
+  uint size = pecrystalizer->delay_line.size();
+
+  if (size == 0) {
+    return;
+  }
 
   for (uint n = 0; n < 2 * pecrystalizer->nsamples; n++) {
-    data[n] = 0.0f;
+    float v = delay_line[pecrystalizer->delay_pos];
 
-    for (uint m = 0; m < pecrystalizer->filters.size(); m++) {
-      if (!pecrystalizer->mute[m]) {
-        data[n] += pecrystalizer->last_data[m][n];
-      }
-    }
+    delay_line[pecrystalizer->delay_pos] = data[n];
+    data[n] = v;
+
+    pecrystalizer->delay_pos = (pecrystalizer->delay_pos + 1) % size;
   }
+}
+
+/*
+  One block holds the L and R buffers of every band followed by the sum
+  buffers. Each buffer starts 16 floats after a 64 bytes boundary so that the
+  two history samples fit before it without breaking the alignment.
+*/
+
+static void gst_pecrystalizer_alloc_bands(GstPecrystalizer* pecrystalizer) {
+  const uint pad = 16;  // 64 bytes
+
+  uint stride = pad + (pecrystalizer->nsamples + pad - 1) / pad * pad;
+
+  uint size = (2 * NBANDS + 2) * stride * sizeof(float);
+
+  free(pecrystalizer->band_buffer);
+
+  pecrystalizer->band_buffer = static_cast<float*>(aligned_alloc(64, size));
+
+  memset(pecrystalizer->band_buffer, 0, size);
+
+  float* p = pecrystalizer->band_buffer + pad;
 
   for (uint n = 0; n < NBANDS; n++) {
-    memcpy(pecrystalizer->last_data[n].data(),
-           pecrystalizer->band_data[n].data(), map.size);
+    pecrystalizer->band_L[n] = p;
+    pecrystalizer->band_R[n] = p + stride;
+
+    p += 2 * stride;
   }
 
-  gst_buffer_unmap(buffer, &map);
+  pecrystalizer->sum_L = p;
+  pecrystalizer->sum_R = p + stride;
+
+  pecrystalizer->delayed_data.resize(2 * pecrystalizer->nsamples);
+  pecrystalizer->blend_data.resize(2 * pecrystalizer->nsamples);
+}
+
+static void gst_pecrystalizer_process(GstPecrystalizer* pecrystalizer,
+                                      PecrystalizerFilters* filters,
+                                      float* data) {
+  uint nsamples = pecrystalizer->nsamples;
+
+  if (filters->filter != nullptr) {
+    filters->filter->process(data, filters->band_outputs);
+  }
+
+  if (filters->fed < pecrystalizer->prime_frames) {
+    filters->fed += nsamples;
+  }
+
+  memset(pecrystalizer->sum_L, 0, nsamples * sizeof(float));
+  memset(pecrystalizer->sum_R, 0, nsamples * sizeof(float));
+
+  /*This algorithm is based on the one from FFMPEG crystalizer plugin
+   *https://git.ffmpeg.org/gitweb/ffmpeg.git/blob_plain/HEAD:/libavfilter/af_crystalizer.c
+   */
+
+  for (uint n = 0; n < NBANDS; n++) {
+    /*
+      Bands muted after the current bank was built are ignored. Bands unmuted
+      after it was built will appear when the new bank is ready.
+    */
+
+    if (pecrystalizer->mute[n] || filters->mute[n]) {
+      continue;
+    }
+
+    /*
+     The modification below avoids time shifts in the signal and a few
+     undesirable distortions in the waveform. See the graph made by
+     /util/crystalizer.py. Applying ffmpeg algorithm in reverse order needs
+     the next data point. So the output is delayed by one sample. The average
+     of the two ffmpeg estimates is x[m - 1] + k * (2 * x[m - 1] - x[m - 2] -
+     x[m]) with k = intensity / 2. It is added to the sum in the same pass.
+    */
+
+    float k = (pecrystalizer->bypass[n]) ? 0.0f
+                                         : 0.5f * pecrystalizer->intensities[n];
+
+    std::array<float*, 2> bands = {pecrystalizer->band_L[n],
+                                   pecrystalizer->band_R[n]};
+    std::array<float*, 2> sums = {pecrystalizer->sum_L, pecrystalizer->sum_R};
+
+    for (uint c = 0; c < 2; c++) {
+      float* x = bands[c];
+
+      enhance_add(x, sums[c], nsamples, k);
+
+      // keeping the last two samples for the next buffer
+
+      float last = (nsamples > 1) ? x[nsamples - 2] : x[-1];
+
+      x[-1] = x[nsamples - 1];
+      x[-2] = last;
+    }
+  }
+
+  dsp::interleave(pecrystalizer->sum_L, pecrystalizer->sum_R, data, nsamples);
 }
 
 static gboolean gst_pecrystalizer_src_query(GstPad* pad,
@@ -739,7 +1194,7 @@ static gboolean gst_pecrystalizer_src_query(GstPad* pad,
           /* add our own latency */
 
           latency = gst_util_uint64_scale_round(
-              pecrystalizer->nsamples, GST_SECOND, pecrystalizer->rate);
+              pecrystalizer->delay, GST_SECOND, pecrystalizer->rate);
 
           // std::cout << "latency: " << latency << std::endl;
           // std::cout << "n: " << pecrystalizer->inbuf_n_samples
@@ -771,12 +1226,43 @@ static gboolean gst_pecrystalizer_src_query(GstPad* pad,
   return ret;
 }
 
+static bool gst_pecrystalizer_delay_only(GstPecrystalizer* pecrystalizer) {
+  auto& bypass = pecrystalizer->bypass;
+  auto& mute = pecrystalizer->mute;
+
+  return std::all_of(bypass.begin(), bypass.end(), [](bool b) { return b; }) &&
+         std::none_of(mute.begin(), mute.end(), [](bool m) { return m; });
+}
+
 static void gst_pecrystalizer_finish_filters(GstPecrystalizer* pecrystalizer) {
-  pecrystalizer->ready = false;
+  std::array<PecrystalizerFilters*, 4> banks;
+
+  {
+    std::lock_guard<std::mutex> lock(pecrystalizer->lock_guard_next);
+
+    // a build still running will discard its result
+
+    pecrystalizer->generation++;
+    pecrystalizer->build_requested = false;
 
-  for (uint m = 0; m < NBANDS; m++) {
-    pecrystalizer->filters[m]->finish();
+    banks = {pecrystalizer->filters, pecrystalizer->pending_filters,
+             pecrystalizer->retiring_filters, pecrystalizer->next_filters};
+
+    pecrystalizer->next_filters = nullptr;
+  }
+
+  for (auto& b : banks) {
+    if (b != nullptr) {
+      gst_pecrystalizer_destroy_filters(b);
+    }
   }
+
+  pecrystalizer->filters = nullptr;
+  pecrystalizer->pending_filters = nullptr;
+  pecrystalizer->retiring_filters = nullptr;
+
+  pecrystalizer->requested_nsamples = 0;
+  pecrystalizer->nsamples = 0;
 }
 
 void gst_pecrystalizer_finalize(GObject* object) {
@@ -788,12 +1274,29 @@ void gst_pecrystalizer_finalize(GObject* object) {
 
   gst_pecrystalizer_finish_filters(pecrystalizer);
 
-  /* clean up object here */
+  {
+    std::lock_guard<std::mutex> lock_next(pecrystalizer->lock_guard_next);
+
+    pecrystalizer->builder_quit = true;
+
+    pecrystalizer->builder_cond.notify_one();
+  }
+
+  pecrystalizer->builder.join();
+
+  pecrystalizer->builder.~thread();
+  pecrystalizer->builder_cond.~condition_variable();
+
+  free(pecrystalizer->band_buffer);
 
   G_OBJECT_CLASS(gst_pecrystalizer_parent_class)->finalize(object);
 }
 
 static gboolean plugin_init(GstPlugin* plugin) {
+  // the FFTW planner is shared with the convolver engines
+
+  fftwf_make_planner_thread_safe();
+
   /* FIXME Remember to set the rank if it's an element that is meant
      to be autoplugged by decodebin. */
   return gst_element_register(plugin, "pecrystalizer", GST_RANK_NONE,
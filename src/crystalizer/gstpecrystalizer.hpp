@@ -3,7 +3,11 @@
 
 #include <gst/audio/gstaudiofilter.h>
 #include <array>
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
+#include <thread>
+#include <vector>
 #include "filter.hpp"
 
 G_BEGIN_DECLS
@@ -24,6 +28,17 @@ typedef struct _GstPecrystalizerClass GstPecrystalizerClass;
 
 #define NBANDS 13
 
+/* a filter bank built for a buffer size and a mute mask */
+
+struct PecrystalizerFilters {
+  Filter* filter = nullptr;  // nullptr when all bands are muted
+  uint nsamples = 0;
+  std::array<bool, NBANDS> mute;
+  std::vector<uint> bands;          // band of each filter bank output
+  std::vector<float*> band_outputs;  // L and R buffers of each output
+  uint fed = 0;  // frames processed since the bank history was last valid
+};
+
 struct _GstPecrystalizer {
   GstAudioFilter base_pecrystalizer;
 
@@ -35,15 +50,70 @@ struct _GstPecrystalizer {
 
   /* < private > */
 
-  bool ready;
   int rate, bpf;  // sampling rate,  bytes per frame : channels * bps
   uint nsamples;
+  uint delay;  // latency in samples
+
+  /*
+    When every band is bypassed the filters do nothing but delaying the
+    signal and a delay line is used instead. The same delay line keeps the
+    audio flowing while a filter bank for a new buffer size is being built.
+    It is fed with every buffer so that it is always ready to take over.
+  */
+
+  bool delay_only;
+  bool filtered;  // the last buffer went through the filters
+
+  std::vector<float> delay_line;
+  uint delay_pos;
+
+  std::vector<float> delayed_data;  // output of the delay line
+  std::vector<float> blend_data;    // output of the incoming bank
+
+  /*
+    A new bank is fed in parallel with the running one until its history
+    covers a whole kernel. Only then the output crossfades to it.
+  */
+
+  PecrystalizerFilters* filters = nullptr;  // used by the streaming thread
+  PecrystalizerFilters* pending_filters = nullptr;  // filling its history
+  PecrystalizerFilters* retiring_filters = nullptr;  // for the builder
+
+  uint prime_frames;  // frames a bank needs before its output is valid
+
+  uint requested_nsamples;  // settings of the last filter bank requested
+  std::array<bool, NBANDS> requested_mute;
+
+  /*
+    The builder thread creates the filter banks and destroys the retired
+    ones. The streaming thread only exchanges pointers with it and never waits
+    for its lock.
+  */
+
+  std::thread builder;
+  std::condition_variable builder_cond;
+
+  bool builder_quit;
+  bool build_requested;
+  uint generation;  // incremented when a new bank is requested
+  int build_rate;
+  uint build_nsamples;
+  std::array<bool, NBANDS> build_mute;
+
+  PecrystalizerFilters* next_filters = nullptr;     // built in the background
+  PecrystalizerFilters* retired_filters = nullptr;  // to be destroyed
+
+  /*
+    Planar band buffers and the output sum, all 64 bytes aligned. The two
+    samples before band_L[n][0] and band_R[n][0] hold the end of the previous
+    buffer, as the crystalizer looks one sample ahead.
+  */
 
-  std::array<Filter*, NBANDS> filters;
-  std::array<std::vector<float>, NBANDS> band_data, last_data;
-  std::array<float, NBANDS> last_L, last_R;
+  float* band_buffer = nullptr;
+  std::array<float*, NBANDS> band_L, band_R;
+  float *sum_L, *sum_R;
 
-  std::mutex mutex;
+  std::mutex mutex, lock_guard_next;
 
   GstPad *srcpad = nullptr, *sinkpad = nullptr;
 };
@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "band_kernels.hpp"
+
+/*
+  Compares enhance_add of each implementation the cpu supports with the
+  scalar one for every size up to max_frames and a few intensities.
+*/
+
+namespace {
+
+const uint max_frames = 67;
+
+struct Kernel {
+  std::string name;
+  bk::EnhanceFunction f;
+};
+
+std::vector<Kernel> get_kernels() {
+  std::vector<Kernel> kernels;
+
+#if defined(__x86_64__)
+  kernels.push_back({"sse2", bk::enhance_add_sse2});
+
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx2")) {
+    kernels.push_back({"avx2", bk::enhance_add_avx2});
+  }
+#elif defined(__ARM_NEON)
+  kernels.push_back({"neon", bk::enhance_add_neon});
+#endif
+
+  return kernels;
+}
+
+}  // namespace
+
+int main() {
+  std::mt19937 generator(1234);
+  std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+  const std::vector<float> intensities = {0.0f, 0.5f, 2.0f};
+  int failures = 0;
+
+  // two history samples are stored before x[0]
+
+  std::vector<float> band(max_frames + 2);
+
+  float* x = band.data() + 2;
+  float* sum = static_cast<float*>(aligned_alloc(64, 128 * sizeof(float)));
+  float* reference =
+      static_cast<float*>(aligned_alloc(64, 128 * sizeof(float)));
+
+  auto kernels = get_kernels();
+
+  for (uint n = 1; n <= max_frames; n++) {
+    for (auto& v : band) {
+      v = distribution(generator);
+    }
+
+    for (auto& k : intensities) {
+      for (uint m = 0; m < n; m++) {
+        reference[m] = 0.1f * m;
+      }
+
+      bk::enhance_add_scalar(x, reference, n, k);
+
+      for (auto& kernel : kernels) {
+        for (uint m = 0; m < n; m++) {
+          sum[m] = 0.1f * m;
+        }
+
+        kernel.f(x, sum, n, k);
+
+        for (uint m = 0; m < n; m++) {
+          if (std::fabs(sum[m] - reference[m]) >
+              1e-5f * std::max(1.0f, std::fabs(reference[m]))) {
+            std::cerr << kernel.name << ": enhance_add differs from scalar for"
+                      << " n = " << n << " and k = " << k << " at " << m
+                      << ": " << sum[m] << " != " << reference[m] << std::endl;
+
+            failures++;
+
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  for (auto& kernel : kernels) {
+    std::cout << "tested " << kernel.name << std::endl;
+  }
+
+  free(sum);
+  free(reference);
+
+  return (failures == 0) ? 0 : 1;
+}
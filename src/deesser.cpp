@@ -11,6 +11,10 @@ void on_post_messages_changed(GSettings* settings, gchar* key, Deesser* l) {
     if (!l->compression_connection.connected()) {
       l->compression_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->deesser == nullptr) {
+              return true;
+            }
+
             float compression;
 
             g_object_get(l->deesser, "compression", &compression, nullptr);
@@ -25,6 +29,10 @@ void on_post_messages_changed(GSettings* settings, gchar* key, Deesser* l) {
     if (!l->detected_connection.connected()) {
       l->detected_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->deesser == nullptr) {
+              return true;
+            }
+
             float detected;
 
             g_object_get(l->deesser, "detected", &detected, nullptr);
@@ -45,44 +53,10 @@ void on_post_messages_changed(GSettings* settings, gchar* key, Deesser* l) {
 
 Deesser::Deesser(const std::string& tag, const std::string& schema)
     : PluginBase(tag, "deesser", schema) {
-  deesser =
-      gst_element_factory_make("calf-sourceforge-net-plugins-Deesser", nullptr);
-
-  if (is_installed(deesser)) {
-    auto in_level = gst_element_factory_make("level", "deesser_input_level");
-    auto out_level = gst_element_factory_make("level", "deesser_output_level");
-    auto audioconvert_in =
-        gst_element_factory_make("audioconvert", "deesser_audioconvert_in");
-    auto audioconvert_out =
-        gst_element_factory_make("audioconvert", "deesser_audioconvert_out");
-
-    gst_bin_add_many(GST_BIN(bin), in_level, audioconvert_in, deesser,
-                     audioconvert_out, out_level, nullptr);
-
-    gst_element_link_many(in_level, audioconvert_in, deesser, audioconvert_out,
-                          out_level, nullptr);
-
-    auto pad_sink = gst_element_get_static_pad(in_level, "sink");
-    auto pad_src = gst_element_get_static_pad(out_level, "src");
-
-    gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad_sink));
-    gst_element_add_pad(bin, gst_ghost_pad_new("src", pad_src));
-
-    gst_object_unref(GST_OBJECT(pad_sink));
-    gst_object_unref(GST_OBJECT(pad_src));
-
-    g_object_set(deesser, "bypass", false, nullptr);
-
-    bind_to_gsettings();
-
+  if (is_installed("calf-sourceforge-net-plugins-Deesser")) {
     g_signal_connect(settings, "changed::post-messages",
                      G_CALLBACK(on_post_messages_changed), this);
 
-    g_settings_bind(settings, "post-messages", in_level, "post-messages",
-                    G_SETTINGS_BIND_DEFAULT);
-    g_settings_bind(settings, "post-messages", out_level, "post-messages",
-                    G_SETTINGS_BIND_DEFAULT);
-
     // useless write just to force callback call
 
     auto enable = g_settings_get_boolean(settings, "state");
@@ -95,6 +69,33 @@ Deesser::~Deesser() {
   util::debug(log_tag + name + " destroyed");
 }
 
+void Deesser::create_bin() {
+  deesser =
+      gst_element_factory_make("calf-sourceforge-net-plugins-Deesser", nullptr);
+
+  auto in_level =
+      gst_element_factory_make("pegainmeter", "deesser_input_level");
+  auto out_level =
+      gst_element_factory_make("pegainmeter", "deesser_output_level");
+  auto audioconvert_in = make_converter(deesser, "sink");
+  auto audioconvert_out = make_converter(deesser, "src");
+
+  add_to_bin({in_level, audioconvert_in, deesser, audioconvert_out, out_level});
+
+  g_object_set(deesser, "bypass", false, nullptr);
+
+  bind_to_gsettings();
+
+  g_settings_bind(settings, "post-messages", in_level, "post-messages",
+                  G_SETTINGS_BIND_DEFAULT);
+  g_settings_bind(settings, "post-messages", out_level, "post-messages",
+                  G_SETTINGS_BIND_DEFAULT);
+}
+
+void Deesser::release_bin() {
+  deesser = nullptr;
+}
+
 void Deesser::bind_to_gsettings() {
   g_settings_bind(settings, "detection", deesser, "detection",
                   G_SETTINGS_BIND_DEFAULT);
@@ -0,0 +1,83 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "simd.hpp"
+
+/*
+  Time taken by each function of every implementation the cpu supports to
+  process a typical buffer.
+*/
+
+namespace {
+
+const uint frames = 1024;
+const uint iterations = 20000;
+
+template <typename Function>
+void measure(const std::string& impl, const std::string& func, Function f) {
+  f();  // warm up
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (uint n = 0; n < iterations; n++) {
+    f();
+  }
+
+  auto end = std::chrono::steady_clock::now();
+
+  double ns = std::chrono::duration<double, std::nano>(end - start).count() /
+              iterations;
+
+  std::cout << std::left << std::setw(8) << impl << std::setw(20) << func
+            << std::right << std::fixed << std::setprecision(1)
+            << std::setw(10) << ns << " ns" << std::endl;
+}
+
+}  // namespace
+
+int main() {
+  std::vector<float> data(2 * frames), out(2 * frames);
+  std::vector<float> L(frames), R(frames);
+  float peak_L, peak_R;
+  dsp::Meter meter;
+
+  for (uint n = 0; n < data.size(); n++) {
+    data[n] = (n % 7) * 0.1f - 0.3f;
+  }
+
+  std::cout << frames << " stereo frames per call" << std::endl;
+
+  for (auto& impl : dsp::get_implementations()) {
+    dsp::set_implementation(impl);
+
+    measure(impl, "deinterleave", [&]() {
+      dsp::deinterleave(data.data(), L.data(), R.data(), frames);
+    });
+
+    measure(impl, "interleave",
+            [&]() { dsp::interleave(L.data(), R.data(), out.data(), frames); });
+
+    measure(impl, "apply_gain",
+            [&]() { dsp::apply_gain(out.data(), frames, 0.999f); });
+
+    measure(impl, "apply_gain_ramp", [&]() {
+      dsp::apply_gain_ramp(out.data(), frames, 0.999f, 1.001f);
+    });
+
+    measure(impl, "mix",
+            [&]() { dsp::mix(data.data(), out.data(), frames, 0.5f); });
+
+    measure(impl, "crossfade",
+            [&]() { dsp::crossfade(data.data(), out.data(), frames); });
+
+    measure(impl, "peak",
+            [&]() { dsp::peak(data.data(), frames, peak_L, peak_R); });
+
+    measure(impl, "apply_gain_meter", [&]() {
+      dsp::apply_gain_meter(out.data(), frames, 0.999f, 1.001f, meter);
+    });
+  }
+
+  return 0;
+}
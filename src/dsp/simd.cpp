@@ -0,0 +1,694 @@
+#include "simd.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+/*
+  Interleaved stereo is handled as a plain array of 2 * n samples whenever
+  the operation is the same for both channels. The vector loops stop at the
+  last full vector and the scalar versions take care of the remaining frames.
+*/
+
+void deinterleave_scalar(const float* data,
+                         float* L,
+                         float* R,
+                         const uint& n) {
+  for (uint m = 0; m < n; m++) {
+    L[m] = data[2 * m];
+    R[m] = data[2 * m + 1];
+  }
+}
+
+void interleave_scalar(const float* L,
+                       const float* R,
+                       float* data,
+                       const uint& n) {
+  for (uint m = 0; m < n; m++) {
+    data[2 * m] = L[m];
+    data[2 * m + 1] = R[m];
+  }
+}
+
+void apply_gain_scalar(float* data, const uint& n, const float& gain) {
+  for (uint m = 0; m < 2 * n; m++) {
+    data[m] *= gain;
+  }
+}
+
+// offset is the index of the first frame. Used by the vector versions
+
+void apply_gain_ramp_scalar(float* data,
+                            const uint& n,
+                            const float& gain0,
+                            const float& gain1,
+                            const uint& offset = 0,
+                            const uint& total = 0) {
+  uint size = (total == 0) ? n : total;
+  float step = (gain1 - gain0) / size;
+
+  for (uint m = 0; m < n; m++) {
+    float g = gain0 + step * (offset + m + 1);
+
+    data[2 * m] *= g;
+    data[2 * m + 1] *= g;
+  }
+}
+
+void mix_scalar(const float* in, float* out, const uint& n, const float& gain) {
+  for (uint m = 0; m < 2 * n; m++) {
+    out[m] += gain * in[m];
+  }
+}
+
+void crossfade_scalar(const float* in,
+                      float* out,
+                      const uint& n,
+                      const uint& offset = 0,
+                      const uint& total = 0) {
+  uint size = (total == 0) ? n : total;
+
+  for (uint m = 0; m < n; m++) {
+    float w = (float)(offset + m + 1) / size;
+
+    out[2 * m] = in[2 * m] + w * (out[2 * m] - in[2 * m]);
+    out[2 * m + 1] = in[2 * m + 1] + w * (out[2 * m + 1] - in[2 * m + 1]);
+  }
+}
+
+void peak_scalar(const float* data,
+                 const uint& n,
+                 float& peak_L,
+                 float& peak_R) {
+  for (uint m = 0; m < n; m++) {
+    peak_L = std::max(peak_L, std::fabs(data[2 * m]));
+    peak_R = std::max(peak_R, std::fabs(data[2 * m + 1]));
+  }
+}
+
+void apply_gain_meter_scalar(float* data,
+                             const uint& n,
+                             const float& gain0,
+                             const float& gain1,
+                             dsp::Meter& meter,
+                             const uint& offset = 0,
+                             const uint& total = 0) {
+  uint size = (total == 0) ? n : total;
+  float step = (gain1 - gain0) / size;
+
+  for (uint m = 0; m < n; m++) {
+    float g = gain0 + step * (offset + m + 1);
+    float L = data[2 * m] * g;
+    float R = data[2 * m + 1] * g;
+
+    data[2 * m] = L;
+    data[2 * m + 1] = R;
+
+    meter.peak_L = std::max(meter.peak_L, std::fabs(L));
+    meter.peak_R = std::max(meter.peak_R, std::fabs(R));
+    meter.sum_L += L * L;
+    meter.sum_R += R * R;
+  }
+}
+
+#if defined(__x86_64__)
+
+void deinterleave_sse2(const float* data,
+                       float* L,
+                       float* R,
+                       const uint& n) {
+  uint m = 0;
+
+  for (; m + 4 <= n; m += 4) {
+    __m128 a = _mm_loadu_ps(data + 2 * m);
+    __m128 b = _mm_loadu_ps(data + 2 * m + 4);
+
+    _mm_storeu_ps(L + m, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(R + m, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+  }
+
+  deinterleave_scalar(data + 2 * m, L + m, R + m, n - m);
+}
+
+void interleave_sse2(const float* L,
+                     const float* R,
+                     float* data,
+                     const uint& n) {
+  uint m = 0;
+
+  for (; m + 4 <= n; m += 4) {
+    __m128 l = _mm_loadu_ps(L + m);
+    __m128 r = _mm_loadu_ps(R + m);
+
+    _mm_storeu_ps(data + 2 * m, _mm_unpacklo_ps(l, r));
+    _mm_storeu_ps(data + 2 * m + 4, _mm_unpackhi_ps(l, r));
+  }
+
+  interleave_scalar(L + m, R + m, data + 2 * m, n - m);
+}
+
+void apply_gain_sse2(float* data, const uint& n, const float& gain) {
+  __m128 g = _mm_set1_ps(gain);
+  uint m = 0;
+
+  for (; m + 2 <= n; m += 2) {
+    _mm_storeu_ps(data + 2 * m, _mm_mul_ps(g, _mm_loadu_ps(data + 2 * m)));
+  }
+
+  apply_gain_scalar(data + 2 * m, n - m, gain);
+}
+
+void apply_gain_ramp_sse2(float* data,
+                          const uint& n,
+                          const float& gain0,
+                          const float& gain1) {
+  float step = (gain1 - gain0) / n;
+
+  // each vector holds two frames: gains of frames m and m + 1
+
+  __m128 g = _mm_setr_ps(gain0 + step, gain0 + step, gain0 + 2.0f * step,
+                         gain0 + 2.0f * step);
+  __m128 dg = _mm_set1_ps(2.0f * step);
+  uint m = 0;
+
+  for (; m + 2 <= n; m += 2) {
+    _mm_storeu_ps(data + 2 * m, _mm_mul_ps(g, _mm_loadu_ps(data + 2 * m)));
+
+    g = _mm_add_ps(g, dg);
+  }
+
+  apply_gain_ramp_scalar(data + 2 * m, n - m, gain0, gain1, m, n);
+}
+
+void mix_sse2(const float* in, float* out, const uint& n, const float& gain) {
+  __m128 g = _mm_set1_ps(gain);
+  uint m = 0;
+
+  for (; m + 2 <= n; m += 2) {
+    __m128 v = _mm_mul_ps(g, _mm_loadu_ps(in + 2 * m));
+
+    _mm_storeu_ps(out + 2 * m, _mm_add_ps(_mm_loadu_ps(out + 2 * m), v));
+  }
+
+  mix_scalar(in + 2 * m, out + 2 * m, n - m, gain);
+}
+
+void crossfade_sse2(const float* in, float* out, const uint& n) {
+  float step = 1.0f / n;
+
+  __m128 w = _mm_setr_ps(step, step, 2.0f * step, 2.0f * step);
+  __m128 dw = _mm_set1_ps(2.0f * step);
+  uint m = 0;
+
+  for (; m + 2 <= n; m += 2) {
+    __m128 a = _mm_loadu_ps(in + 2 * m);
+    __m128 b = _mm_loadu_ps(out + 2 * m);
+
+    _mm_storeu_ps(out + 2 * m,
+                  _mm_add_ps(a, _mm_mul_ps(w, _mm_sub_ps(b, a))));
+
+    w = _mm_add_ps(w, dw);
+  }
+
+  crossfade_scalar(in + 2 * m, out + 2 * m, n - m, m, n);
+}
+
+void peak_sse2(const float* data,
+               const uint& n,
+               float& peak_L,
+               float& peak_R) {
+  __m128 sign = _mm_set1_ps(-0.0f);
+  __m128 p = _mm_setr_ps(peak_L, peak_R, peak_L, peak_R);
+  uint m = 0;
+
+  for (; m + 2 <= n; m += 2) {
+    p = _mm_max_ps(p, _mm_andnot_ps(sign, _mm_loadu_ps(data + 2 * m)));
+  }
+
+  alignas(16) float v[4];
+
+  _mm_store_ps(v, p);
+
+  peak_L = std::max(v[0], v[2]);
+  peak_R = std::max(v[1], v[3]);
+
+  peak_scalar(data + 2 * m, n - m, peak_L, peak_R);
+}
+
+void apply_gain_meter_sse2(float* data,
+                           const uint& n,
+                           const float& gain0,
+                           const float& gain1,
+                           dsp::Meter& meter) {
+  float step = (gain1 - gain0) / n;
+
+  __m128 g = _mm_setr_ps(gain0 + step, gain0 + step, gain0 + 2.0f * step,
+                         gain0 + 2.0f * step);
+  __m128 dg = _mm_set1_ps(2.0f * step);
+  __m128 sign = _mm_set1_ps(-0.0f);
+  __m128 p = _mm_setzero_ps();
+  __m128 s = _mm_setzero_ps();
+  uint m = 0;
+
+  for (; m + 2 <= n; m += 2) {
+    __m128 v = _mm_mul_ps(g, _mm_loadu_ps(data + 2 * m));
+
+    _mm_storeu_ps(data + 2 * m, v);
+
+    p = _mm_max_ps(p, _mm_andnot_ps(sign, v));
+    s = _mm_add_ps(s, _mm_mul_ps(v, v));
+
+    g = _mm_add_ps(g, dg);
+  }
+
+  alignas(16) float vp[4], vs[4];
+
+  _mm_store_ps(vp, p);
+  _mm_store_ps(vs, s);
+
+  meter.peak_L = std::max({meter.peak_L, vp[0], vp[2]});
+  meter.peak_R = std::max({meter.peak_R, vp[1], vp[3]});
+  meter.sum_L += vs[0] + vs[2];
+  meter.sum_R += vs[1] + vs[3];
+
+  apply_gain_meter_scalar(data + 2 * m, n - m, gain0, gain1, meter, m, n);
+}
+
+__attribute__((target("avx2"))) void deinterleave_avx2(const float* data,
+                                                       float* L,
+                                                       float* R,
+                                                       const uint& n) {
+  uint m = 0;
+
+  for (; m + 8 <= n; m += 8) {
+    __m256 a = _mm256_loadu_ps(data + 2 * m);
+    __m256 b = _mm256_loadu_ps(data + 2 * m + 8);
+
+    // even and odd samples come out with their 64 bits halves swapped
+
+    __m256 l = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    __m256 r = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+
+    l = _mm256_castpd_ps(
+        _mm256_permute4x64_pd(_mm256_castps_pd(l), _MM_SHUFFLE(3, 1, 2, 0)));
+    r = _mm256_castpd_ps(
+        _mm256_permute4x64_pd(_mm256_castps_pd(r), _MM_SHUFFLE(3, 1, 2, 0)));
+
+    _mm256_storeu_ps(L + m, l);
+    _mm256_storeu_ps(R + m, r);
+  }
+
+  deinterleave_sse2(data + 2 * m, L + m, R + m, n - m);
+}
+
+__attribute__((target("avx2"))) void interleave_avx2(const float* L,
+                                                     const float* R,
+                                                     float* data,
+                                                     const uint& n) {
+  uint m = 0;
+
+  for (; m + 8 <= n; m += 8) {
+    __m256 l = _mm256_loadu_ps(L + m);
+    __m256 r = _mm256_loadu_ps(R + m);
+
+    __m256 lo = _mm256_unpacklo_ps(l, r);
+    __m256 hi = _mm256_unpackhi_ps(l, r);
+
+    _mm256_storeu_ps(data + 2 * m, _mm256_permute2f128_ps(lo, hi, 0x20));
+    _mm256_storeu_ps(data + 2 * m + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+  }
+
+  interleave_sse2(L + m, R + m, data + 2 * m, n - m);
+}
+
+__attribute__((target("avx2"))) void apply_gain_avx2(float* data,
+                                                     const uint& n,
+                                                     const float& gain) {
+  __m256 g = _mm256_set1_ps(gain);
+  uint m = 0;
+
+  for (; m + 4 <= n; m += 4) {
+    _mm256_storeu_ps(data + 2 * m,
+                     _mm256_mul_ps(g, _mm256_loadu_ps(data + 2 * m)));
+  }
+
+  apply_gain_scalar(data + 2 * m, n - m, gain);
+}
+
+__attribute__((target("avx2"))) void mix_avx2(const float* in,
+                                              float* out,
+                                              const uint& n,
+                                              const float& gain) {
+  __m256 g = _mm256_set1_ps(gain);
+  uint m = 0;
+
+  for (; m + 4 <= n; m += 4) {
+    __m256 v = _mm256_mul_ps(g, _mm256_loadu_ps(in + 2 * m));
+
+    _mm256_storeu_ps(out + 2 * m,
+                     _mm256_add_ps(_mm256_loadu_ps(out + 2 * m), v));
+  }
+
+  mix_scalar(in + 2 * m, out + 2 * m, n - m, gain);
+}
+
+__attribute__((target("avx2"))) void apply_gain_meter_avx2(float* data,
+                                                           const uint& n,
+                                                           const float& gain0,
+                                                           const float& gain1,
+                                                           dsp::Meter& meter) {
+  float step = (gain1 - gain0) / n;
+
+  // each vector holds four frames
+
+  __m256 g = _mm256_setr_ps(gain0 + step, gain0 + step, gain0 + 2.0f * step,
+                            gain0 + 2.0f * step, gain0 + 3.0f * step,
+                            gain0 + 3.0f * step, gain0 + 4.0f * step,
+                            gain0 + 4.0f * step);
+  __m256 dg = _mm256_set1_ps(4.0f * step);
+  __m256 sign = _mm256_set1_ps(-0.0f);
+  __m256 p = _mm256_setzero_ps();
+  __m256 s = _mm256_setzero_ps();
+  uint m = 0;
+
+  for (; m + 4 <= n; m += 4) {
+    __m256 v = _mm256_mul_ps(g, _mm256_loadu_ps(data + 2 * m));
+
+    _mm256_storeu_ps(data + 2 * m, v);
+
+    p = _mm256_max_ps(p, _mm256_andnot_ps(sign, v));
+    s = _mm256_add_ps(s, _mm256_mul_ps(v, v));
+
+    g = _mm256_add_ps(g, dg);
+  }
+
+  alignas(32) float vp[8], vs[8];
+
+  _mm256_store_ps(vp, p);
+  _mm256_store_ps(vs, s);
+
+  for (uint k = 0; k < 8; k += 2) {
+    meter.peak_L = std::max(meter.peak_L, vp[k]);
+    meter.peak_R = std::max(meter.peak_R, vp[k + 1]);
+    meter.sum_L += vs[k];
+    meter.sum_R += vs[k + 1];
+  }
+
+  apply_gain_meter_scalar(data + 2 * m, n - m, gain0, gain1, meter, m, n);
+}
+
+#elif defined(__ARM_NEON)
+
+void deinterleave_neon(const float* data,
+                       float* L,
+                       float* R,
+                       const uint& n) {
+  uint m = 0;
+
+  for (; m + 4 <= n; m += 4) {
+    float32x4x2_t v = vld2q_f32(data + 2 * m);
+
+    vst1q_f32(L + m, v.val[0]);
+    vst1q_f32(R + m, v.val[1]);
+  }
+
+  deinterleave_scalar(data + 2 * m, L + m, R + m, n - m);
+}
+
+void interleave_neon(const float* L,
+                     const float* R,
+                     float* data,
+                     const uint& n) {
+  uint m = 0;
+
+  for (; m + 4 <= n; m += 4) {
+    float32x4x2_t v;
+
+    v.val[0] = vld1q_f32(L + m);
+    v.val[1] = vld1q_f32(R + m);
+
+    vst2q_f32(data + 2 * m, v);
+  }
+
+  interleave_scalar(L + m, R + m, data + 2 * m, n - m);
+}
+
+void apply_gain_neon(float* data, const uint& n, const float& gain) {
+  uint m = 0;
+
+  for (; m + 2 <= n; m += 2) {
+    vst1q_f32(data + 2 * m, vmulq_n_f32(vld1q_f32(data + 2 * m), gain));
+  }
+
+  apply_gain_scalar(data + 2 * m, n - m, gain);
+}
+
+void mix_neon(const float* in, float* out, const uint& n, const float& gain) {
+  uint m = 0;
+
+  for (; m + 2 <= n; m += 2) {
+    vst1q_f32(out + 2 * m,
+              vmlaq_n_f32(vld1q_f32(out + 2 * m), vld1q_f32(in + 2 * m), gain));
+  }
+
+  mix_scalar(in + 2 * m, out + 2 * m, n - m, gain);
+}
+
+void peak_neon(const float* data,
+               const uint& n,
+               float& peak_L,
+               float& peak_R) {
+  float32x4_t p = {peak_L, peak_R, peak_L, peak_R};
+  uint m = 0;
+
+  for (; m + 2 <= n; m += 2) {
+    p = vmaxq_f32(p, vabsq_f32(vld1q_f32(data + 2 * m)));
+  }
+
+  peak_L = std::max(vgetq_lane_f32(p, 0), vgetq_lane_f32(p, 2));
+  peak_R = std::max(vgetq_lane_f32(p, 1), vgetq_lane_f32(p, 3));
+
+  peak_scalar(data + 2 * m, n - m, peak_L, peak_R);
+}
+
+void apply_gain_meter_neon(float* data,
+                           const uint& n,
+                           const float& gain0,
+                           const float& gain1,
+                           dsp::Meter& meter) {
+  float step = (gain1 - gain0) / n;
+
+  float32x4_t g = {gain0 + step, gain0 + step, gain0 + 2.0f * step,
+                   gain0 + 2.0f * step};
+  float32x4_t dg = vdupq_n_f32(2.0f * step);
+  float32x4_t p = vdupq_n_f32(0.0f);
+  float32x4_t s = vdupq_n_f32(0.0f);
+  uint m = 0;
+
+  for (; m + 2 <= n; m += 2) {
+    float32x4_t v = vmulq_f32(g, vld1q_f32(data + 2 * m));
+
+    vst1q_f32(data + 2 * m, v);
+
+    p = vmaxq_f32(p, vabsq_f32(v));
+    s = vmlaq_f32(s, v, v);
+
+    g = vaddq_f32(g, dg);
+  }
+
+  meter.peak_L = std::max(
+      {meter.peak_L, vgetq_lane_f32(p, 0), vgetq_lane_f32(p, 2)});
+  meter.peak_R = std::max(
+      {meter.peak_R, vgetq_lane_f32(p, 1), vgetq_lane_f32(p, 3)});
+  meter.sum_L += vgetq_lane_f32(s, 0) + vgetq_lane_f32(s, 2);
+  meter.sum_R += vgetq_lane_f32(s, 1) + vgetq_lane_f32(s, 3);
+
+  apply_gain_meter_scalar(data + 2 * m, n - m, gain0, gain1, meter, m, n);
+}
+
+#endif
+
+struct Implementation {
+  std::string name;
+
+  void (*deinterleave)(const float*, float*, float*, const uint&);
+  void (*interleave)(const float*, const float*, float*, const uint&);
+  void (*apply_gain)(float*, const uint&, const float&);
+  void (*apply_gain_ramp)(float*, const uint&, const float&, const float&);
+  void (*mix)(const float*, float*, const uint&, const float&);
+  void (*crossfade)(const float*, float*, const uint&);
+  void (*peak)(const float*, const uint&, float&, float&);
+  void (*apply_gain_meter)(float*,
+                           const uint&,
+                           const float&,
+                           const float&,
+                           dsp::Meter&);
+};
+
+void apply_gain_meter_default(float* data,
+                              const uint& n,
+                              const float& gain0,
+                              const float& gain1,
+                              dsp::Meter& meter) {
+  apply_gain_meter_scalar(data, n, gain0, gain1, meter);
+}
+
+void apply_gain_ramp_default(float* data,
+                             const uint& n,
+                             const float& gain0,
+                             const float& gain1) {
+  apply_gain_ramp_scalar(data, n, gain0, gain1);
+}
+
+void crossfade_default(const float* in, float* out, const uint& n) {
+  crossfade_scalar(in, out, n);
+}
+
+/*
+  The scalar implementation is always available so the tests can use it as
+  the reference. The list goes from the slowest to the fastest.
+*/
+
+std::vector<Implementation> find_implementations() {
+  std::vector<Implementation> list;
+  Implementation impl;
+
+  impl.name = "scalar";
+  impl.deinterleave = deinterleave_scalar;
+  impl.interleave = interleave_scalar;
+  impl.apply_gain = apply_gain_scalar;
+  impl.apply_gain_ramp = apply_gain_ramp_default;
+  impl.mix = mix_scalar;
+  impl.crossfade = crossfade_default;
+  impl.peak = peak_scalar;
+  impl.apply_gain_meter = apply_gain_meter_default;
+
+  list.push_back(impl);
+
+#if defined(__x86_64__)
+  impl.name = "sse2";
+  impl.deinterleave = deinterleave_sse2;
+  impl.interleave = interleave_sse2;
+  impl.apply_gain = apply_gain_sse2;
+  impl.apply_gain_ramp = apply_gain_ramp_sse2;
+  impl.mix = mix_sse2;
+  impl.crossfade = crossfade_sse2;
+  impl.peak = peak_sse2;
+  impl.apply_gain_meter = apply_gain_meter_sse2;
+
+  list.push_back(impl);
+
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx2")) {
+    impl.name = "avx2";
+    impl.deinterleave = deinterleave_avx2;
+    impl.interleave = interleave_avx2;
+    impl.apply_gain = apply_gain_avx2;
+    impl.mix = mix_avx2;
+    impl.apply_gain_meter = apply_gain_meter_avx2;
+
+    list.push_back(impl);
+  }
+#elif defined(__ARM_NEON)
+  impl.name = "neon";
+  impl.deinterleave = deinterleave_neon;
+  impl.interleave = interleave_neon;
+  impl.apply_gain = apply_gain_neon;
+  impl.mix = mix_neon;
+  impl.peak = peak_neon;
+  impl.apply_gain_meter = apply_gain_meter_neon;
+
+  list.push_back(impl);
+#endif
+
+  return list;
+}
+
+const std::vector<Implementation> implementations = find_implementations();
+
+Implementation impl = implementations.back();
+
+}  // namespace
+
+namespace dsp {
+
+std::string get_implementation() {
+  return impl.name;
+}
+
+std::vector<std::string> get_implementations() {
+  std::vector<std::string> names;
+
+  for (auto& i : implementations) {
+    names.push_back(i.name);
+  }
+
+  return names;
+}
+
+bool set_implementation(const std::string& name) {
+  for (auto& i : implementations) {
+    if (i.name == name) {
+      impl = i;
+
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void deinterleave(const float* data, float* L, float* R, const uint& n) {
+  impl.deinterleave(data, L, R, n);
+}
+
+void interleave(const float* L, const float* R, float* data, const uint& n) {
+  impl.interleave(L, R, data, n);
+}
+
+void apply_gain(float* data, const uint& n, const float& gain) {
+  impl.apply_gain(data, n, gain);
+}
+
+void apply_gain_ramp(float* data,
+                     const uint& n,
+                     const float& gain0,
+                     const float& gain1) {
+  if (n > 0) {
+    impl.apply_gain_ramp(data, n, gain0, gain1);
+  }
+}
+
+void mix(const float* in, float* out, const uint& n, const float& gain) {
+  impl.mix(in, out, n, gain);
+}
+
+void crossfade(const float* in, float* out, const uint& n) {
+  if (n > 0) {
+    impl.crossfade(in, out, n);
+  }
+}
+
+void peak(const float* data, const uint& n, float& peak_L, float& peak_R) {
+  impl.peak(data, n, peak_L, peak_R);
+}
+
+void apply_gain_meter(float* data,
+                      const uint& n,
+                      const float& gain0,
+                      const float& gain1,
+                      Meter& meter) {
+  if (n > 0) {
+    impl.apply_gain_meter(data, n, gain0, gain1, meter);
+  }
+}
+
+}  // namespace dsp
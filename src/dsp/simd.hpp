@@ -0,0 +1,66 @@
+#ifndef DSP_SIMD_HPP
+#define DSP_SIMD_HPP
+
+#include <sys/types.h>
+#include <string>
+#include <vector>
+
+/*
+  Small vectorized helpers shared by our native GStreamer elements. Buffers
+  are stereo interleaved unless said otherwise and n is always a number of
+  frames. The SSE2, AVX2 or NEON implementation is chosen when the library is
+  loaded, according to what the cpu supports. No alignment is required.
+*/
+
+namespace dsp {
+
+// running peak and sum of squares of each channel
+
+struct Meter {
+  float peak_L = 0.0f, peak_R = 0.0f;
+  float sum_L = 0.0f, sum_R = 0.0f;
+};
+
+// name of the implementation in use: "avx2", "sse2", "neon" or "scalar"
+std::string get_implementation();
+
+// implementations the cpu supports, from the slowest to the fastest
+std::vector<std::string> get_implementations();
+
+// only meant for the tests and benchmarks. Returns false if not supported
+bool set_implementation(const std::string& name);
+
+// data -> L, R
+void deinterleave(const float* data, float* L, float* R, const uint& n);
+
+// L, R -> data
+void interleave(const float* L, const float* R, float* data, const uint& n);
+
+// data *= gain
+void apply_gain(float* data, const uint& n, const float& gain);
+
+// data *= gain going linearly from gain0 to gain1. The last frame gets gain1
+void apply_gain_ramp(float* data,
+                     const uint& n,
+                     const float& gain0,
+                     const float& gain1);
+
+// out += gain * in
+void mix(const float* in, float* out, const uint& n, const float& gain);
+
+// out goes linearly from in to out. The last frame is all out
+void crossfade(const float* in, float* out, const uint& n);
+
+// largest absolute value of each channel
+void peak(const float* data, const uint& n, float& peak_L, float& peak_R);
+
+// apply_gain_ramp and the meter update of the result in a single pass
+void apply_gain_meter(float* data,
+                      const uint& n,
+                      const float& gain0,
+                      const float& gain1,
+                      Meter& meter);
+
+}  // namespace dsp
+
+#endif
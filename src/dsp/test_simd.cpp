@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "simd.hpp"
+
+/*
+  Runs every function of each implementation the cpu supports and compares
+  the result with the one of the scalar implementation. All sizes up to
+  max_frames are tried so that the vector loops and their scalar tails are
+  both covered.
+*/
+
+namespace {
+
+const uint max_frames = 67;
+
+int failures = 0;
+
+bool near(const float& a, const float& b) {
+  return std::fabs(a - b) <= 1e-5f * std::max(1.0f, std::fabs(b));
+}
+
+void check(const std::string& impl,
+           const std::string& func,
+           const uint& n,
+           const std::vector<float>& a,
+           const std::vector<float>& b) {
+  for (uint i = 0; i < a.size(); i++) {
+    if (!near(a[i], b[i])) {
+      std::cerr << impl << ": " << func << " differs from scalar for n = " << n
+                << " at " << i << ": " << a[i] << " != " << b[i] << std::endl;
+
+      failures++;
+
+      return;
+    }
+  }
+}
+
+std::vector<float> make_signal(const uint& size) {
+  static std::mt19937 generator(1234);
+  std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+  std::vector<float> data(size);
+
+  for (auto& v : data) {
+    v = distribution(generator);
+  }
+
+  return data;
+}
+
+// output of every function for a given input
+
+std::vector<std::vector<float>> run(const uint& n,
+                                    const std::vector<float>& data,
+                                    const std::vector<float>& other) {
+  std::vector<std::vector<float>> results;
+  std::vector<float> L(n), R(n), out(2 * n);
+  float peak_L = 0.0f, peak_R = 0.0f;
+  dsp::Meter meter;
+
+  dsp::deinterleave(data.data(), L.data(), R.data(), n);
+
+  results.push_back(L);
+  results.push_back(R);
+
+  dsp::interleave(L.data(), R.data(), out.data(), n);
+
+  results.push_back(out);
+
+  out = data;
+  dsp::apply_gain(out.data(), n, 0.7f);
+
+  results.push_back(out);
+
+  out = data;
+  dsp::apply_gain_ramp(out.data(), n, 0.2f, 1.3f);
+
+  results.push_back(out);
+
+  out = other;
+  dsp::mix(data.data(), out.data(), n, 0.6f);
+
+  results.push_back(out);
+
+  out = other;
+  dsp::crossfade(data.data(), out.data(), n);
+
+  results.push_back(out);
+
+  dsp::peak(data.data(), n, peak_L, peak_R);
+
+  results.push_back({peak_L, peak_R});
+
+  out = data;
+  dsp::apply_gain_meter(out.data(), n, 0.2f, 1.3f, meter);
+
+  results.push_back(out);
+  results.push_back({meter.peak_L, meter.peak_R, meter.sum_L, meter.sum_R});
+
+  return results;
+}
+
+}  // namespace
+
+int main() {
+  const std::vector<std::string> names = {
+      "deinterleave L", "deinterleave R", "interleave", "apply_gain",
+      "apply_gain_ramp", "mix", "crossfade", "peak", "apply_gain_meter",
+      "meter"};
+
+  for (uint n = 1; n <= max_frames; n++) {
+    auto data = make_signal(2 * n);
+    auto other = make_signal(2 * n);
+
+    dsp::set_implementation("scalar");
+
+    auto reference = run(n, data, other);
+
+    for (auto& impl : dsp::get_implementations()) {
+      dsp::set_implementation(impl);
+
+      auto results = run(n, data, other);
+
+      for (uint m = 0; m < results.size(); m++) {
+        check(impl, names[m], n, results[m], reference[m]);
+      }
+    }
+  }
+
+  for (auto& impl : dsp::get_implementations()) {
+    std::cout << "tested " << impl << std::endl;
+  }
+
+  return (failures == 0) ? 0 : 1;
+}
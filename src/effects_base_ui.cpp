@@ -2,6 +2,7 @@
 #include <glibmm/i18n.h>
 #include <gtkmm/button.h>
 #include <gtkmm/label.h>
+#include <gtkmm/togglebutton.h>
 
 EffectsBaseUi::EffectsBaseUi(const Glib::RefPtr<Gtk::Builder>& builder,
                              const Glib::RefPtr<Gio::Settings>& refSettings,
@@ -127,3 +128,53 @@ int EffectsBaseUi::on_listbox_sort(Gtk::ListBoxRow* row1,
     return 0;
   }
 }
+
+/*
+  In the manual pipelining mode each plugin row has a button that puts a
+  thread boundary after the plugin.
+*/
+
+void EffectsBaseUi::add_boundary_button(Gtk::Box* box,
+                                        const std::string& name) {
+  auto button = Gtk::manage(new Gtk::ToggleButton());
+
+  button->set_image_from_icon_name("view-dual-symbolic",
+                                   Gtk::ICON_SIZE_BUTTON);
+  button->set_tooltip_text(_("Run the next effects on another thread"));
+  button->set_valign(Gtk::Align::ALIGN_CENTER);
+  button->set_no_show_all(true);
+
+  box->pack_end(*button, false, false);
+
+  auto update = [=]() {
+    auto list = settings->get_string_array("thread-boundaries");
+
+    button->set_active(std::find(list.begin(), list.end(), name) !=
+                       list.end());
+
+    button->set_visible(settings->get_enum("pipelining") == 1);  // Manual
+  };
+
+  update();
+
+  button->signal_toggled().connect([=]() {
+    auto list = settings->get_string_array("thread-boundaries");
+    auto it = std::find(list.begin(), list.end(), name);
+
+    if (button->get_active() && it == list.end()) {
+      list.push_back(name);
+
+      settings->set_string_array("thread-boundaries", list);
+    } else if (!button->get_active() && it != list.end()) {
+      list.erase(it);
+
+      settings->set_string_array("thread-boundaries", list);
+    }
+  });
+
+  connections.push_back(settings->signal_changed("thread-boundaries")
+                            .connect([=](auto key) { update(); }));
+
+  connections.push_back(settings->signal_changed("pipelining")
+                            .connect([=](auto key) { update(); }));
+}
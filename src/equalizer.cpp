@@ -18,87 +18,74 @@ Equalizer::Equalizer(const std::string& tag,
     : PluginBase(tag, "equalizer", schema),
       settings_left(g_settings_new(schema_left.c_str())),
       settings_right(g_settings_new(schema_right.c_str())) {
-  equalizer = gst_element_factory_make(
-      "lsp-plug-in-plugins-lv2-para-equalizer-x32-lr", nullptr);
-
-  if (is_installed(equalizer)) {
-    auto input_gain = gst_element_factory_make("volume", nullptr);
-    auto in_level = gst_element_factory_make("level", "equalizer_input_level");
-    auto out_level =
-        gst_element_factory_make("level", "equalizer_output_level");
-    auto output_gain = gst_element_factory_make("volume", nullptr);
+  if (is_installed("lsp-plug-in-plugins-lv2-para-equalizer-x32-lr")) {
+    g_signal_connect(settings, "changed::num-bands",
+                     G_CALLBACK(on_num_bands_changed), this);
 
-    auto audioconvert_in =
-        gst_element_factory_make("audioconvert", "eq_audioconvert_in");
-    auto audioconvert_out =
-        gst_element_factory_make("audioconvert", "eq_audioconvert_out");
+    // useless write just to force on_state_changed callback call
 
-    gst_bin_add_many(GST_BIN(bin), input_gain, in_level, audioconvert_in,
-                     equalizer, audioconvert_out, output_gain, out_level,
-                     nullptr);
+    auto enable = g_settings_get_boolean(settings, "state");
 
-    gst_element_link_many(input_gain, in_level, audioconvert_in, equalizer,
-                          audioconvert_out, output_gain, out_level, nullptr);
+    g_settings_set_boolean(settings, "state", enable);
+  }
+}
 
-    // setting bin ghost pads
+Equalizer::~Equalizer() {
+  g_object_unref(settings_left);
+  g_object_unref(settings_right);
 
-    auto pad_sink = gst_element_get_static_pad(input_gain, "sink");
-    auto pad_src = gst_element_get_static_pad(out_level, "src");
+  util::debug(log_tag + name + " destroyed");
+}
 
-    gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad_sink));
-    gst_element_add_pad(bin, gst_ghost_pad_new("src", pad_src));
+void Equalizer::create_bin() {
+  equalizer = gst_element_factory_make(
+      "lsp-plug-in-plugins-lv2-para-equalizer-x32-lr", nullptr);
 
-    gst_object_unref(GST_OBJECT(pad_sink));
-    gst_object_unref(GST_OBJECT(pad_src));
+  auto in_level =
+      gst_element_factory_make("pegainmeter", "equalizer_input_level");
+  auto out_level =
+      gst_element_factory_make("pegainmeter", "equalizer_output_level");
 
-    // init
+  auto audioconvert_in = make_converter(equalizer, "sink");
+  auto audioconvert_out = make_converter(equalizer, "src");
 
-    g_object_set(equalizer, "bypass", false, nullptr);
-    g_object_set(equalizer, "bal", 0.0f, nullptr);
-    g_object_set(equalizer, "fft", 0, nullptr);  // off
+  add_to_bin({in_level, audioconvert_in, equalizer, audioconvert_out,
+              out_level});
 
-    for (int n = 0; n < 30; n++) {
-      bind_band(equalizer, n);
-    }
+  // init
 
-    // connect signals
+  g_object_set(equalizer, "bypass", false, nullptr);
+  g_object_set(equalizer, "bal", 0.0f, nullptr);
+  g_object_set(equalizer, "fft", 0, nullptr);  // off
 
-    g_signal_connect(settings, "changed::num-bands",
-                     G_CALLBACK(on_num_bands_changed), this);
-
-    // gsettings bindings
-
-    g_settings_bind(settings, "post-messages", in_level, "post-messages",
-                    G_SETTINGS_BIND_DEFAULT);
-    g_settings_bind(settings, "post-messages", out_level, "post-messages",
-                    G_SETTINGS_BIND_DEFAULT);
+  for (int n = 0; n < 30; n++) {
+    bind_band(equalizer, n);
+  }
 
-    g_settings_bind_with_mapping(
-        settings, "input-gain", input_gain, "volume", G_SETTINGS_BIND_DEFAULT,
-        util::db20_gain_to_linear_double, util::linear_double_gain_to_db20,
-        nullptr, nullptr);
+  // gsettings bindings
 
-    g_settings_bind_with_mapping(
-        settings, "output-gain", output_gain, "volume", G_SETTINGS_BIND_DEFAULT,
-        util::db20_gain_to_linear_double, util::linear_double_gain_to_db20,
-        nullptr, nullptr);
+  g_settings_bind(settings, "post-messages", in_level, "post-messages",
+                  G_SETTINGS_BIND_DEFAULT);
+  g_settings_bind(settings, "post-messages", out_level, "post-messages",
+                  G_SETTINGS_BIND_DEFAULT);
 
-    g_settings_bind(settings, "mode", equalizer, "mode",
-                    G_SETTINGS_BIND_DEFAULT);
+  g_settings_bind_with_mapping(
+      settings, "input-gain", in_level, "volume", G_SETTINGS_BIND_DEFAULT,
+      util::db20_gain_to_linear_double, util::linear_double_gain_to_db20,
+      nullptr, nullptr);
 
-    // useless write just to force on_state_changed callback call
+  g_settings_bind_with_mapping(
+      settings, "output-gain", out_level, "volume", G_SETTINGS_BIND_DEFAULT,
+      util::db20_gain_to_linear_double, util::linear_double_gain_to_db20,
+      nullptr, nullptr);
 
-    auto enable = g_settings_get_boolean(settings, "state");
+  g_settings_bind(settings, "mode", equalizer, "mode", G_SETTINGS_BIND_DEFAULT);
 
-    g_settings_set_boolean(settings, "state", enable);
-  }
+  update_equalizer();
 }
 
-Equalizer::~Equalizer() {
-  g_object_unref(settings_left);
-  g_object_unref(settings_right);
-
-  util::debug(log_tag + name + " destroyed");
+void Equalizer::release_bin() {
+  equalizer = nullptr;
 }
 
 void Equalizer::bind_band(GstElement* equalizer, const int index) {
@@ -203,6 +190,10 @@ void Equalizer::bind_band(GstElement* equalizer, const int index) {
 }
 
 void Equalizer::update_equalizer() {
+  if (equalizer == nullptr) {
+    return;
+  }
+
   int nbands = g_settings_get_int(settings, "num-bands");
 
   for (int n = nbands; n < 30; n++) {
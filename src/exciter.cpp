@@ -11,6 +11,10 @@ void on_post_messages_changed(GSettings* settings, gchar* key, Exciter* l) {
     if (!l->harmonics_connection.connected()) {
       l->harmonics_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->exciter == nullptr) {
+              return true;
+            }
+
             float harmonics;
 
             g_object_get(l->exciter, "meter-drive", &harmonics, nullptr);
@@ -30,43 +34,10 @@ void on_post_messages_changed(GSettings* settings, gchar* key, Exciter* l) {
 
 Exciter::Exciter(const std::string& tag, const std::string& schema)
     : PluginBase(tag, "exciter", schema) {
-  exciter =
-      gst_element_factory_make("calf-sourceforge-net-plugins-Exciter", nullptr);
-
-  if (is_installed(exciter)) {
-    auto in_level = gst_element_factory_make("level", "exciter_input_level");
-    auto out_level = gst_element_factory_make("level", "exciter_output_level");
-    auto audioconvert_in =
-        gst_element_factory_make("audioconvert", "exciter_audioconvert_in");
-    auto audioconvert_out =
-        gst_element_factory_make("audioconvert", "exciter_audioconvert_out");
-
-    gst_bin_add_many(GST_BIN(bin), in_level, audioconvert_in, exciter,
-                     audioconvert_out, out_level, nullptr);
-    gst_element_link_many(in_level, audioconvert_in, exciter, audioconvert_out,
-                          out_level, nullptr);
-
-    auto pad_sink = gst_element_get_static_pad(in_level, "sink");
-    auto pad_src = gst_element_get_static_pad(out_level, "src");
-
-    gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad_sink));
-    gst_element_add_pad(bin, gst_ghost_pad_new("src", pad_src));
-
-    gst_object_unref(GST_OBJECT(pad_sink));
-    gst_object_unref(GST_OBJECT(pad_src));
-
-    g_object_set(exciter, "bypass", false, nullptr);
-
-    bind_to_gsettings();
-
+  if (is_installed("calf-sourceforge-net-plugins-Exciter")) {
     g_signal_connect(settings, "changed::post-messages",
                      G_CALLBACK(on_post_messages_changed), this);
 
-    g_settings_bind(settings, "post-messages", in_level, "post-messages",
-                    G_SETTINGS_BIND_DEFAULT);
-    g_settings_bind(settings, "post-messages", out_level, "post-messages",
-                    G_SETTINGS_BIND_DEFAULT);
-
     // useless write just to force callback call
 
     auto enable = g_settings_get_boolean(settings, "state");
@@ -79,6 +50,33 @@ Exciter::~Exciter() {
   util::debug(log_tag + name + " destroyed");
 }
 
+void Exciter::create_bin() {
+  exciter =
+      gst_element_factory_make("calf-sourceforge-net-plugins-Exciter", nullptr);
+
+  auto in_level =
+      gst_element_factory_make("pegainmeter", "exciter_input_level");
+  auto out_level =
+      gst_element_factory_make("pegainmeter", "exciter_output_level");
+  auto audioconvert_in = make_converter(exciter, "sink");
+  auto audioconvert_out = make_converter(exciter, "src");
+
+  add_to_bin({in_level, audioconvert_in, exciter, audioconvert_out, out_level});
+
+  g_object_set(exciter, "bypass", false, nullptr);
+
+  bind_to_gsettings();
+
+  g_settings_bind(settings, "post-messages", in_level, "post-messages",
+                  G_SETTINGS_BIND_DEFAULT);
+  g_settings_bind(settings, "post-messages", out_level, "post-messages",
+                  G_SETTINGS_BIND_DEFAULT);
+}
+
+void Exciter::release_bin() {
+  exciter = nullptr;
+}
+
 void Exciter::bind_to_gsettings() {
   g_settings_bind_with_mapping(
       settings, "input-gain", exciter, "level-in", G_SETTINGS_BIND_DEFAULT,
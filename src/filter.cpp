@@ -11,6 +11,10 @@ void on_post_messages_changed(GSettings* settings, gchar* key, Filter* l) {
     if (!l->input_level_connection.connected()) {
       l->input_level_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->filter == nullptr) {
+              return true;
+            }
+
             float inL, inR;
 
             g_object_get(l->filter, "meter-inL", &inL, nullptr);
@@ -28,6 +32,10 @@ void on_post_messages_changed(GSettings* settings, gchar* key, Filter* l) {
     if (!l->output_level_connection.connected()) {
       l->output_level_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->filter == nullptr) {
+              return true;
+            }
+
             float outL, outR;
 
             g_object_get(l->filter, "meter-outL", &outL, nullptr);
@@ -51,33 +59,7 @@ void on_post_messages_changed(GSettings* settings, gchar* key, Filter* l) {
 
 Filter::Filter(const std::string& tag, const std::string& schema)
     : PluginBase(tag, "filter", schema) {
-  filter =
-      gst_element_factory_make("calf-sourceforge-net-plugins-Filter", "filter");
-
-  if (is_installed(filter)) {
-    auto audioconvert_in =
-        gst_element_factory_make("audioconvert", "filter_audioconvert_in");
-    auto audioconvert_out =
-        gst_element_factory_make("audioconvert", "filter_audioconvert_out");
-
-    gst_bin_add_many(GST_BIN(bin), audioconvert_in, filter, audioconvert_out,
-                     nullptr);
-
-    gst_element_link_many(audioconvert_in, filter, audioconvert_out, nullptr);
-
-    auto pad_sink = gst_element_get_static_pad(audioconvert_in, "sink");
-    auto pad_src = gst_element_get_static_pad(audioconvert_out, "src");
-
-    gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad_sink));
-    gst_element_add_pad(bin, gst_ghost_pad_new("src", pad_src));
-
-    gst_object_unref(GST_OBJECT(pad_sink));
-    gst_object_unref(GST_OBJECT(pad_src));
-
-    g_object_set(filter, "bypass", false, nullptr);
-
-    bind_to_gsettings();
-
+  if (is_installed("calf-sourceforge-net-plugins-Filter")) {
     g_signal_connect(settings, "changed::post-messages",
                      G_CALLBACK(on_post_messages_changed), this);
 
@@ -93,6 +75,24 @@ Filter::~Filter() {
   util::debug(log_tag + name + " destroyed");
 }
 
+void Filter::create_bin() {
+  filter =
+      gst_element_factory_make("calf-sourceforge-net-plugins-Filter", "filter");
+
+  auto audioconvert_in = make_converter(filter, "sink");
+  auto audioconvert_out = make_converter(filter, "src");
+
+  add_to_bin({audioconvert_in, filter, audioconvert_out});
+
+  g_object_set(filter, "bypass", false, nullptr);
+
+  bind_to_gsettings();
+}
+
+void Filter::release_bin() {
+  filter = nullptr;
+}
+
 void Filter::bind_to_gsettings() {
   g_settings_bind_with_mapping(
       settings, "input-gain", filter, "level-in", G_SETTINGS_BIND_DEFAULT,
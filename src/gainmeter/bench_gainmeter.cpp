@@ -0,0 +1,142 @@
+#include <gst/app/gstappsrc.h>
+#include <gst/gst.h>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+  Before pegainmeter a plugin was wrapped by volume and level elements on each
+  side. Both chains run here in a real pipeline fed by appsrc, so the pad
+  pushes and the locking of every element are measured together with the
+  sample passes. The gain is not 1.0 because volume passes the buffers through
+  untouched in that case. Run with GST_PLUGIN_PATH pointing to the folder where
+  the pegainmeter plugin was built.
+*/
+
+namespace {
+
+const uint frames = 1024;
+const uint n_buffers = 20000;
+const double gain = 0.5;
+
+// returns the average time in nanoseconds spent on each buffer
+
+double measure(const std::string& chain, const std::vector<float>& data) {
+  GError* error = nullptr;
+
+  std::string description =
+      "appsrc name=src block=true format=time "
+      "caps=audio/x-raw,format=F32LE,rate=48000,channels=2,"
+      "layout=interleaved ! " +
+      chain + " ! fakesink sync=false";
+
+  GstElement* pipeline = gst_parse_launch(description.c_str(), &error);
+
+  if (error != nullptr) {
+    std::cerr << "could not create the pipeline: " << error->message
+              << std::endl;
+
+    g_error_free(error);
+
+    if (pipeline != nullptr) {
+      gst_object_unref(pipeline);
+    }
+
+    return -1.0;
+  }
+
+  GstElement* src = gst_bin_get_by_name(GST_BIN(pipeline), "src");
+
+  gst_element_set_state(pipeline, GST_STATE_PLAYING);
+
+  gsize size = data.size() * sizeof(float);
+  GstClockTime duration = gst_util_uint64_scale(frames, GST_SECOND, 48000);
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (uint n = 0; n < n_buffers; n++) {
+    GstBuffer* buffer = gst_buffer_new_allocate(nullptr, size, nullptr);
+
+    gst_buffer_fill(buffer, 0, data.data(), size);
+
+    GST_BUFFER_PTS(buffer) = n * duration;
+    GST_BUFFER_DURATION(buffer) = duration;
+
+    gst_app_src_push_buffer(GST_APP_SRC(src), buffer);
+  }
+
+  gst_app_src_end_of_stream(GST_APP_SRC(src));
+
+  GstBus* bus = gst_element_get_bus(pipeline);
+
+  // the level messages are discarded while we wait
+
+  GstMessage* msg = gst_bus_timed_pop_filtered(
+      bus, GST_CLOCK_TIME_NONE,
+      static_cast<GstMessageType>(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+
+  auto end = std::chrono::steady_clock::now();
+
+  bool failed = GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR;
+
+  gst_message_unref(msg);
+  gst_object_unref(bus);
+
+  gst_element_set_state(pipeline, GST_STATE_NULL);
+
+  gst_object_unref(src);
+  gst_object_unref(pipeline);
+
+  if (failed) {
+    return -1.0;
+  }
+
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         n_buffers;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  gst_init(&argc, &argv);
+
+  std::vector<float> data(2 * frames);
+
+  for (uint n = 0; n < data.size(); n++) {
+    data[n] = (n % 7) * 0.1f - 0.3f;
+  }
+
+  std::string volume = "volume volume=" + std::to_string(gain);
+  std::string gainmeter =
+      "pegainmeter post-messages=true volume=" + std::to_string(gain);
+
+  std::vector<std::pair<std::string, std::string>> chains = {
+      {"volume, level (x2)", volume + " ! level post-messages=true ! " +
+                                 volume + " ! level post-messages=true"},
+      {"pegainmeter (x2)", gainmeter + " ! " + gainmeter}};
+
+  std::cout << n_buffers << " buffers of " << frames << " stereo frames"
+            << std::endl;
+
+  bool failed = false;
+
+  for (auto& c : chains) {
+    double ns = measure(c.second, data);
+
+    if (ns < 0.0) {
+      std::cerr << c.first << ": the pipeline failed" << std::endl;
+
+      failed = true;
+
+      continue;
+    }
+
+    std::cout << std::left << std::setw(24) << c.first << std::right
+              << std::fixed << std::setprecision(1) << std::setw(10) << ns
+              << " ns per buffer" << std::endl;
+  }
+
+  return (failed) ? 1 : 0;
+}
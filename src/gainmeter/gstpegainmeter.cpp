@@ -0,0 +1,362 @@
+/**
+ * SECTION:element-gstpegainmeter
+ *
+ * The pegainmeter element applies a gain and measures the peak and rms level
+ * of the result in a single pass. It replaces the volume and level pairs
+ * around each of our effects. The messages it posts have the same structure
+ * name and the same peak and rms fields as the ones posted by level.
+ *
+ * <refsect2>
+ * <title>Example launch line</title>
+ * |[
+ * gst-launch-1.0 -v -m audiotestsrc ! pegainmeter volume=0.5 ! pulsesink
+ * ]|
+ * </refsect2>
+ */
+
+#include "gstpegainmeter.hpp"
+#include <gst/audio/gstaudiofilter.h>
+#include <gst/gst.h>
+#include <cmath>
+#include "config.h"
+
+GST_DEBUG_CATEGORY_STATIC(gst_pegainmeter_debug_category);
+#define GST_CAT_DEFAULT gst_pegainmeter_debug_category
+
+/* prototypes */
+
+static void gst_pegainmeter_set_property(GObject* object,
+                                         guint property_id,
+                                         const GValue* value,
+                                         GParamSpec* pspec);
+
+static void gst_pegainmeter_get_property(GObject* object,
+                                         guint property_id,
+                                         GValue* value,
+                                         GParamSpec* pspec);
+
+static gboolean gst_pegainmeter_setup(GstAudioFilter* filter,
+                                      const GstAudioInfo* info);
+
+static GstFlowReturn gst_pegainmeter_transform_ip(GstBaseTransform* trans,
+                                                  GstBuffer* buffer);
+
+static void gst_pegainmeter_process(GstPegainmeter* pegainmeter,
+                                    GstBuffer* buffer);
+
+static void gst_pegainmeter_post_message(GstPegainmeter* pegainmeter,
+                                         const GstClockTime& endtime);
+
+static void gst_pegainmeter_reset_meter(GstPegainmeter* pegainmeter);
+
+enum { PROP_VOLUME = 1, PROP_POST_MESSAGES, PROP_INTERVAL };
+
+/* pad templates */
+
+static GstStaticPadTemplate gst_pegainmeter_src_template =
+    GST_STATIC_PAD_TEMPLATE(
+        "src",
+        GST_PAD_SRC,
+        GST_PAD_ALWAYS,
+        GST_STATIC_CAPS("audio/x-raw,format=F32LE,rate=[1,max],"
+                        "channels=2,layout=interleaved"));
+
+static GstStaticPadTemplate gst_pegainmeter_sink_template =
+    GST_STATIC_PAD_TEMPLATE(
+        "sink",
+        GST_PAD_SINK,
+        GST_PAD_ALWAYS,
+        GST_STATIC_CAPS("audio/x-raw,format=F32LE,rate=[1,max],"
+                        "channels=2,layout=interleaved"));
+
+/* class initialization */
+
+G_DEFINE_TYPE_WITH_CODE(
+    GstPegainmeter,
+    gst_pegainmeter,
+    GST_TYPE_AUDIO_FILTER,
+    GST_DEBUG_CATEGORY_INIT(gst_pegainmeter_debug_category,
+                            "pegainmeter",
+                            0,
+                            "debug category for pegainmeter element"));
+
+static void gst_pegainmeter_class_init(GstPegainmeterClass* klass) {
+  GObjectClass* gobject_class = G_OBJECT_CLASS(klass);
+
+  GstBaseTransformClass* base_transform_class = GST_BASE_TRANSFORM_CLASS(klass);
+
+  GstAudioFilterClass* audio_filter_class = GST_AUDIO_FILTER_CLASS(klass);
+
+  /* Setting up pads and setting metadata should be moved to
+     base_class_init if you intend to subclass this class. */
+
+  gst_element_class_add_static_pad_template(GST_ELEMENT_CLASS(klass),
+                                            &gst_pegainmeter_src_template);
+  gst_element_class_add_static_pad_template(GST_ELEMENT_CLASS(klass),
+                                            &gst_pegainmeter_sink_template);
+
+  gst_element_class_set_static_metadata(
+      GST_ELEMENT_CLASS(klass), "PulseEffects gain and level meter",
+      "Generic", "Applies a gain and measures the level of the result",
+      "Wellington <wellingtonwallace@gmail.com>");
+
+  /* define virtual function pointers */
+
+  gobject_class->set_property = gst_pegainmeter_set_property;
+  gobject_class->get_property = gst_pegainmeter_get_property;
+
+  audio_filter_class->setup = GST_DEBUG_FUNCPTR(gst_pegainmeter_setup);
+  base_transform_class->transform_ip =
+      GST_DEBUG_FUNCPTR(gst_pegainmeter_transform_ip);
+  base_transform_class->transform_ip_on_passthrough = false;
+
+  /* define properties */
+
+  g_object_class_install_property(
+      gobject_class, PROP_VOLUME,
+      g_param_spec_double("volume", "Volume", "Linear gain", 0.0, 10.0, 1.0,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE |
+                                                   G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_POST_MESSAGES,
+      g_param_spec_boolean("post-messages", "Post Messages",
+                           "Post level messages on the bus", true,
+                           static_cast<GParamFlags>(G_PARAM_READWRITE |
+                                                    G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_INTERVAL,
+      g_param_spec_uint64("interval", "Interval",
+                          "Time between level messages (in nanoseconds)", 1,
+                          G_MAXUINT64, GST_SECOND / 10,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE |
+                                                   G_PARAM_STATIC_STRINGS)));
+}
+
+static void gst_pegainmeter_init(GstPegainmeter* pegainmeter) {
+  pegainmeter->volume = 1.0;
+  pegainmeter->post_messages = true;
+  pegainmeter->interval = GST_SECOND / 10;
+  pegainmeter->bpf = 0;
+  pegainmeter->rate = 0;
+  pegainmeter->gain = 1.0f;
+
+  gst_pegainmeter_reset_meter(pegainmeter);
+
+  gst_base_transform_set_in_place(GST_BASE_TRANSFORM(pegainmeter), true);
+}
+
+void gst_pegainmeter_set_property(GObject* object,
+                                  guint property_id,
+                                  const GValue* value,
+                                  GParamSpec* pspec) {
+  GstPegainmeter* pegainmeter = GST_PEGAINMETER(object);
+
+  GST_DEBUG_OBJECT(pegainmeter, "set_property");
+
+  switch (property_id) {
+    case PROP_VOLUME:
+      pegainmeter->volume = g_value_get_double(value);
+      break;
+    case PROP_POST_MESSAGES:
+      pegainmeter->post_messages = g_value_get_boolean(value);
+      break;
+    case PROP_INTERVAL:
+      pegainmeter->interval = g_value_get_uint64(value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+      break;
+  }
+}
+
+void gst_pegainmeter_get_property(GObject* object,
+                                  guint property_id,
+                                  GValue* value,
+                                  GParamSpec* pspec) {
+  GstPegainmeter* pegainmeter = GST_PEGAINMETER(object);
+
+  GST_DEBUG_OBJECT(pegainmeter, "get_property");
+
+  switch (property_id) {
+    case PROP_VOLUME:
+      g_value_set_double(value, pegainmeter->volume);
+      break;
+    case PROP_POST_MESSAGES:
+      g_value_set_boolean(value, pegainmeter->post_messages);
+      break;
+    case PROP_INTERVAL:
+      g_value_set_uint64(value, pegainmeter->interval);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+      break;
+  }
+}
+
+static gboolean gst_pegainmeter_setup(GstAudioFilter* filter,
+                                      const GstAudioInfo* info) {
+  GstPegainmeter* pegainmeter = GST_PEGAINMETER(filter);
+
+  GST_DEBUG_OBJECT(pegainmeter, "setup");
+
+  pegainmeter->bpf = info->bpf;
+  pegainmeter->rate = info->rate;
+
+  gst_pegainmeter_reset_meter(pegainmeter);
+
+  return true;
+}
+
+static GstFlowReturn gst_pegainmeter_transform_ip(GstBaseTransform* trans,
+                                                  GstBuffer* buffer) {
+  GstPegainmeter* pegainmeter = GST_PEGAINMETER(trans);
+
+  GST_DEBUG_OBJECT(pegainmeter, "transform");
+
+  if (pegainmeter->rate > 0) {
+    gst_pegainmeter_process(pegainmeter, buffer);
+  }
+
+  return GST_FLOW_OK;
+}
+
+static void gst_pegainmeter_process(GstPegainmeter* pegainmeter,
+                                    GstBuffer* buffer) {
+  float gain = pegainmeter->volume;
+  bool post = pegainmeter->post_messages;
+
+  // unity gain without metering leaves the buffer untouched
+
+  if (!post && gain == 1.0f && pegainmeter->gain == 1.0f) {
+    return;
+  }
+
+  GstMapInfo map;
+
+  gst_buffer_map(buffer, &map, GST_MAP_READWRITE);
+
+  float* data = (float*)map.data;
+
+  guint num_samples = map.size / pegainmeter->bpf;
+
+  /*
+    A new gain is reached through a ramp over the buffer, like the one used
+    by the autogain, so moving the gain sliders does not click.
+  */
+
+  if (post) {
+    if (pegainmeter->meter_samples == 0) {
+      pegainmeter->meter_start = GST_BUFFER_PTS(buffer);
+    }
+
+    dsp::apply_gain_meter(data, num_samples, pegainmeter->gain, gain,
+                          pegainmeter->meter);
+
+    pegainmeter->meter_samples += num_samples;
+
+    if (pegainmeter->meter_samples >=
+        GST_CLOCK_TIME_TO_FRAMES(pegainmeter->interval, pegainmeter->rate)) {
+      GstClockTime endtime = GST_CLOCK_TIME_NONE;
+
+      if (GST_BUFFER_PTS_IS_VALID(buffer)) {
+        endtime = GST_BUFFER_PTS(buffer) +
+                  GST_FRAMES_TO_CLOCK_TIME(num_samples, pegainmeter->rate);
+      }
+
+      gst_pegainmeter_post_message(pegainmeter, endtime);
+
+      gst_pegainmeter_reset_meter(pegainmeter);
+    }
+  } else {
+    if (gain != pegainmeter->gain) {
+      dsp::apply_gain_ramp(data, num_samples, pegainmeter->gain, gain);
+    } else {
+      dsp::apply_gain(data, num_samples, gain);
+    }
+
+    gst_pegainmeter_reset_meter(pegainmeter);
+  }
+
+  pegainmeter->gain = gain;
+
+  gst_buffer_unmap(buffer, &map);
+}
+
+static void gst_pegainmeter_set_array(GstStructure* s,
+                                      const gchar* name,
+                                      const double& L,
+                                      const double& R) {
+  G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+
+  GValueArray* array = g_value_array_new(2);
+  GValue v = G_VALUE_INIT;
+
+  g_value_init(&v, G_TYPE_DOUBLE);
+
+  g_value_set_double(&v, L);
+  g_value_array_append(array, &v);
+
+  g_value_set_double(&v, R);
+  g_value_array_append(array, &v);
+
+  g_value_unset(&v);
+
+  GValue a = G_VALUE_INIT;
+
+  g_value_init(&a, G_TYPE_VALUE_ARRAY);
+  g_value_take_boxed(&a, array);
+
+  gst_structure_take_value(s, name, &a);
+
+  G_GNUC_END_IGNORE_DEPRECATIONS
+}
+
+static void gst_pegainmeter_post_message(GstPegainmeter* pegainmeter,
+                                         const GstClockTime& endtime) {
+  auto& meter = pegainmeter->meter;
+  double n = pegainmeter->meter_samples;
+
+  GstStructure* s = gst_structure_new(
+      "level", "endtime", GST_TYPE_CLOCK_TIME, endtime, "timestamp",
+      GST_TYPE_CLOCK_TIME, pegainmeter->meter_start, "duration",
+      GST_TYPE_CLOCK_TIME,
+      GST_FRAMES_TO_CLOCK_TIME(pegainmeter->meter_samples, pegainmeter->rate),
+      nullptr);
+
+  // dB values, like the ones posted by level
+
+  gst_pegainmeter_set_array(s, "peak", 20.0 * log10(meter.peak_L),
+                            20.0 * log10(meter.peak_R));
+
+  gst_pegainmeter_set_array(s, "rms", 10.0 * log10(meter.sum_L / n),
+                            10.0 * log10(meter.sum_R / n));
+
+  gst_element_post_message(
+      GST_ELEMENT(pegainmeter),
+      gst_message_new_element(GST_OBJECT(pegainmeter), s));
+}
+
+static void gst_pegainmeter_reset_meter(GstPegainmeter* pegainmeter) {
+  pegainmeter->meter = dsp::Meter();
+  pegainmeter->meter_samples = 0;
+  pegainmeter->meter_start = GST_CLOCK_TIME_NONE;
+}
+
+static gboolean plugin_init(GstPlugin* plugin) {
+  /* FIXME Remember to set the rank if it's an element that is meant
+     to be autoplugged by decodebin. */
+  return gst_element_register(plugin, "pegainmeter", GST_RANK_NONE,
+                              GST_TYPE_PEGAINMETER);
+}
+
+GST_PLUGIN_DEFINE(GST_VERSION_MAJOR,
+                  GST_VERSION_MINOR,
+                  pegainmeter,
+                  "PulseEffects gain and level meter",
+                  plugin_init,
+                  VERSION,
+                  "LGPL",
+                  PACKAGE,
+                  "https://github.com/wwmm/pulseeffects")
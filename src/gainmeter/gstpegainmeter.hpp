@@ -0,0 +1,52 @@
+#ifndef _GST_PEGAINMETER_H_
+#define _GST_PEGAINMETER_H_
+
+#include <gst/audio/gstaudiofilter.h>
+#include "simd.hpp"
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_PEGAINMETER (gst_pegainmeter_get_type())
+#define GST_PEGAINMETER(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_PEGAINMETER, GstPegainmeter))
+#define GST_PEGAINMETER_CLASS(klass)                      \
+  (G_TYPE_CHECK_CLASS_CAST((klass), GST_TYPE_PEGAINMETER, \
+                           GstPegainmeterClass))
+#define GST_IS_PEGAINMETER(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_PEGAINMETER))
+#define GST_IS_PEGAINMETER_CLASS(obj) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass), GST_TYPE_PEGAINMETER))
+
+typedef struct _GstPegainmeter GstPegainmeter;
+typedef struct _GstPegainmeterClass GstPegainmeterClass;
+
+struct _GstPegainmeter {
+  GstAudioFilter base_pegainmeter;
+
+  /* properties */
+
+  double volume;       // linear gain
+  bool post_messages;  // post level messages
+  guint64 interval;    // time between messages in nanoseconds
+
+  /* < private > */
+
+  int bpf;   // bytes per frame : channels * bps
+  int rate;  // sampling rate
+
+  float gain;  // gain applied at the end of the last buffer
+
+  dsp::Meter meter;  // measurements since the last message
+  guint64 meter_samples;
+  GstClockTime meter_start;  // timestamp of the first sample measured
+};
+
+struct _GstPegainmeterClass {
+  GstAudioFilterClass base_pegainmeter_class;
+};
+
+GType gst_pegainmeter_get_type(void);
+
+G_END_DECLS
+
+#endif
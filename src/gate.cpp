@@ -11,6 +11,10 @@ void on_post_messages_changed(GSettings* settings, gchar* key, Gate* l) {
     if (!l->gating_connection.connected()) {
       l->gating_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->gate == nullptr) {
+              return true;
+            }
+
             float gating;
 
             g_object_get(l->gate, "gating", &gating, nullptr);
@@ -30,42 +34,10 @@ void on_post_messages_changed(GSettings* settings, gchar* key, Gate* l) {
 
 Gate::Gate(const std::string& tag, const std::string& schema)
     : PluginBase(tag, "gate", schema) {
-  gate = gst_element_factory_make("calf-sourceforge-net-plugins-Gate", "gate");
-
-  if (is_installed(gate)) {
-    auto in_level = gst_element_factory_make("level", "gate_input_level");
-    auto out_level = gst_element_factory_make("level", "gate_output_level");
-    auto audioconvert_in =
-        gst_element_factory_make("audioconvert", "gate_audioconvert_in");
-    auto audioconvert_out =
-        gst_element_factory_make("audioconvert", "gate_audioconvert_out");
-
-    gst_bin_add_many(GST_BIN(bin), in_level, audioconvert_in, gate,
-                     audioconvert_out, out_level, nullptr);
-    gst_element_link_many(in_level, audioconvert_in, gate, audioconvert_out,
-                          out_level, nullptr);
-
-    auto pad_sink = gst_element_get_static_pad(in_level, "sink");
-    auto pad_src = gst_element_get_static_pad(out_level, "src");
-
-    gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad_sink));
-    gst_element_add_pad(bin, gst_ghost_pad_new("src", pad_src));
-
-    gst_object_unref(GST_OBJECT(pad_sink));
-    gst_object_unref(GST_OBJECT(pad_src));
-
-    g_object_set(gate, "bypass", false, nullptr);
-
-    bind_to_gsettings();
-
+  if (is_installed("calf-sourceforge-net-plugins-Gate")) {
     g_signal_connect(settings, "changed::post-messages",
                      G_CALLBACK(on_post_messages_changed), this);
 
-    g_settings_bind(settings, "post-messages", in_level, "post-messages",
-                    G_SETTINGS_BIND_DEFAULT);
-    g_settings_bind(settings, "post-messages", out_level, "post-messages",
-                    G_SETTINGS_BIND_DEFAULT);
-
     // useless write just to force callback call
 
     auto enable = g_settings_get_boolean(settings, "state");
@@ -78,6 +50,30 @@ Gate::~Gate() {
   util::debug(log_tag + name + " destroyed");
 }
 
+void Gate::create_bin() {
+  gate = gst_element_factory_make("calf-sourceforge-net-plugins-Gate", "gate");
+
+  auto in_level = gst_element_factory_make("pegainmeter", "gate_input_level");
+  auto out_level = gst_element_factory_make("pegainmeter", "gate_output_level");
+  auto audioconvert_in = make_converter(gate, "sink");
+  auto audioconvert_out = make_converter(gate, "src");
+
+  add_to_bin({in_level, audioconvert_in, gate, audioconvert_out, out_level});
+
+  g_object_set(gate, "bypass", false, nullptr);
+
+  bind_to_gsettings();
+
+  g_settings_bind(settings, "post-messages", in_level, "post-messages",
+                  G_SETTINGS_BIND_DEFAULT);
+  g_settings_bind(settings, "post-messages", out_level, "post-messages",
+                  G_SETTINGS_BIND_DEFAULT);
+}
+
+void Gate::release_bin() {
+  gate = nullptr;
+}
+
 void Gate::bind_to_gsettings() {
   g_settings_bind(settings, "detection", gate, "detection",
                   G_SETTINGS_BIND_DEFAULT);
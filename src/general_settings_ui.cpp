@@ -43,6 +43,10 @@ GeneralSettingsUi::GeneralSettingsUi(BaseObjectType* cobject,
                                      Application* application)
     : Gtk::Grid(cobject),
       settings(Gio::Settings::create("com.github.wwmm.pulseeffects")),
+      sie_settings(
+          Gio::Settings::create("com.github.wwmm.pulseeffects.sinkinputs")),
+      soe_settings(
+          Gio::Settings::create("com.github.wwmm.pulseeffects.sourceoutputs")),
       app(application) {
   // loading glade widgets
 
@@ -50,6 +54,9 @@ GeneralSettingsUi::GeneralSettingsUi(BaseObjectType* cobject,
   builder->get_widget("enable_autostart", enable_autostart);
   builder->get_widget("enable_all_sinkinputs", enable_all_sinkinputs);
   builder->get_widget("enable_all_sourceoutputs", enable_all_sourceoutputs);
+  builder->get_widget("parallel_sinkinputs", parallel_sinkinputs);
+  builder->get_widget("pipelining_sinkinputs", pipelining_sinkinputs);
+  builder->get_widget("pipelining_sourceoutputs", pipelining_sourceoutputs);
   builder->get_widget("reset_settings", reset_settings);
   builder->get_widget("about_button", about_button);
   builder->get_widget("realtime_priority", realtime_priority_control);
@@ -106,6 +113,10 @@ GeneralSettingsUi::GeneralSettingsUi(BaseObjectType* cobject,
                  flag);
   settings->bind("enable-all-sourceoutputs", enable_all_sourceoutputs, "active",
                  flag);
+  settings->bind("parallel-sinkinputs", parallel_sinkinputs, "active", flag);
+  sie_settings->bind("pipelining", pipelining_sinkinputs, "active_id", flag);
+  soe_settings->bind("pipelining", pipelining_sourceoutputs, "active_id",
+                     flag);
   settings->bind("realtime-priority", adjustment_priority.get(), "value", flag);
   settings->bind("niceness", adjustment_niceness.get(), "value", flag);
 
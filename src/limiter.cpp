@@ -11,6 +11,10 @@ void on_post_messages_changed(GSettings* settings, gchar* key, Limiter* l) {
     if (!l->input_level_connection.connected()) {
       l->input_level_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->limiter == nullptr) {
+              return true;
+            }
+
             float inL, inR;
 
             g_object_get(l->limiter, "meter-inL", &inL, nullptr);
@@ -28,6 +32,10 @@ void on_post_messages_changed(GSettings* settings, gchar* key, Limiter* l) {
     if (!l->output_level_connection.connected()) {
       l->output_level_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->limiter == nullptr) {
+              return true;
+            }
+
             float outL, outR;
 
             g_object_get(l->limiter, "meter-outL", &outL, nullptr);
@@ -45,6 +53,10 @@ void on_post_messages_changed(GSettings* settings, gchar* key, Limiter* l) {
     if (!l->attenuation_connection.connected()) {
       l->attenuation_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->limiter == nullptr) {
+              return true;
+            }
+
             float att;
 
             g_object_get(l->limiter, "att", &att, nullptr);
@@ -67,33 +79,7 @@ void on_post_messages_changed(GSettings* settings, gchar* key, Limiter* l) {
 
 Limiter::Limiter(const std::string& tag, const std::string& schema)
     : PluginBase(tag, "limiter", schema) {
-  limiter =
-      gst_element_factory_make("calf-sourceforge-net-plugins-Limiter", nullptr);
-
-  if (is_installed(limiter)) {
-    auto audioconvert_in =
-        gst_element_factory_make("audioconvert", "limiter_audioconvert_in");
-    auto audioconvert_out =
-        gst_element_factory_make("audioconvert", "limiter_audioconvert_out");
-
-    gst_bin_add_many(GST_BIN(bin), audioconvert_in, limiter, audioconvert_out,
-                     nullptr);
-
-    gst_element_link_many(audioconvert_in, limiter, audioconvert_out, nullptr);
-
-    auto pad_sink = gst_element_get_static_pad(audioconvert_in, "sink");
-    auto pad_src = gst_element_get_static_pad(audioconvert_out, "src");
-
-    gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad_sink));
-    gst_element_add_pad(bin, gst_ghost_pad_new("src", pad_src));
-
-    gst_object_unref(GST_OBJECT(pad_sink));
-    gst_object_unref(GST_OBJECT(pad_src));
-
-    g_object_set(limiter, "bypass", false, nullptr);
-
-    bind_to_gsettings();
-
+  if (is_installed("calf-sourceforge-net-plugins-Limiter")) {
     g_signal_connect(settings, "changed::post-messages",
                      G_CALLBACK(on_post_messages_changed), this);
 
@@ -109,6 +95,24 @@ Limiter::~Limiter() {
   util::debug(log_tag + name + " destroyed");
 }
 
+void Limiter::create_bin() {
+  limiter =
+      gst_element_factory_make("calf-sourceforge-net-plugins-Limiter", nullptr);
+
+  auto audioconvert_in = make_converter(limiter, "sink");
+  auto audioconvert_out = make_converter(limiter, "src");
+
+  add_to_bin({audioconvert_in, limiter, audioconvert_out});
+
+  g_object_set(limiter, "bypass", false, nullptr);
+
+  bind_to_gsettings();
+}
+
+void Limiter::release_bin() {
+  limiter = nullptr;
+}
+
 void Limiter::bind_to_gsettings() {
   g_settings_bind_with_mapping(
       settings, "input-gain", limiter, "level-in", G_SETTINGS_BIND_DEFAULT,
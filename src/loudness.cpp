@@ -4,38 +4,7 @@
 
 Loudness::Loudness(const std::string& tag, const std::string& schema)
     : PluginBase(tag, "loudness", schema) {
-  loudness =
-      gst_element_factory_make("drobilla-net-plugins-mda-Loudness", nullptr);
-
-  if (is_installed(loudness)) {
-    auto in_level = gst_element_factory_make("level", "loudness_input_level");
-    auto out_level = gst_element_factory_make("level", "loudness_output_level");
-    auto audioconvert_in =
-        gst_element_factory_make("audioconvert", "loudness_audioconvert_in");
-    auto audioconvert_out =
-        gst_element_factory_make("audioconvert", "loudness_audioconvert_out");
-
-    gst_bin_add_many(GST_BIN(bin), in_level, audioconvert_in, loudness,
-                     audioconvert_out, out_level, nullptr);
-    gst_element_link_many(in_level, audioconvert_in, loudness, audioconvert_out,
-                          out_level, nullptr);
-
-    auto pad_sink = gst_element_get_static_pad(in_level, "sink");
-    auto pad_src = gst_element_get_static_pad(out_level, "src");
-
-    gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad_sink));
-    gst_element_add_pad(bin, gst_ghost_pad_new("src", pad_src));
-
-    gst_object_unref(GST_OBJECT(pad_sink));
-    gst_object_unref(GST_OBJECT(pad_src));
-
-    bind_to_gsettings();
-
-    g_settings_bind(settings, "post-messages", in_level, "post-messages",
-                    G_SETTINGS_BIND_DEFAULT);
-    g_settings_bind(settings, "post-messages", out_level, "post-messages",
-                    G_SETTINGS_BIND_DEFAULT);
-
+  if (is_installed("drobilla-net-plugins-mda-Loudness")) {
     // useless write just to force callback call
 
     auto enable = g_settings_get_boolean(settings, "state");
@@ -48,6 +17,32 @@ Loudness::~Loudness() {
   util::debug(log_tag + name + " destroyed");
 }
 
+void Loudness::create_bin() {
+  loudness =
+      gst_element_factory_make("drobilla-net-plugins-mda-Loudness", nullptr);
+
+  auto in_level =
+      gst_element_factory_make("pegainmeter", "loudness_input_level");
+  auto out_level =
+      gst_element_factory_make("pegainmeter", "loudness_output_level");
+  auto audioconvert_in = make_converter(loudness, "sink");
+  auto audioconvert_out = make_converter(loudness, "src");
+
+  add_to_bin({in_level, audioconvert_in, loudness, audioconvert_out,
+              out_level});
+
+  bind_to_gsettings();
+
+  g_settings_bind(settings, "post-messages", in_level, "post-messages",
+                  G_SETTINGS_BIND_DEFAULT);
+  g_settings_bind(settings, "post-messages", out_level, "post-messages",
+                  G_SETTINGS_BIND_DEFAULT);
+}
+
+void Loudness::release_bin() {
+  loudness = nullptr;
+}
+
 void Loudness::bind_to_gsettings() {
   g_settings_bind_with_mapping(
       settings, "loudness", loudness, "loudness", G_SETTINGS_BIND_DEFAULT,
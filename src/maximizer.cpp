@@ -11,6 +11,10 @@ void on_post_messages_changed(GSettings* settings, gchar* key, Maximizer* l) {
     if (!l->reduction_connection.connected()) {
       l->reduction_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->maximizer == nullptr) {
+              return true;
+            }
+
             float reduction;
 
             g_object_get(l->maximizer, "gain-reduction", &reduction, nullptr);
@@ -30,42 +34,10 @@ void on_post_messages_changed(GSettings* settings, gchar* key, Maximizer* l) {
 
 Maximizer::Maximizer(const std::string& tag, const std::string& schema)
     : PluginBase(tag, "maximizer", schema) {
-  maximizer =
-      gst_element_factory_make("ladspa-zamaximx2-ladspa-so-zamaximx2", nullptr);
-
-  if (is_installed(maximizer)) {
-    auto in_level = gst_element_factory_make("level", "maximizer_input_level");
-    auto out_level =
-        gst_element_factory_make("level", "maximizer_output_level");
-    auto audioconvert_in =
-        gst_element_factory_make("audioconvert", "maximizer_audioconvert_in");
-    auto audioconvert_out =
-        gst_element_factory_make("audioconvert", "maximizer_audioconvert_out");
-
-    gst_bin_add_many(GST_BIN(bin), in_level, audioconvert_in, maximizer,
-                     audioconvert_out, out_level, nullptr);
-    gst_element_link_many(in_level, audioconvert_in, maximizer,
-                          audioconvert_out, out_level, nullptr);
-
-    auto pad_sink = gst_element_get_static_pad(in_level, "sink");
-    auto pad_src = gst_element_get_static_pad(out_level, "src");
-
-    gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad_sink));
-    gst_element_add_pad(bin, gst_ghost_pad_new("src", pad_src));
-
-    gst_object_unref(GST_OBJECT(pad_sink));
-    gst_object_unref(GST_OBJECT(pad_src));
-
-    bind_to_gsettings();
-
+  if (is_installed("ladspa-zamaximx2-ladspa-so-zamaximx2")) {
     g_signal_connect(settings, "changed::post-messages",
                      G_CALLBACK(on_post_messages_changed), this);
 
-    g_settings_bind(settings, "post-messages", in_level, "post-messages",
-                    G_SETTINGS_BIND_DEFAULT);
-    g_settings_bind(settings, "post-messages", out_level, "post-messages",
-                    G_SETTINGS_BIND_DEFAULT);
-
     // useless write just to force callback call
 
     auto enable = g_settings_get_boolean(settings, "state");
@@ -78,6 +50,32 @@ Maximizer::~Maximizer() {
   util::debug(log_tag + name + " destroyed");
 }
 
+void Maximizer::create_bin() {
+  maximizer =
+      gst_element_factory_make("ladspa-zamaximx2-ladspa-so-zamaximx2", nullptr);
+
+  auto in_level =
+      gst_element_factory_make("pegainmeter", "maximizer_input_level");
+  auto out_level =
+      gst_element_factory_make("pegainmeter", "maximizer_output_level");
+  auto audioconvert_in = make_converter(maximizer, "sink");
+  auto audioconvert_out = make_converter(maximizer, "src");
+
+  add_to_bin({in_level, audioconvert_in, maximizer, audioconvert_out,
+              out_level});
+
+  bind_to_gsettings();
+
+  g_settings_bind(settings, "post-messages", in_level, "post-messages",
+                  G_SETTINGS_BIND_DEFAULT);
+  g_settings_bind(settings, "post-messages", out_level, "post-messages",
+                  G_SETTINGS_BIND_DEFAULT);
+}
+
+void Maximizer::release_bin() {
+  maximizer = nullptr;
+}
+
 void Maximizer::bind_to_gsettings() {
   g_settings_bind_with_mapping(settings, "release", maximizer, "release",
                                G_SETTINGS_BIND_GET, util::double_to_float,
@@ -13,6 +13,10 @@ void on_post_messages_changed(GSettings* settings,
     if (!l->input_level_connection.connected()) {
       l->input_level_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->multiband_compressor == nullptr) {
+              return true;
+            }
+
             float inL, inR;
 
             g_object_get(l->multiband_compressor, "meter-inL", &inL, nullptr);
@@ -30,6 +34,10 @@ void on_post_messages_changed(GSettings* settings,
     if (!l->output_level_connection.connected()) {
       l->output_level_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->multiband_compressor == nullptr) {
+              return true;
+            }
+
             float outL, outR;
 
             g_object_get(l->multiband_compressor, "meter-outL", &outL, nullptr);
@@ -47,6 +55,10 @@ void on_post_messages_changed(GSettings* settings,
     if (!l->output0_connection.connected()) {
       l->output0_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->multiband_compressor == nullptr) {
+              return true;
+            }
+
             float output;
 
             g_object_get(l->multiband_compressor, "output0", &output, nullptr);
@@ -61,6 +73,10 @@ void on_post_messages_changed(GSettings* settings,
     if (!l->output1_connection.connected()) {
       l->output1_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->multiband_compressor == nullptr) {
+              return true;
+            }
+
             float output;
 
             g_object_get(l->multiband_compressor, "output1", &output, nullptr);
@@ -75,6 +91,10 @@ void on_post_messages_changed(GSettings* settings,
     if (!l->output2_connection.connected()) {
       l->output2_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->multiband_compressor == nullptr) {
+              return true;
+            }
+
             float output;
 
             g_object_get(l->multiband_compressor, "output2", &output, nullptr);
@@ -89,6 +109,10 @@ void on_post_messages_changed(GSettings* settings,
     if (!l->output3_connection.connected()) {
       l->output3_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->multiband_compressor == nullptr) {
+              return true;
+            }
+
             float output;
 
             g_object_get(l->multiband_compressor, "output3", &output, nullptr);
@@ -103,6 +127,10 @@ void on_post_messages_changed(GSettings* settings,
     if (!l->compression0_connection.connected()) {
       l->compression0_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->multiband_compressor == nullptr) {
+              return true;
+            }
+
             float compression;
 
             g_object_get(l->multiband_compressor, "compression0", &compression,
@@ -118,6 +146,10 @@ void on_post_messages_changed(GSettings* settings,
     if (!l->compression1_connection.connected()) {
       l->compression1_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->multiband_compressor == nullptr) {
+              return true;
+            }
+
             float compression;
 
             g_object_get(l->multiband_compressor, "compression1", &compression,
@@ -133,6 +165,10 @@ void on_post_messages_changed(GSettings* settings,
     if (!l->compression2_connection.connected()) {
       l->compression2_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->multiband_compressor == nullptr) {
+              return true;
+            }
+
             float compression;
 
             g_object_get(l->multiband_compressor, "compression2", &compression,
@@ -148,6 +184,10 @@ void on_post_messages_changed(GSettings* settings,
     if (!l->compression3_connection.connected()) {
       l->compression3_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->multiband_compressor == nullptr) {
+              return true;
+            }
+
             float compression;
 
             g_object_get(l->multiband_compressor, "compression3", &compression,
@@ -177,34 +217,7 @@ void on_post_messages_changed(GSettings* settings,
 MultibandCompressor::MultibandCompressor(const std::string& tag,
                                          const std::string& schema)
     : PluginBase(tag, "multiband_compressor", schema) {
-  multiband_compressor = gst_element_factory_make(
-      "calf-sourceforge-net-plugins-MultibandCompressor", nullptr);
-
-  if (is_installed(multiband_compressor)) {
-    auto audioconvert_in = gst_element_factory_make(
-        "audioconvert", "multiband_compressor_audioconvert_in");
-    auto audioconvert_out = gst_element_factory_make(
-        "audioconvert", "multiband_compressor_audioconvert_out");
-
-    gst_bin_add_many(GST_BIN(bin), audioconvert_in, multiband_compressor,
-                     audioconvert_out, nullptr);
-
-    gst_element_link_many(audioconvert_in, multiband_compressor,
-                          audioconvert_out, nullptr);
-
-    auto pad_sink = gst_element_get_static_pad(audioconvert_in, "sink");
-    auto pad_src = gst_element_get_static_pad(audioconvert_out, "src");
-
-    gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad_sink));
-    gst_element_add_pad(bin, gst_ghost_pad_new("src", pad_src));
-
-    gst_object_unref(GST_OBJECT(pad_sink));
-    gst_object_unref(GST_OBJECT(pad_src));
-
-    g_object_set(multiband_compressor, "bypass", false, nullptr);
-
-    bind_to_gsettings();
-
+  if (is_installed("calf-sourceforge-net-plugins-MultibandCompressor")) {
     g_signal_connect(settings, "changed::post-messages",
                      G_CALLBACK(on_post_messages_changed), this);
 
@@ -220,6 +233,24 @@ MultibandCompressor::~MultibandCompressor() {
   util::debug(log_tag + name + " destroyed");
 }
 
+void MultibandCompressor::create_bin() {
+  multiband_compressor = gst_element_factory_make(
+      "calf-sourceforge-net-plugins-MultibandCompressor", nullptr);
+
+  auto audioconvert_in = make_converter(multiband_compressor, "sink");
+  auto audioconvert_out = make_converter(multiband_compressor, "src");
+
+  add_to_bin({audioconvert_in, multiband_compressor, audioconvert_out});
+
+  g_object_set(multiband_compressor, "bypass", false, nullptr);
+
+  bind_to_gsettings();
+}
+
+void MultibandCompressor::release_bin() {
+  multiband_compressor = nullptr;
+}
+
 void MultibandCompressor::bind_to_gsettings() {
   g_settings_bind_with_mapping(settings, "input-gain", multiband_compressor,
                                "level-in", G_SETTINGS_BIND_DEFAULT,
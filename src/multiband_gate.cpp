@@ -13,6 +13,10 @@ void on_post_messages_changed(GSettings* settings,
     if (!l->input_level_connection.connected()) {
       l->input_level_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->multiband_gate == nullptr) {
+              return true;
+            }
+
             float inL, inR;
 
             g_object_get(l->multiband_gate, "meter-inL", &inL, nullptr);
@@ -30,6 +34,10 @@ void on_post_messages_changed(GSettings* settings,
     if (!l->output_level_connection.connected()) {
       l->output_level_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->multiband_gate == nullptr) {
+              return true;
+            }
+
             float outL, outR;
 
             g_object_get(l->multiband_gate, "meter-outL", &outL, nullptr);
@@ -47,6 +55,10 @@ void on_post_messages_changed(GSettings* settings,
     if (!l->output0_connection.connected()) {
       l->output0_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->multiband_gate == nullptr) {
+              return true;
+            }
+
             float output;
 
             g_object_get(l->multiband_gate, "output0", &output, nullptr);
@@ -61,6 +73,10 @@ void on_post_messages_changed(GSettings* settings,
     if (!l->output1_connection.connected()) {
       l->output1_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->multiband_gate == nullptr) {
+              return true;
+            }
+
             float output;
 
             g_object_get(l->multiband_gate, "output1", &output, nullptr);
@@ -75,6 +91,10 @@ void on_post_messages_changed(GSettings* settings,
     if (!l->output2_connection.connected()) {
       l->output2_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->multiband_gate == nullptr) {
+              return true;
+            }
+
             float output;
 
             g_object_get(l->multiband_gate, "output2", &output, nullptr);
@@ -89,6 +109,10 @@ void on_post_messages_changed(GSettings* settings,
     if (!l->output3_connection.connected()) {
       l->output3_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->multiband_gate == nullptr) {
+              return true;
+            }
+
             float output;
 
             g_object_get(l->multiband_gate, "output3", &output, nullptr);
@@ -103,6 +127,10 @@ void on_post_messages_changed(GSettings* settings,
     if (!l->gating0_connection.connected()) {
       l->gating0_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->multiband_gate == nullptr) {
+              return true;
+            }
+
             float gating;
 
             g_object_get(l->multiband_gate, "gating0", &gating, nullptr);
@@ -117,6 +145,10 @@ void on_post_messages_changed(GSettings* settings,
     if (!l->gating1_connection.connected()) {
       l->gating1_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->multiband_gate == nullptr) {
+              return true;
+            }
+
             float gating;
 
             g_object_get(l->multiband_gate, "gating1", &gating, nullptr);
@@ -131,6 +163,10 @@ void on_post_messages_changed(GSettings* settings,
     if (!l->gating2_connection.connected()) {
       l->gating2_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->multiband_gate == nullptr) {
+              return true;
+            }
+
             float gating;
 
             g_object_get(l->multiband_gate, "gating2", &gating, nullptr);
@@ -145,6 +181,10 @@ void on_post_messages_changed(GSettings* settings,
     if (!l->gating3_connection.connected()) {
       l->gating3_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->multiband_gate == nullptr) {
+              return true;
+            }
+
             float gating;
 
             g_object_get(l->multiband_gate, "gating3", &gating, nullptr);
@@ -172,33 +212,7 @@ void on_post_messages_changed(GSettings* settings,
 
 MultibandGate::MultibandGate(const std::string& tag, const std::string& schema)
     : PluginBase(tag, "multiband_gate", schema) {
-  multiband_gate = gst_element_factory_make(
-      "calf-sourceforge-net-plugins-MultibandGate", nullptr);
-
-  if (is_installed(multiband_gate)) {
-    auto audioconvert_in = gst_element_factory_make(
-        "audioconvert", "multiband_gate_audioconvert_in");
-    auto audioconvert_out = gst_element_factory_make(
-        "audioconvert", "multiband_gate_audioconvert_out");
-
-    gst_bin_add_many(GST_BIN(bin), audioconvert_in, multiband_gate,
-                     audioconvert_out, nullptr);
-    gst_element_link_many(audioconvert_in, multiband_gate, audioconvert_out,
-                          nullptr);
-
-    auto pad_sink = gst_element_get_static_pad(audioconvert_in, "sink");
-    auto pad_src = gst_element_get_static_pad(audioconvert_out, "src");
-
-    gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad_sink));
-    gst_element_add_pad(bin, gst_ghost_pad_new("src", pad_src));
-
-    gst_object_unref(GST_OBJECT(pad_sink));
-    gst_object_unref(GST_OBJECT(pad_src));
-
-    g_object_set(multiband_gate, "bypass", false, nullptr);
-
-    bind_to_gsettings();
-
+  if (is_installed("calf-sourceforge-net-plugins-MultibandGate")) {
     g_signal_connect(settings, "changed::post-messages",
                      G_CALLBACK(on_post_messages_changed), this);
 
@@ -214,6 +228,24 @@ MultibandGate::~MultibandGate() {
   util::debug(log_tag + name + " destroyed");
 }
 
+void MultibandGate::create_bin() {
+  multiband_gate = gst_element_factory_make(
+      "calf-sourceforge-net-plugins-MultibandGate", nullptr);
+
+  auto audioconvert_in = make_converter(multiband_gate, "sink");
+  auto audioconvert_out = make_converter(multiband_gate, "src");
+
+  add_to_bin({audioconvert_in, multiband_gate, audioconvert_out});
+
+  g_object_set(multiband_gate, "bypass", false, nullptr);
+
+  bind_to_gsettings();
+}
+
+void MultibandGate::release_bin() {
+  multiband_gate = nullptr;
+}
+
 void MultibandGate::bind_to_gsettings() {
   g_settings_bind_with_mapping(settings, "input-gain", multiband_gate,
                                "level-in", G_SETTINGS_BIND_DEFAULT,
@@ -503,12 +503,68 @@ void PipelineBase::get_latency() {
 
     util::debug(log_tag + "total latency: " + std::to_string(latency) + " ms");
 
+    /*
+      The total above already has the latency of the thread boundaries. We
+      also show it alone so the cost of the pipelining is known.
+    */
+
+    int queues_latency = GST_TIME_AS_MSECONDS(get_queues_latency());
+
+    if (queues_latency > 0) {
+      util::debug(log_tag + "thread boundaries latency: " +
+                  std::to_string(queues_latency) + " ms");
+    }
+
     Glib::signal_idle().connect_once([=] { new_latency.emit(latency); });
   }
 
   gst_query_unref(q);
 }
 
+GstClockTime PipelineBase::get_queues_latency() {
+  GstClockTime total = 0;
+  GValue item = G_VALUE_INIT;
+  bool done = false;
+
+  auto it = gst_bin_iterate_recurse(GST_BIN(effects_bin));
+
+  while (!done) {
+    switch (gst_iterator_next(it, &item)) {
+      case GST_ITERATOR_OK: {
+        auto e = GST_ELEMENT(g_value_get_object(&item));
+        auto factory = gst_element_get_factory(e);
+
+        if (factory != nullptr &&
+            GST_OBJECT_NAME(factory) == std::string("pequeue")) {
+          guint64 latency;
+
+          g_object_get(e, "latency", &latency, nullptr);
+
+          total += latency;
+        }
+
+        g_value_reset(&item);
+
+        break;
+      }
+      case GST_ITERATOR_RESYNC:
+        gst_iterator_resync(it);
+
+        total = 0;
+
+        break;
+      default:
+        done = true;
+        break;
+    }
+  }
+
+  g_value_unset(&item);
+  gst_iterator_free(it);
+
+  return total;
+}
+
 void PipelineBase::on_app_added(const std::shared_ptr<AppInfo>& app_info) {
   for (auto a : apps_list) {
     if (a->index == app_info->index) {
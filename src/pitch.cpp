@@ -4,58 +4,52 @@
 
 Pitch::Pitch(const std::string& tag, const std::string& schema)
     : PluginBase(tag, "pitch", schema) {
-  pitch = gst_element_factory_make(
-      "ladspa-ladspa-rubberband-so-rubberband-pitchshifter-stereo", "pitch");
-
-  if (is_installed(pitch)) {
-    auto input_gain = gst_element_factory_make("volume", nullptr);
-    auto in_level = gst_element_factory_make("level", "pitch_input_level");
-    auto output_gain = gst_element_factory_make("volume", nullptr);
-    auto out_level = gst_element_factory_make("level", "pitch_output_level");
-    auto audioconvert_in = gst_element_factory_make("audioconvert", nullptr);
-    auto audioconvert_out = gst_element_factory_make("audioconvert", nullptr);
-
-    gst_bin_add_many(GST_BIN(bin), input_gain, in_level, audioconvert_in, pitch,
-                     audioconvert_out, output_gain, out_level, nullptr);
-    gst_element_link_many(input_gain, in_level, audioconvert_in, pitch,
-                          audioconvert_out, output_gain, out_level, nullptr);
+  if (is_installed(
+          "ladspa-ladspa-rubberband-so-rubberband-pitchshifter-stereo")) {
+    // useless write just to force callback call
 
-    auto pad_sink = gst_element_get_static_pad(input_gain, "sink");
-    auto pad_src = gst_element_get_static_pad(out_level, "src");
+    auto enable = g_settings_get_boolean(settings, "state");
 
-    gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad_sink));
-    gst_element_add_pad(bin, gst_ghost_pad_new("src", pad_src));
+    g_settings_set_boolean(settings, "state", enable);
+  }
+}
 
-    gst_object_unref(GST_OBJECT(pad_sink));
-    gst_object_unref(GST_OBJECT(pad_src));
+Pitch::~Pitch() {
+  util::debug(log_tag + name + " destroyed");
+}
 
-    bind_to_gsettings();
+void Pitch::create_bin() {
+  pitch = gst_element_factory_make(
+      "ladspa-ladspa-rubberband-so-rubberband-pitchshifter-stereo", "pitch");
 
-    g_settings_bind(settings, "post-messages", in_level, "post-messages",
-                    G_SETTINGS_BIND_DEFAULT);
-    g_settings_bind(settings, "post-messages", out_level, "post-messages",
-                    G_SETTINGS_BIND_DEFAULT);
+  auto in_level = gst_element_factory_make("pegainmeter", "pitch_input_level");
+  auto out_level =
+      gst_element_factory_make("pegainmeter", "pitch_output_level");
+  auto audioconvert_in = make_converter(pitch, "sink");
+  auto audioconvert_out = make_converter(pitch, "src");
 
-    g_settings_bind_with_mapping(
-        settings, "input-gain", input_gain, "volume", G_SETTINGS_BIND_DEFAULT,
-        util::db20_gain_to_linear_double, util::linear_double_gain_to_db20,
-        nullptr, nullptr);
+  add_to_bin({in_level, audioconvert_in, pitch, audioconvert_out, out_level});
 
-    g_settings_bind_with_mapping(
-        settings, "output-gain", output_gain, "volume", G_SETTINGS_BIND_DEFAULT,
-        util::db20_gain_to_linear_double, util::linear_double_gain_to_db20,
-        nullptr, nullptr);
+  bind_to_gsettings();
 
-    // useless write just to force callback call
+  g_settings_bind(settings, "post-messages", in_level, "post-messages",
+                  G_SETTINGS_BIND_DEFAULT);
+  g_settings_bind(settings, "post-messages", out_level, "post-messages",
+                  G_SETTINGS_BIND_DEFAULT);
 
-    auto enable = g_settings_get_boolean(settings, "state");
+  g_settings_bind_with_mapping(
+      settings, "input-gain", in_level, "volume", G_SETTINGS_BIND_DEFAULT,
+      util::db20_gain_to_linear_double, util::linear_double_gain_to_db20,
+      nullptr, nullptr);
 
-    g_settings_set_boolean(settings, "state", enable);
-  }
+  g_settings_bind_with_mapping(
+      settings, "output-gain", out_level, "volume", G_SETTINGS_BIND_DEFAULT,
+      util::db20_gain_to_linear_double, util::linear_double_gain_to_db20,
+      nullptr, nullptr);
 }
 
-Pitch::~Pitch() {
-  util::debug(log_tag + name + " destroyed");
+void Pitch::release_bin() {
+  pitch = nullptr;
 }
 
 void Pitch::bind_to_gsettings() {
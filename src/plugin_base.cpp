@@ -115,6 +115,59 @@ GstPadProbeReturn on_pad_blocked(GstPad* pad,
   return GST_PAD_PROBE_OK;
 }
 
+/*
+  The bin of a disabled plugin is released after an idle period. If the pad
+  probe that removes it from the pipeline did not run yet we try again later.
+*/
+
+gboolean on_release_timeout(gpointer user_data) {
+  auto l = static_cast<PluginBase*>(user_data);
+
+  std::lock_guard<std::mutex> lock(l->plugin_mutex);
+
+  if (GST_OBJECT_PARENT(l->bin) != nullptr) {
+    return G_SOURCE_CONTINUE;
+  }
+
+  l->release();
+
+  return G_SOURCE_REMOVE;
+}
+
+/*
+  The time a buffer takes to go from identity_in to identity_out is the cost
+  of the plugin. Both probes run in the same streaming thread.
+*/
+
+GstPadProbeReturn on_buffer_in(GstPad* pad,
+                               GstPadProbeInfo* info,
+                               gpointer user_data) {
+  auto l = static_cast<PluginBase*>(user_data);
+
+  l->buffer_start = g_get_monotonic_time();
+
+  return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn on_buffer_out(GstPad* pad,
+                                GstPadProbeInfo* info,
+                                gpointer user_data) {
+  auto l = static_cast<PluginBase*>(user_data);
+
+  auto duration = GST_BUFFER_DURATION(GST_PAD_PROBE_INFO_BUFFER(info));
+
+  if (l->buffer_start != 0 && GST_CLOCK_TIME_IS_VALID(duration) &&
+      duration > 0) {
+    double dt = (g_get_monotonic_time() - l->buffer_start) * GST_USECOND;
+
+    l->load = 0.9 * l->load + 0.1 * dt / duration;
+  }
+
+  l->buffer_start = 0;
+
+  return GST_PAD_PROBE_OK;
+}
+
 }  // namespace
 
 PluginBase::PluginBase(const std::string& tag,
@@ -129,11 +182,16 @@ PluginBase::PluginBase(const std::string& tag,
   identity_out = gst_element_factory_make(
       "identity", std::string(name + "_plugin_bin_identity_out").c_str());
 
-  gst_bin_add_many(GST_BIN(plugin), identity_in, identity_out, nullptr);
-  gst_element_link_many(identity_in, identity_out, nullptr);
+  // it only starts a streaming thread when the pipeline asks for it
+
+  queue = gst_element_factory_make(
+      "pequeue", std::string(name + "_plugin_bin_queue").c_str());
+
+  gst_bin_add_many(GST_BIN(plugin), identity_in, identity_out, queue, nullptr);
+  gst_element_link_many(identity_in, identity_out, queue, nullptr);
 
   auto sinkpad = gst_element_get_static_pad(identity_in, "sink");
-  auto srcpad = gst_element_get_static_pad(identity_out, "src");
+  auto srcpad = gst_element_get_static_pad(queue, "src");
 
   gst_element_add_pad(plugin, gst_ghost_pad_new("sink", sinkpad));
   gst_element_add_pad(plugin, gst_ghost_pad_new("src", srcpad));
@@ -141,23 +199,43 @@ PluginBase::PluginBase(const std::string& tag,
   g_object_unref(sinkpad);
   g_object_unref(srcpad);
 
-  bin = gst_bin_new((name + "_bin").c_str());
+  auto in_pad = gst_element_get_static_pad(identity_in, "src");
+  auto out_pad = gst_element_get_static_pad(identity_out, "src");
+
+  gst_pad_add_probe(in_pad, GST_PAD_PROBE_TYPE_BUFFER, on_buffer_in, this,
+                    nullptr);
+  gst_pad_add_probe(out_pad, GST_PAD_PROBE_TYPE_BUFFER, on_buffer_out, this,
+                    nullptr);
+
+  g_object_unref(in_pad);
+  g_object_unref(out_pad);
 }
 
 PluginBase::~PluginBase() {
-  auto enable = g_settings_get_boolean(settings, "state");
+  if (release_source != 0) {
+    g_source_remove(release_source);
+  }
 
-  gst_element_set_state(bin, GST_STATE_NULL);
+  if (bin != nullptr) {
+    gst_element_set_state(bin, GST_STATE_NULL);
 
-  if (!enable) {
     gst_object_unref(bin);
   }
 
   g_object_unref(settings);
 }
 
-bool PluginBase::is_installed(GstElement* e) {
-  if (e != nullptr) {
+/*
+  The factory is only looked up here. The elements are created by create_bin
+  when the plugin is enabled for the first time.
+*/
+
+bool PluginBase::is_installed(const std::string& factory_name) {
+  auto factory = gst_element_factory_find(factory_name.c_str());
+
+  if (factory != nullptr) {
+    gst_object_unref(factory);
+
     plugin_is_installed = true;
 
     g_settings_set_boolean(settings, "installed", true);
@@ -177,7 +255,121 @@ bool PluginBase::is_installed(GstElement* e) {
   }
 }
 
+/*
+  The pipeline caps are fixed to F32LE stereo interleaved. An audioconvert is
+  only needed next to elements that can not take it, like plugins with non
+  interleaved ports. Returns nullptr when no conversion is needed.
+*/
+
+GstElement* PluginBase::make_converter(GstElement* e,
+                                       const std::string& pad_name) {
+  auto pad = gst_element_get_static_pad(e, pad_name.c_str());
+
+  bool compatible = false;
+
+  if (pad != nullptr) {
+    auto caps = gst_pad_query_caps(pad, nullptr);
+    auto ours = gst_caps_from_string(
+        "audio/x-raw,format=F32LE,channels=2,layout=interleaved");
+
+    compatible = gst_caps_can_intersect(caps, ours);
+
+    gst_caps_unref(ours);
+    gst_caps_unref(caps);
+    gst_object_unref(pad);
+  }
+
+  bool input = (pad_name == "sink");
+
+  if (compatible) {
+    util::debug(log_tag + name + ": no audioconvert needed at the " +
+                (input ? "input" : "output"));
+
+    return nullptr;
+  }
+
+  util::debug(log_tag + name + ": audioconvert needed at the " +
+              (input ? "input" : "output"));
+
+  return gst_element_factory_make(
+      "audioconvert",
+      (name + (input ? "_audioconvert_in" : "_audioconvert_out")).c_str());
+}
+
+/*
+  Adds the elements to the bin, links them in order and makes the bin ghost
+  pads. nullptr entries are skipped.
+*/
+
+void PluginBase::add_to_bin(const std::vector<GstElement*>& elements) {
+  GstElement *first = nullptr, *last = nullptr;
+
+  for (auto e : elements) {
+    if (e == nullptr) {
+      continue;
+    }
+
+    gst_bin_add(GST_BIN(bin), e);
+
+    if (last != nullptr) {
+      gst_element_link(last, e);
+    } else {
+      first = e;
+    }
+
+    last = e;
+  }
+
+  auto pad_sink = gst_element_get_static_pad(first, "sink");
+  auto pad_src = gst_element_get_static_pad(last, "src");
+
+  gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad_sink));
+  gst_element_add_pad(bin, gst_ghost_pad_new("src", pad_src));
+
+  gst_object_unref(GST_OBJECT(pad_sink));
+  gst_object_unref(GST_OBJECT(pad_src));
+}
+
+/*
+  We keep our own reference to the bin. It survives being removed from the
+  plugin bin when the plugin is disabled and is only destroyed by release.
+*/
+
+void PluginBase::materialize() {
+  bin = gst_bin_new((name + "_bin").c_str());
+
+  gst_object_ref_sink(bin);
+
+  create_bin();
+
+  util::debug(log_tag + name + " bin was created");
+}
+
+void PluginBase::release() {
+  release_source = 0;
+
+  gst_element_set_state(bin, GST_STATE_NULL);
+
+  release_bin();
+
+  gst_object_unref(bin);
+
+  bin = nullptr;
+
+  util::debug(log_tag + name + " bin was released");
+}
+
 void PluginBase::enable() {
+  if (release_source != 0) {
+    g_source_remove(release_source);
+
+    release_source = 0;
+  }
+
+  if (bin == nullptr) {
+    materialize();
+  }
+
   auto srcpad = gst_element_get_static_pad(identity_in, "src");
 
   gst_pad_add_probe(srcpad, GST_PAD_PROBE_TYPE_IDLE,
@@ -196,6 +388,10 @@ void PluginBase::enable() {
 }
 
 void PluginBase::disable() {
+  if (bin == nullptr) {
+    return;
+  }
+
   auto srcpad = gst_element_get_static_pad(identity_in, "src");
 
   GstState state, pending;
@@ -220,4 +416,14 @@ void PluginBase::disable() {
   }
 
   g_object_unref(srcpad);
+
+  if (release_source == 0) {
+    auto app_settings = g_settings_new("com.github.wwmm.pulseeffects");
+
+    auto delay = g_settings_get_int(app_settings, "plugin-release-delay");
+
+    g_object_unref(app_settings);
+
+    release_source = g_timeout_add_seconds(delay, on_release_timeout, this);
+  }
 }
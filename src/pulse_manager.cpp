@@ -157,7 +157,8 @@ void PulseManager::subscribe_to_events() {
                     std::string s1 = "PulseEffects_apps.monitor";
                     std::string s2 = "PulseEffects_mic.monitor";
 
-                    if (info->name != s1 && info->name != s2) {
+                    if (info->name != s1 && info->name != s2 &&
+                        !is_app_sink(info->name)) {
                       auto pm = static_cast<PulseManager*>(d);
 
                       auto si = std::make_shared<mySourceInfo>();
@@ -192,7 +193,8 @@ void PulseManager::subscribe_to_events() {
                     std::string s1 = "PulseEffects_apps";
                     std::string s2 = "PulseEffects_mic";
 
-                    if (info->name != s1 && info->name != s2) {
+                    if (info->name != s1 && info->name != s2 &&
+                        !is_app_sink(info->name)) {
                       auto pm = static_cast<PulseManager*>(d);
 
                       auto si = std::make_shared<mySinkInfo>();
@@ -526,6 +528,48 @@ void PulseManager::load_mic_sink() {
   }
 }
 
+/*
+  In the parallel mode every application gets its own null sink. The
+  application is moved to it and its effects pipeline records from the sink
+  monitor.
+*/
+
+std::shared_ptr<mySinkInfo> PulseManager::load_app_sink(uint idx) {
+  std::string name = "PulseEffects_apps_" + std::to_string(idx);
+  std::string description =
+      "device.description=\"PulseEffects(apps_" + std::to_string(idx) + ")\"";
+
+  auto si = load_sink(name, description, apps_sink_info->rate);
+
+  if (si != nullptr) {
+    std::lock_guard<std::mutex> lock(app_sinks_mutex);
+
+    app_sinks[idx] = si;
+  }
+
+  return si;
+}
+
+void PulseManager::unload_app_sink(uint idx) {
+  std::shared_ptr<mySinkInfo> si;
+
+  {
+    std::lock_guard<std::mutex> lock(app_sinks_mutex);
+
+    auto it = app_sinks.find(idx);
+
+    if (it == app_sinks.end()) {
+      return;
+    }
+
+    si = it->second;
+
+    app_sinks.erase(it);
+  }
+
+  unload_module(si->owner_module);
+}
+
 void PulseManager::find_sink_inputs() {
   pa_threaded_mainloop_lock(main_loop);
 
@@ -604,7 +648,8 @@ void PulseManager::find_sinks() {
           std::string s1 = "PulseEffects_apps";
           std::string s2 = "PulseEffects_mic";
 
-          if (info->name != s1 && info->name != s2) {
+          if (info->name != s1 && info->name != s2 &&
+              !is_app_sink(info->name)) {
             auto si = std::make_shared<mySinkInfo>();
 
             si->name = info->name;
@@ -649,7 +694,8 @@ void PulseManager::find_sources() {
           std::string s1 = "PulseEffects_apps.monitor";
           std::string s2 = "PulseEffects_mic.monitor";
 
-          if (info->name != s1 && info->name != s2) {
+          if (info->name != s1 && info->name != s2 &&
+              !is_app_sink(info->name)) {
             auto si = std::make_shared<mySourceInfo>();
 
             si->name = info->name;
@@ -680,21 +726,51 @@ void PulseManager::find_sources() {
 
 void PulseManager::move_sink_input_to_pulseeffects(const std::string& name,
                                                    uint idx) {
+  uint sink_idx = apps_sink_info->index;
+
+  {
+    std::lock_guard<std::mutex> lock(app_sinks_mutex);
+
+    auto it = app_sinks.find(idx);
+
+    if (it != app_sinks.end()) {
+      sink_idx = it->second->index;
+    }
+  }
+
+  move_sink_input(name, idx, sink_idx);
+}
+
+/*
+  Moves the application to the main PulseEffects sink even if it still has a
+  sink of its own. Used when the parallel mode is disabled.
+*/
+
+bool PulseManager::move_sink_input_to_main(const std::string& name, uint idx) {
+  return move_sink_input(name, idx, apps_sink_info->index);
+}
+
+bool PulseManager::move_sink_input(const std::string& name,
+                                   uint idx,
+                                   uint sink_idx) {
   struct Data {
     std::string name;
     uint idx;
     PulseManager* pm;
+    bool success;
   };
 
-  Data data = {name, idx, this};
+  Data data = {name, idx, this, false};
 
   pa_threaded_mainloop_lock(main_loop);
 
   auto o = pa_context_move_sink_input_by_index(
-      context, idx, apps_sink_info->index,
+      context, idx, sink_idx,
       [](auto c, auto success, auto data) {
         auto d = static_cast<Data*>(data);
 
+        d->success = success;
+
         if (success) {
           util::debug(d->pm->log_tag + "sink input: " + d->name +
                       ", idx = " + std::to_string(d->idx) + " moved to PE");
@@ -720,6 +796,8 @@ void PulseManager::move_sink_input_to_pulseeffects(const std::string& name,
   }
 
   pa_threaded_mainloop_unlock(main_loop);
+
+  return data.success;
 }
 
 void PulseManager::remove_sink_input_from_pulseeffects(const std::string& name,
@@ -1128,6 +1206,20 @@ void PulseManager::unload_module(uint idx) {
 void PulseManager::unload_sinks() {
   util::debug(log_tag + "unloading PulseEffects sinks...");
 
+  std::vector<uint> apps;
+
+  {
+    std::lock_guard<std::mutex> lock(app_sinks_mutex);
+
+    for (auto& a : app_sinks) {
+      apps.push_back(a.first);
+    }
+  }
+
+  for (auto idx : apps) {
+    unload_app_sink(idx);
+  }
+
   unload_module(apps_sink_info->owner_module);
   unload_module(mic_sink_info->owner_module);
 }
@@ -1258,9 +1350,17 @@ void PulseManager::print_app_info(std::shared_ptr<AppInfo> info) {
 bool PulseManager::app_is_connected(const pa_sink_input_info* info) {
   if (info->sink == apps_sink_info->index) {
     return true;
-  } else {
-    return false;
   }
+
+  std::lock_guard<std::mutex> lock(app_sinks_mutex);
+
+  for (auto& a : app_sinks) {
+    if (info->sink == a.second->index) {
+      return true;
+    }
+  }
+
+  return false;
 }
 
 bool PulseManager::app_is_connected(const pa_source_output_info* info) {
@@ -22,6 +22,8 @@ gboolean blocksize_enum_to_int(GValue* value,
     g_value_set_int(value, 5);
   } else if (v == std::string("4096")) {
     g_value_set_int(value, 6);
+  } else if (v == std::string("auto")) {
+    g_value_set_int(value, 7);
   }
 
   return true;
@@ -44,8 +46,10 @@ GVariant* int_to_blocksize_enum(const GValue* value,
     return g_variant_new_string("1024");
   } else if (v == 5) {
     return g_variant_new_string("2048");
-  } else {
+  } else if (v == 6) {
     return g_variant_new_string("4096");
+  } else {
+    return g_variant_new_string("auto");
   }
 }
 
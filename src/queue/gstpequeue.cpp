@@ -0,0 +1,781 @@
+#include "gstpequeue.hpp"
+#include "config.h"
+#include "util.hpp"
+
+GST_DEBUG_CATEGORY_STATIC(pequeue_debug);
+#define GST_CAT_DEFAULT (pequeue_debug)
+
+static void gst_pequeue_set_property(GObject* object,
+                                     guint prop_id,
+                                     const GValue* value,
+                                     GParamSpec* pspec);
+
+static void gst_pequeue_get_property(GObject* object,
+                                     guint prop_id,
+                                     GValue* value,
+                                     GParamSpec* pspec);
+
+static GstFlowReturn gst_pequeue_chain(GstPad* pad,
+                                       GstObject* parent,
+                                       GstBuffer* buffer);
+
+static gboolean gst_pequeue_sink_event(GstPad* pad,
+                                       GstObject* parent,
+                                       GstEvent* event);
+
+static gboolean gst_pequeue_sink_query(GstPad* pad,
+                                       GstObject* parent,
+                                       GstQuery* query);
+
+static gboolean gst_pequeue_src_query(GstPad* pad,
+                                      GstObject* parent,
+                                      GstQuery* query);
+
+static gboolean gst_pequeue_sink_activate_mode(GstPad* pad,
+                                               GstObject* parent,
+                                               GstPadMode mode,
+                                               gboolean active);
+
+static gboolean gst_pequeue_src_activate_mode(GstPad* pad,
+                                              GstObject* parent,
+                                              GstPadMode mode,
+                                              gboolean active);
+
+static GstStateChangeReturn gst_pequeue_change_state(
+    GstElement* element,
+    GstStateChange transition);
+
+static void gst_pequeue_finalize(GObject* object);
+
+static void gst_pequeue_loop(gpointer user_data);
+
+static GstFlowReturn gst_pequeue_enqueue(GstPequeue* pequeue,
+                                         GstMiniObject* item);
+
+static void gst_pequeue_clear(GstPequeue* pequeue);
+
+static GstPadProbeReturn gst_pequeue_switch_mode(GstPad* pad,
+                                                 GstPadProbeInfo* info,
+                                                 gpointer user_data);
+
+static void gst_pequeue_remove_probe(GstPequeue* pequeue);
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE(
+    "sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE(
+    "src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+enum { PROP_THREADED = 1, PROP_MAX_SIZE, PROP_LATENCY };
+
+#define gst_pequeue_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE(
+    GstPequeue,
+    gst_pequeue,
+    GST_TYPE_ELEMENT,
+    GST_DEBUG_CATEGORY_INIT(pequeue_debug, "pequeue", 0, "Pequeue"));
+
+static void gst_pequeue_class_init(GstPequeueClass* klass) {
+  GObjectClass* gobject_class;
+  GstElementClass* gstelement_class;
+
+  gobject_class = (GObjectClass*)klass;
+  gstelement_class = (GstElementClass*)(klass);
+
+  gobject_class->set_property = gst_pequeue_set_property;
+  gobject_class->get_property = gst_pequeue_get_property;
+
+  gst_element_class_add_static_pad_template(gstelement_class, &srctemplate);
+  gst_element_class_add_static_pad_template(gstelement_class, &sinktemplate);
+
+  gstelement_class->change_state = gst_pequeue_change_state;
+
+  gobject_class->finalize = gst_pequeue_finalize;
+
+  gst_element_class_set_static_metadata(
+      gstelement_class, "Pequeue element", "Generic",
+      "Optional thread boundary based on a lock-free ring",
+      "Wellington <wellingtonwallace@gmail.com>");
+
+  g_object_class_install_property(
+      gobject_class, PROP_THREADED,
+      g_param_spec_boolean(
+          "threaded", "Threaded",
+          "Push the data downstream from a new streaming thread. While the "
+          "element is running the change is applied before the next buffer",
+          false,
+          static_cast<GParamFlags>(G_PARAM_READWRITE |
+                                   G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_MAX_SIZE,
+      g_param_spec_uint("max-size", "Maximum Size",
+                        "Maximum number of buffers and events waiting", 2, 64,
+                        4,
+                        static_cast<GParamFlags>(G_PARAM_READWRITE |
+                                                 G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property(
+      gobject_class, PROP_LATENCY,
+      g_param_spec_uint64("latency", "Latency",
+                          "Latency added to the pipeline in nanoseconds", 0,
+                          G_MAXUINT64, 0,
+                          static_cast<GParamFlags>(G_PARAM_READABLE |
+                                                   G_PARAM_STATIC_STRINGS)));
+}
+
+static void gst_pequeue_init(GstPequeue* pequeue) {
+  pequeue->threaded = false;
+  pequeue->max_size = 4;
+  pequeue->latency = 0;
+  pequeue->running = false;
+  pequeue->probe_id = 0;
+  pequeue->ring = nullptr;
+  pequeue->ring_size = 0;
+  pequeue->head = 0;
+  pequeue->tail = 0;
+  pequeue->sleepers = 0;
+  pequeue->flushing = 1;
+  pequeue->srcresult = GST_FLOW_FLUSHING;
+
+  g_mutex_init(&pequeue->lock);
+  g_cond_init(&pequeue->cond);
+
+  pequeue->srcpad = gst_pad_new_from_static_template(&srctemplate, "src");
+
+  GST_PAD_SET_PROXY_CAPS(pequeue->srcpad);
+  GST_PAD_SET_PROXY_ALLOCATION(pequeue->srcpad);
+
+  gst_pad_set_query_function(pequeue->srcpad,
+                             GST_DEBUG_FUNCPTR(gst_pequeue_src_query));
+
+  gst_pad_set_activatemode_function(
+      pequeue->srcpad, GST_DEBUG_FUNCPTR(gst_pequeue_src_activate_mode));
+
+  gst_element_add_pad(GST_ELEMENT(pequeue), pequeue->srcpad);
+
+  pequeue->sinkpad = gst_pad_new_from_static_template(&sinktemplate, "sink");
+
+  GST_PAD_SET_PROXY_CAPS(pequeue->sinkpad);
+  GST_PAD_SET_PROXY_ALLOCATION(pequeue->sinkpad);
+
+  gst_pad_set_chain_function(pequeue->sinkpad,
+                             GST_DEBUG_FUNCPTR(gst_pequeue_chain));
+
+  gst_pad_set_event_function(pequeue->sinkpad,
+                             GST_DEBUG_FUNCPTR(gst_pequeue_sink_event));
+
+  gst_pad_set_query_function(pequeue->sinkpad,
+                             GST_DEBUG_FUNCPTR(gst_pequeue_sink_query));
+
+  gst_pad_set_activatemode_function(
+      pequeue->sinkpad, GST_DEBUG_FUNCPTR(gst_pequeue_sink_activate_mode));
+
+  gst_element_add_pad(GST_ELEMENT(pequeue), pequeue->sinkpad);
+}
+
+static void gst_pequeue_set_property(GObject* object,
+                                     guint prop_id,
+                                     const GValue* value,
+                                     GParamSpec* pspec) {
+  GstPequeue* pequeue = GST_PEQUEUE(object);
+
+  GST_OBJECT_LOCK(pequeue);
+
+  switch (prop_id) {
+    case PROP_THREADED:
+      pequeue->threaded = g_value_get_boolean(value);
+
+      /*
+        When the pads are not active the mode is applied by the next
+        activation. Otherwise upstream is blocked before its next buffer and
+        the mode is switched in its thread.
+      */
+
+      if (pequeue->probe_id == 0 && GST_PAD_IS_ACTIVE(pequeue->sinkpad)) {
+        pequeue->probe_id = gst_pad_add_probe(
+            pequeue->sinkpad,
+            static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BLOCK |
+                                         GST_PAD_PROBE_TYPE_DATA_DOWNSTREAM),
+            gst_pequeue_switch_mode, pequeue, nullptr);
+      }
+
+      break;
+    case PROP_MAX_SIZE:
+      pequeue->max_size = g_value_get_uint(value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+      break;
+  }
+
+  GST_OBJECT_UNLOCK(pequeue);
+}
+
+static void gst_pequeue_get_property(GObject* object,
+                                     guint prop_id,
+                                     GValue* value,
+                                     GParamSpec* pspec) {
+  GstPequeue* pequeue = GST_PEQUEUE(object);
+
+  GST_OBJECT_LOCK(pequeue);
+
+  switch (prop_id) {
+    case PROP_THREADED:
+      g_value_set_boolean(value, pequeue->threaded);
+      break;
+    case PROP_MAX_SIZE:
+      g_value_set_uint(value, pequeue->max_size);
+      break;
+    case PROP_LATENCY:
+      g_value_set_uint64(value, pequeue->latency);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+      break;
+  }
+
+  GST_OBJECT_UNLOCK(pequeue);
+}
+
+/*
+  The data path does not take locks. A thread only takes the mutex when it has
+  to sleep because the ring is full or empty. The atomic operations are full
+  barriers, so either the sleeper sees the new index or the other thread sees
+  that somebody is sleeping and wakes it up.
+*/
+
+static void gst_pequeue_wake(GstPequeue* pequeue) {
+  if (g_atomic_int_get(&pequeue->sleepers) > 0) {
+    g_mutex_lock(&pequeue->lock);
+    g_cond_broadcast(&pequeue->cond);
+    g_mutex_unlock(&pequeue->lock);
+  }
+}
+
+template <typename Predicate>
+static void gst_pequeue_wait(GstPequeue* pequeue, Predicate ready) {
+  g_mutex_lock(&pequeue->lock);
+
+  g_atomic_int_inc(&pequeue->sleepers);
+
+  while (!ready() && !g_atomic_int_get(&pequeue->flushing)) {
+    g_cond_wait(&pequeue->cond, &pequeue->lock);
+  }
+
+  g_atomic_int_add(&pequeue->sleepers, -1);
+
+  g_mutex_unlock(&pequeue->lock);
+}
+
+static bool gst_pequeue_is_empty(GstPequeue* pequeue) {
+  return g_atomic_int_get(&pequeue->head) == g_atomic_int_get(&pequeue->tail);
+}
+
+static GstFlowReturn gst_pequeue_enqueue(GstPequeue* pequeue,
+                                         GstMiniObject* item) {
+  gint tail = g_atomic_int_get(&pequeue->tail);
+  gint next = (tail + 1) % pequeue->ring_size;
+
+  auto ready = [&]() {
+    return next != g_atomic_int_get(&pequeue->head) ||
+           g_atomic_int_get(&pequeue->srcresult) != GST_FLOW_OK;
+  };
+
+  if (!ready()) {
+    gst_pequeue_wait(pequeue, ready);
+  }
+
+  if (g_atomic_int_get(&pequeue->flushing)) {
+    gst_mini_object_unref(item);
+
+    return GST_FLOW_FLUSHING;
+  }
+
+  auto ret = static_cast<GstFlowReturn>(g_atomic_int_get(&pequeue->srcresult));
+
+  if (ret != GST_FLOW_OK) {
+    gst_mini_object_unref(item);
+
+    return ret;
+  }
+
+  pequeue->ring[tail] = item;
+
+  g_atomic_int_set(&pequeue->tail, next);
+
+  gst_pequeue_wake(pequeue);
+
+  return GST_FLOW_OK;
+}
+
+static void gst_pequeue_loop(gpointer user_data) {
+  GstPequeue* pequeue = GST_PEQUEUE(user_data);
+
+  gint head = g_atomic_int_get(&pequeue->head);
+
+  auto ready = [&]() { return head != g_atomic_int_get(&pequeue->tail); };
+
+  if (!ready()) {
+    gst_pequeue_wait(pequeue, ready);
+  }
+
+  if (g_atomic_int_get(&pequeue->flushing)) {
+    gst_pad_pause_task(pequeue->srcpad);
+
+    return;
+  }
+
+  GstMiniObject* item = pequeue->ring[head];
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  pequeue->ring[head] = nullptr;
+
+  if (GST_IS_BUFFER(item)) {
+    ret = gst_pad_push(pequeue->srcpad, GST_BUFFER_CAST(item));
+  } else {
+    GstEvent* event = GST_EVENT_CAST(item);
+
+    bool eos = GST_EVENT_TYPE(event) == GST_EVENT_EOS;
+
+    gst_pad_push_event(pequeue->srcpad, event);
+
+    if (eos) {
+      ret = GST_FLOW_EOS;
+    }
+  }
+
+  // the slot is released only now so an empty ring means nothing in flight
+
+  if (ret != GST_FLOW_OK) {
+    g_atomic_int_set(&pequeue->srcresult, ret);
+  }
+
+  g_atomic_int_set(&pequeue->head, (head + 1) % pequeue->ring_size);
+
+  gst_pequeue_wake(pequeue);
+
+  if (ret == GST_FLOW_FLUSHING) {
+    gst_pad_pause_task(pequeue->srcpad);
+  } else if (ret < GST_FLOW_EOS) {
+    GST_ELEMENT_FLOW_ERROR(pequeue, ret);
+
+    gst_pad_pause_task(pequeue->srcpad);
+  }
+}
+
+static GstFlowReturn gst_pequeue_chain(GstPad* pad,
+                                       GstObject* parent,
+                                       GstBuffer* buffer) {
+  GstPequeue* pequeue = GST_PEQUEUE(parent);
+
+  if (!pequeue->running) {
+    return gst_pad_push(pequeue->srcpad, buffer);
+  }
+
+  /*
+    While the stage downstream works on a buffer the next one is processed
+    upstream. The output can be late by up to one buffer and this is the
+    latency we report.
+  */
+
+  GstClockTime duration = GST_BUFFER_DURATION(buffer);
+
+  if (GST_CLOCK_TIME_IS_VALID(duration)) {
+    bool changed = false;
+
+    GST_OBJECT_LOCK(pequeue);
+
+    if (duration != pequeue->latency) {
+      pequeue->latency = duration;
+
+      changed = true;
+    }
+
+    GST_OBJECT_UNLOCK(pequeue);
+
+    if (changed) {
+      util::debug(std::string(GST_OBJECT_NAME(pequeue)) + ": latency " +
+                  std::to_string(GST_TIME_AS_USECONDS(duration)) + " us");
+
+      gst_element_post_message(
+          GST_ELEMENT_CAST(pequeue),
+          gst_message_new_latency(GST_OBJECT_CAST(pequeue)));
+    }
+  }
+
+  return gst_pequeue_enqueue(pequeue, GST_MINI_OBJECT_CAST(buffer));
+}
+
+static gboolean gst_pequeue_sink_event(GstPad* pad,
+                                       GstObject* parent,
+                                       GstEvent* event) {
+  GstPequeue* pequeue = GST_PEQUEUE(parent);
+  gboolean ret = true;
+
+  if (!pequeue->running) {
+    return gst_pad_push_event(pequeue->srcpad, event);
+  }
+
+  switch (GST_EVENT_TYPE(event)) {
+    case GST_EVENT_FLUSH_START:
+      ret = gst_pad_push_event(pequeue->srcpad, event);
+
+      g_atomic_int_set(&pequeue->flushing, 1);
+
+      gst_pequeue_wake(pequeue);
+
+      gst_pad_pause_task(pequeue->srcpad);
+
+      break;
+    case GST_EVENT_FLUSH_STOP:
+      gst_pequeue_clear(pequeue);
+
+      g_atomic_int_set(&pequeue->srcresult, GST_FLOW_OK);
+      g_atomic_int_set(&pequeue->flushing, 0);
+
+      ret = gst_pad_push_event(pequeue->srcpad, event);
+
+      gst_pad_start_task(pequeue->srcpad, gst_pequeue_loop, pequeue, nullptr);
+
+      break;
+    default:
+      if (GST_EVENT_IS_SERIALIZED(event)) {
+        ret = gst_pequeue_enqueue(pequeue, GST_MINI_OBJECT_CAST(event)) ==
+              GST_FLOW_OK;
+      } else {
+        ret = gst_pad_push_event(pequeue->srcpad, event);
+      }
+
+      break;
+  }
+
+  return ret;
+}
+
+/*
+  Serialized queries like ALLOCATION must see the data before them already
+  processed downstream. We wait until the ring is empty and answer them from
+  the thread upstream.
+*/
+
+static gboolean gst_pequeue_sink_query(GstPad* pad,
+                                       GstObject* parent,
+                                       GstQuery* query) {
+  GstPequeue* pequeue = GST_PEQUEUE(parent);
+
+  if (pequeue->running && GST_QUERY_IS_SERIALIZED(query)) {
+    auto ready = [&]() {
+      return gst_pequeue_is_empty(pequeue) ||
+             g_atomic_int_get(&pequeue->srcresult) != GST_FLOW_OK;
+    };
+
+    if (!ready()) {
+      gst_pequeue_wait(pequeue, ready);
+    }
+
+    if (g_atomic_int_get(&pequeue->flushing)) {
+      return false;
+    }
+  }
+
+  return gst_pad_query_default(pad, parent, query);
+}
+
+static gboolean gst_pequeue_src_query(GstPad* pad,
+                                      GstObject* parent,
+                                      GstQuery* query) {
+  GstPequeue* pequeue = GST_PEQUEUE(parent);
+  bool ret = true;
+
+  switch (GST_QUERY_TYPE(query)) {
+    case GST_QUERY_LATENCY:
+      ret = gst_pad_peer_query(pequeue->sinkpad, query);
+
+      if (ret && pequeue->running) {
+        GstClockTime min, max, latency;
+        gboolean live;
+
+        gst_query_parse_latency(query, &live, &min, &max);
+
+        GST_OBJECT_LOCK(pequeue);
+
+        latency = pequeue->latency;
+
+        GST_OBJECT_UNLOCK(pequeue);
+
+        /* add our own latency */
+
+        min += latency;
+
+        if (max != GST_CLOCK_TIME_NONE) {
+          max += latency * (pequeue->ring_size - 1);
+        }
+
+        gst_query_set_latency(query, live, min, max);
+      }
+
+      break;
+    default:
+      /* just call the default handler */
+      ret = gst_pad_query_default(pad, parent, query);
+      break;
+  }
+
+  return ret;
+}
+
+/*
+  Pads are deactivated before the ring is cleared. After the sink pad is
+  deactivated upstream can not be inside our chain function anymore.
+*/
+
+static gboolean gst_pequeue_sink_activate_mode(GstPad* pad,
+                                               GstObject* parent,
+                                               GstPadMode mode,
+                                               gboolean active) {
+  GstPequeue* pequeue = GST_PEQUEUE(parent);
+
+  if (mode != GST_PAD_MODE_PUSH) {
+    return false;
+  }
+
+  if (!active) {
+    g_atomic_int_set(&pequeue->flushing, 1);
+
+    gst_pequeue_wake(pequeue);
+  }
+
+  return true;
+}
+
+static gboolean gst_pequeue_src_activate_mode(GstPad* pad,
+                                              GstObject* parent,
+                                              GstPadMode mode,
+                                              gboolean active) {
+  GstPequeue* pequeue = GST_PEQUEUE(parent);
+
+  if (mode != GST_PAD_MODE_PUSH) {
+    return false;
+  }
+
+  if (active) {
+    GST_OBJECT_LOCK(pequeue);
+
+    pequeue->running = pequeue->threaded;
+    pequeue->latency = 0;
+
+    GST_OBJECT_UNLOCK(pequeue);
+
+    if (!pequeue->running) {
+      return true;
+    }
+
+    g_atomic_int_set(&pequeue->srcresult, GST_FLOW_OK);
+    g_atomic_int_set(&pequeue->flushing, 0);
+
+    return gst_pad_start_task(pad, gst_pequeue_loop, pequeue, nullptr);
+  }
+
+  if (!pequeue->running) {
+    return true;
+  }
+
+  g_atomic_int_set(&pequeue->flushing, 1);
+
+  gst_pequeue_wake(pequeue);
+
+  return gst_pad_stop_task(pad);
+}
+
+/*
+  Called from the streaming thread upstream while it is blocked before our
+  sink pad. Nothing can enter the ring while we are here. Before stopping the
+  task we wait until it has pushed everything it has.
+*/
+
+static GstPadProbeReturn gst_pequeue_switch_mode(GstPad* pad,
+                                                 GstPadProbeInfo* info,
+                                                 gpointer user_data) {
+  GstPequeue* pequeue = GST_PEQUEUE(user_data);
+
+  GST_OBJECT_LOCK(pequeue);
+
+  bool threaded = pequeue->threaded;
+
+  pequeue->probe_id = 0;
+
+  GST_OBJECT_UNLOCK(pequeue);
+
+  if (threaded == pequeue->running) {
+    return GST_PAD_PROBE_REMOVE;
+  }
+
+  if (threaded) {
+    gst_pequeue_clear(pequeue);
+
+    g_atomic_int_set(&pequeue->srcresult, GST_FLOW_OK);
+    g_atomic_int_set(&pequeue->flushing, 0);
+
+    GST_OBJECT_LOCK(pequeue);
+
+    pequeue->running = true;
+    pequeue->latency = 0;  // the chain function reports the new latency
+
+    GST_OBJECT_UNLOCK(pequeue);
+
+    gst_pad_start_task(pequeue->srcpad, gst_pequeue_loop, pequeue, nullptr);
+  } else {
+    auto ready = [&]() {
+      return gst_pequeue_is_empty(pequeue) ||
+             g_atomic_int_get(&pequeue->srcresult) != GST_FLOW_OK;
+    };
+
+    if (!ready()) {
+      gst_pequeue_wait(pequeue, ready);
+    }
+
+    g_atomic_int_set(&pequeue->flushing, 1);
+
+    gst_pequeue_wake(pequeue);
+
+    gst_pad_stop_task(pequeue->srcpad);
+
+    gst_pequeue_clear(pequeue);
+
+    GST_OBJECT_LOCK(pequeue);
+
+    pequeue->running = false;
+    pequeue->latency = 0;
+
+    GST_OBJECT_UNLOCK(pequeue);
+
+    gst_element_post_message(
+        GST_ELEMENT_CAST(pequeue),
+        gst_message_new_latency(GST_OBJECT_CAST(pequeue)));
+  }
+
+  util::debug(std::string(GST_OBJECT_NAME(pequeue)) +
+              ((threaded) ? ": threaded" : ": pass-through"));
+
+  return GST_PAD_PROBE_REMOVE;
+}
+
+static void gst_pequeue_remove_probe(GstPequeue* pequeue) {
+  GST_OBJECT_LOCK(pequeue);
+
+  gulong id = pequeue->probe_id;
+
+  pequeue->probe_id = 0;
+
+  GST_OBJECT_UNLOCK(pequeue);
+
+  if (id != 0) {
+    gst_pad_remove_probe(pequeue->sinkpad, id);
+  }
+}
+
+static void gst_pequeue_clear(GstPequeue* pequeue) {
+  for (guint n = 0; n < pequeue->ring_size; n++) {
+    if (pequeue->ring[n] != nullptr) {
+      gst_mini_object_unref(pequeue->ring[n]);
+
+      pequeue->ring[n] = nullptr;
+    }
+  }
+
+  g_atomic_int_set(&pequeue->head, 0);
+  g_atomic_int_set(&pequeue->tail, 0);
+}
+
+static GstStateChangeReturn gst_pequeue_change_state(
+    GstElement* element,
+    GstStateChange transition) {
+  GstStateChangeReturn ret = GST_STATE_CHANGE_SUCCESS;
+  GstPequeue* pequeue = GST_PEQUEUE(element);
+
+  /*up changes*/
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED: {
+      GST_OBJECT_LOCK(pequeue);
+
+      guint ring_size = pequeue->max_size + 1;
+
+      GST_OBJECT_UNLOCK(pequeue);
+
+      if (ring_size != pequeue->ring_size) {
+        gst_pequeue_clear(pequeue);
+
+        g_free(pequeue->ring);
+
+        pequeue->ring = g_new0(GstMiniObject*, ring_size);
+        pequeue->ring_size = ring_size;
+      }
+
+      break;
+    }
+    default:
+      break;
+  }
+
+  /*down changes*/
+
+  ret = GST_ELEMENT_CLASS(parent_class)->change_state(element, transition);
+
+  if (ret == GST_STATE_CHANGE_FAILURE)
+    return ret;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      // the next activation applies the threaded property anyway
+
+      gst_pequeue_remove_probe(pequeue);
+
+      gst_pequeue_clear(pequeue);
+
+      break;
+    default:
+      break;
+  }
+
+  return ret;
+}
+
+void gst_pequeue_finalize(GObject* object) {
+  GstPequeue* pequeue = GST_PEQUEUE(object);
+
+  GST_DEBUG_OBJECT(pequeue, "finalize");
+
+  /* clean up object here */
+
+  gst_pequeue_clear(pequeue);
+
+  g_free(pequeue->ring);
+
+  g_mutex_clear(&pequeue->lock);
+  g_cond_clear(&pequeue->cond);
+
+  G_OBJECT_CLASS(gst_pequeue_parent_class)->finalize(object);
+}
+
+static gboolean plugin_init(GstPlugin* plugin) {
+  return gst_element_register(plugin, "pequeue", GST_RANK_NONE,
+                              GST_TYPE_PEQUEUE);
+}
+
+GST_PLUGIN_DEFINE(GST_VERSION_MAJOR,
+                  GST_VERSION_MINOR,
+                  pequeue,
+                  "PulseEffects Thread Boundary",
+                  plugin_init,
+                  VERSION,
+                  "LGPL",
+                  PACKAGE,
+                  "https://github.com/wwmm/pulseeffects")
@@ -0,0 +1,72 @@
+#ifndef __GST_PEQUEUE_H__
+#define __GST_PEQUEUE_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_PEQUEUE (gst_pequeue_get_type())
+#define GST_PEQUEUE(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_PEQUEUE, GstPequeue))
+#define GST_PEQUEUE_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass), GST_TYPE_PEQUEUE, GstPequeueClass))
+#define GST_IS_PEQUEUE(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_PEQUEUE))
+#define GST_IS_PEQUEUE_CLASS(obj) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass), GST_TYPE_PEQUEUE))
+
+typedef struct _GstPequeue GstPequeue;
+typedef struct _GstPequeueClass GstPequeueClass;
+
+/**
+ * GstPequeue:
+ *
+ * The private pequeue structure
+ */
+struct _GstPequeue {
+  GstElement parent;
+
+  /* properties */
+
+  bool threaded;         // a streaming thread pushes the data downstream
+  guint max_size;        // maximum number of buffers and events waiting
+  GstClockTime latency;  // latency we add to the pipeline
+
+  /*< private >*/
+
+  bool running;    // threaded mode in use by the streaming thread
+  gulong probe_id;  // blocking probe that will apply a new threaded mode
+
+  /*
+    Single producer and single consumer ring. The streaming thread upstream
+    only writes tail and the one of our task only writes head. A slot is only
+    released after its data was pushed, so an empty ring means that everything
+    was delivered. One slot is always left free to tell a full ring from an
+    empty one.
+  */
+
+  GstMiniObject** ring;
+  guint ring_size;
+  gint head;
+  gint tail;
+
+  gint sleepers;  // threads waiting in cond
+  gint flushing;
+  gint srcresult;  // GstFlowReturn of the last push downstream
+
+  GMutex lock;  // only taken to sleep or to wake up a sleeping thread
+  GCond cond;
+
+  GstPad* srcpad;
+  GstPad* sinkpad;
+};
+
+struct _GstPequeueClass {
+  GstElementClass parent_class;
+};
+
+G_GNUC_INTERNAL GType gst_pequeue_get_type(void);
+
+G_END_DECLS
+
+#endif /* __GST_PEQUEUE_H__ */
@@ -63,6 +63,14 @@ void on_message_element(const GstBus* gst_bus,
   }
 }
 
+void on_parallel_sinkinputs_changed(GSettings* settings,
+                                    gchar* key,
+                                    SinkInputEffects* sie) {
+  // the applications are announced again and moved to the right pipeline
+
+  sie->pm->find_sink_inputs();
+}
+
 }  // namespace
 
 SinkInputEffects::SinkInputEffects(PulseManager* pulse_manager)
@@ -112,6 +120,57 @@ SinkInputEffects::SinkInputEffects(PulseManager* pulse_manager)
   pm->sink_input_removed.connect(
       sigc::mem_fun(*this, &SinkInputEffects::on_app_removed));
 
+  bind_to_gsettings();
+
+  // element message callback
+
+  g_signal_connect(bus, "message::element", G_CALLBACK(on_message_element),
+                   this);
+
+  init_plugins();
+
+  g_signal_connect(settings, "changed::parallel-sinkinputs",
+                   G_CALLBACK(on_parallel_sinkinputs_changed), this);
+}
+
+/*
+  Effects pipeline of a single application in the parallel mode. It records
+  from the application own sink and plays to the same device as the main
+  pipeline. Each one has its own streaming threads and the sound server mixes
+  their output.
+*/
+
+SinkInputEffects::SinkInputEffects(PulseManager* pulse_manager,
+                                   const std::shared_ptr<mySinkInfo>& app_sink,
+                                   const std::string& output_sink)
+    : PipelineBase("sie(" + app_sink->name + "): ", app_sink->rate),
+      log_tag("sie(" + app_sink->name + "): "),
+      pm(pulse_manager) {
+  std::string pulse_props =
+      "application.id=com.github.wwmm.pulseeffects.sinkinputs";
+
+  child_settings = g_settings_new("com.github.wwmm.pulseeffects.sinkinputs");
+
+  set_pulseaudio_props(pulse_props);
+
+  set_source_monitor_name(app_sink->monitor_source_name);
+
+  set_output_sink_name(output_sink);
+
+  bind_to_gsettings();
+
+  init_plugins();
+}
+
+SinkInputEffects::~SinkInputEffects() {
+  if (pipelining_source != 0) {
+    g_source_remove(pipelining_source);
+  }
+
+  util::debug(log_tag + "destroyed");
+}
+
+void SinkInputEffects::bind_to_gsettings() {
   g_settings_bind(settings, "buffer-out", source, "buffer-time",
                   G_SETTINGS_BIND_DEFAULT);
   g_settings_bind(settings, "latency-out", source, "latency-time",
@@ -123,12 +182,9 @@ SinkInputEffects::SinkInputEffects(PulseManager* pulse_manager)
 
   g_settings_bind(settings, "blocksize-out", adapter, "blocksize",
                   G_SETTINGS_BIND_DEFAULT);
+}
 
-  // element message callback
-
-  g_signal_connect(bus, "message::element", G_CALLBACK(on_message_element),
-                   this);
-
+void SinkInputEffects::init_plugins() {
   limiter = std::make_unique<Limiter>(
       log_tag, "com.github.wwmm.pulseeffects.sinkinputs.limiter");
   compressor = std::make_unique<Compressor>(
@@ -172,41 +228,66 @@ SinkInputEffects::SinkInputEffects(PulseManager* pulse_manager)
   delay = std::make_unique<Delay>(
       log_tag, "com.github.wwmm.pulseeffects.sinkinputs.delay");
 
-  plugins.insert(std::make_pair(limiter->name, limiter->plugin));
-  plugins.insert(std::make_pair(compressor->name, compressor->plugin));
-  plugins.insert(std::make_pair(filter->name, filter->plugin));
-  plugins.insert(std::make_pair(equalizer->name, equalizer->plugin));
-  plugins.insert(std::make_pair(reverb->name, reverb->plugin));
-  plugins.insert(std::make_pair(bass_enhancer->name, bass_enhancer->plugin));
-  plugins.insert(std::make_pair(exciter->name, exciter->plugin));
-  plugins.insert(std::make_pair(crossfeed->name, crossfeed->plugin));
-  plugins.insert(std::make_pair(maximizer->name, maximizer->plugin));
-  plugins.insert(
-      std::make_pair(multiband_compressor->name, multiband_compressor->plugin));
-  plugins.insert(std::make_pair(loudness->name, loudness->plugin));
-  plugins.insert(std::make_pair(gate->name, gate->plugin));
-  plugins.insert(std::make_pair(pitch->name, pitch->plugin));
-  plugins.insert(std::make_pair(multiband_gate->name, multiband_gate->plugin));
-  plugins.insert(std::make_pair(deesser->name, deesser->plugin));
-  plugins.insert(std::make_pair(stereo_tools->name, stereo_tools->plugin));
-  plugins.insert(std::make_pair(convolver->name, convolver->plugin));
-  plugins.insert(std::make_pair(crystalizer->name, crystalizer->plugin));
-  plugins.insert(std::make_pair(autogain->name, autogain->plugin));
-  plugins.insert(std::make_pair(delay->name, delay->plugin));
+  // the output device was chosen before autogain existed
+
+  gchar* device;
+
+  g_object_get(sink, "device", &device, nullptr);
+
+  if (device != nullptr) {
+    autogain->set_output_device(device);
+
+    g_free(device);
+  }
+
+  std::vector<PluginBase*> list = {
+      limiter.get(), compressor.get(), filter.get(), equalizer.get(),
+      reverb.get(), bass_enhancer.get(), exciter.get(), crossfeed.get(),
+      maximizer.get(), multiband_compressor.get(), loudness.get(), gate.get(),
+      pitch.get(), multiband_gate.get(), deesser.get(), stereo_tools.get(),
+      convolver.get(), crystalizer.get(), autogain.get(), delay.get()};
+
+  for (auto p : list) {
+    plugins.insert(std::make_pair(p->name, p->plugin));
+    plugin_bases.insert(std::make_pair(p->name, p));
+  }
 
   add_plugins_to_pipeline();
 
   g_signal_connect(child_settings, "changed::plugins",
                    G_CALLBACK(on_plugins_order_changed<SinkInputEffects>),
                    this);
+
+  g_signal_connect(child_settings, "changed::pipelining",
+                   G_CALLBACK(on_pipelining_changed<SinkInputEffects>), this);
+  g_signal_connect(child_settings, "changed::thread-boundaries",
+                   G_CALLBACK(on_pipelining_changed<SinkInputEffects>), this);
+
+  update_pipelining(this);
 }
 
-SinkInputEffects::~SinkInputEffects() {
-  util::debug(log_tag + "destroyed");
+void SinkInputEffects::set_output_sink_name(std::string name) {
+  PipelineBase::set_output_sink_name(name);
+
+  if (autogain != nullptr) {
+    autogain->set_output_device(name);
+  }
+
+  for (auto& a : app_pipelines) {
+    a.second->set_output_sink_name(name);
+  }
 }
 
+/*
+  Applications with their own pipeline are not counted by the main pipeline.
+  This way it does not process silence when all of them are in the parallel
+  mode.
+*/
+
 void SinkInputEffects::on_app_added(const std::shared_ptr<AppInfo>& app_info) {
-  PipelineBase::on_app_added(app_info);
+  if (!update_app_pipeline(app_info)) {
+    PipelineBase::on_app_added(app_info);
+  }
 
   auto enable_all = g_settings_get_boolean(settings, "enable-all-sinkinputs");
 
@@ -215,6 +296,112 @@ void SinkInputEffects::on_app_added(const std::shared_ptr<AppInfo>& app_info) {
   }
 }
 
+void SinkInputEffects::on_app_changed(
+    const std::shared_ptr<AppInfo>& app_info) {
+  if (update_app_pipeline(app_info)) {
+    PipelineBase::on_app_removed(app_info->index);
+  } else {
+    PipelineBase::on_app_added(app_info);
+    PipelineBase::on_app_changed(app_info);
+  }
+}
+
+void SinkInputEffects::on_app_removed(uint idx) {
+  remove_app_pipeline(idx);
+
+  PipelineBase::on_app_removed(idx);
+}
+
+/*
+  Returns true when the application is processed by its own pipeline.
+*/
+
+bool SinkInputEffects::update_app_pipeline(
+    const std::shared_ptr<AppInfo>& app_info) {
+  auto parallel = g_settings_get_boolean(settings, "parallel-sinkinputs");
+
+  auto it = app_pipelines.find(app_info->index);
+
+  if (parallel && app_info->connected) {
+    if (it == app_pipelines.end()) {
+      return add_app_pipeline(app_info);
+    }
+
+    it->second->PipelineBase::on_app_changed(app_info);
+
+    return true;
+  }
+
+  if (it != app_pipelines.end()) {
+    /*
+      The parallel mode was disabled. Back to the main pipeline before its
+      sink is unloaded. Otherwise PulseAudio moves the app to the default sink.
+      If the move fails the app keeps its pipeline and we try again on its next
+      change.
+    */
+
+    if (app_info->connected &&
+        !pm->move_sink_input_to_main(app_info->name, app_info->index)) {
+      it->second->PipelineBase::on_app_changed(app_info);
+
+      return true;
+    }
+
+    remove_app_pipeline(app_info->index);
+  }
+
+  return false;
+}
+
+bool SinkInputEffects::add_app_pipeline(
+    const std::shared_ptr<AppInfo>& app_info) {
+  auto app_sink = pm->load_app_sink(app_info->index);
+
+  if (app_sink == nullptr) {
+    util::warning(log_tag + "could not create a sink for " + app_info->name);
+
+    return false;
+  }
+
+  gchar* device;
+
+  g_object_get(sink, "device", &device, nullptr);
+
+  auto p = std::make_unique<SinkInputEffects>(pm, app_sink,
+                                              device != nullptr ? device : "");
+
+  g_free(device);
+
+  // each application keeps its own autogain measurements
+
+  p->autogain->set_app_name(app_info->name);
+
+  p->PipelineBase::on_app_added(app_info);
+
+  app_pipelines[app_info->index] = std::move(p);
+
+  pm->move_sink_input_to_pulseeffects(app_info->name, app_info->index);
+
+  util::debug(log_tag + app_info->name + " has its own effects pipeline");
+
+  return true;
+}
+
+void SinkInputEffects::remove_app_pipeline(uint idx) {
+  auto it = app_pipelines.find(idx);
+
+  if (it == app_pipelines.end()) {
+    return;
+  }
+
+  app_pipelines.erase(it);
+
+  pm->unload_app_sink(idx);
+
+  util::debug(log_tag + "removed the effects pipeline of the app " +
+              std::to_string(idx));
+}
+
 void SinkInputEffects::add_plugins_to_pipeline() {
   gchar* name;
   GVariantIter* iter;
@@ -367,6 +367,8 @@ void SinkInputEffectsUi::level_meters_connections() {
       sigc::mem_fun(*convolver_ui, &ConvolverUi::on_new_input_level_db)));
   connections.push_back(sie->convolver_output_level.connect(
       sigc::mem_fun(*convolver_ui, &ConvolverUi::on_new_output_level_db)));
+  connections.push_back(sie->convolver->kernel_frames.connect(
+      sigc::mem_fun(*convolver_ui, &ConvolverUi::on_new_kernel_frames)));
 
   // crystalizer level meters connections
 
@@ -124,27 +124,37 @@ SourceOutputEffects::SourceOutputEffects(PulseManager* pulse_manager)
   multiband_gate = std::make_unique<MultibandGate>(
       log_tag, "com.github.wwmm.pulseeffects.sourceoutputs.multibandgate");
 
-  plugins.insert(std::make_pair(limiter->name, limiter->plugin));
-  plugins.insert(std::make_pair(compressor->name, compressor->plugin));
-  plugins.insert(std::make_pair(filter->name, filter->plugin));
-  plugins.insert(std::make_pair(equalizer->name, equalizer->plugin));
-  plugins.insert(std::make_pair(reverb->name, reverb->plugin));
-  plugins.insert(std::make_pair(gate->name, gate->plugin));
-  plugins.insert(std::make_pair(deesser->name, deesser->plugin));
-  plugins.insert(std::make_pair(pitch->name, pitch->plugin));
-  plugins.insert(std::make_pair(webrtc->name, webrtc->plugin));
-  plugins.insert(
-      std::make_pair(multiband_compressor->name, multiband_compressor->plugin));
-  plugins.insert(std::make_pair(multiband_gate->name, multiband_gate->plugin));
+  std::vector<PluginBase*> list = {
+      limiter.get(), compressor.get(), filter.get(), equalizer.get(),
+      reverb.get(), gate.get(), deesser.get(), pitch.get(), webrtc.get(),
+      multiband_compressor.get(), multiband_gate.get()};
+
+  for (auto p : list) {
+    plugins.insert(std::make_pair(p->name, p->plugin));
+    plugin_bases.insert(std::make_pair(p->name, p));
+  }
 
   add_plugins_to_pipeline();
 
   g_signal_connect(child_settings, "changed::plugins",
                    G_CALLBACK(on_plugins_order_changed<SourceOutputEffects>),
                    this);
+
+  g_signal_connect(child_settings, "changed::pipelining",
+                   G_CALLBACK(on_pipelining_changed<SourceOutputEffects>),
+                   this);
+  g_signal_connect(child_settings, "changed::thread-boundaries",
+                   G_CALLBACK(on_pipelining_changed<SourceOutputEffects>),
+                   this);
+
+  update_pipelining(this);
 }
 
 SourceOutputEffects::~SourceOutputEffects() {
+  if (pipelining_source != 0) {
+    g_source_remove(pipelining_source);
+  }
+
   util::debug(log_tag + "destroyed");
 }
 
@@ -11,6 +11,10 @@ void on_post_messages_changed(GSettings* settings, gchar* key, StereoTools* l) {
     if (!l->input_level_connection.connected()) {
       l->input_level_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->stereo_tools == nullptr) {
+              return true;
+            }
+
             float inL, inR;
 
             g_object_get(l->stereo_tools, "meter-inL", &inL, nullptr);
@@ -28,6 +32,10 @@ void on_post_messages_changed(GSettings* settings, gchar* key, StereoTools* l) {
     if (!l->output_level_connection.connected()) {
       l->output_level_connection = Glib::signal_timeout().connect(
           [l]() {
+            if (l->stereo_tools == nullptr) {
+              return true;
+            }
+
             float outL, outR;
 
             g_object_get(l->stereo_tools, "meter-outL", &outL, nullptr);
@@ -51,34 +59,7 @@ void on_post_messages_changed(GSettings* settings, gchar* key, StereoTools* l) {
 
 StereoTools::StereoTools(const std::string& tag, const std::string& schema)
     : PluginBase(tag, "stereo_tools", schema) {
-  stereo_tools = gst_element_factory_make(
-      "calf-sourceforge-net-plugins-StereoTools", "stereo_tools");
-
-  if (is_installed(stereo_tools)) {
-    auto audioconvert_in = gst_element_factory_make(
-        "audioconvert", "stereo_tools_audioconvert_in");
-    auto audioconvert_out = gst_element_factory_make(
-        "audioconvert", "stereo_tools_audioconvert_out");
-
-    gst_bin_add_many(GST_BIN(bin), audioconvert_in, stereo_tools,
-                     audioconvert_out, nullptr);
-
-    gst_element_link_many(audioconvert_in, stereo_tools, audioconvert_out,
-                          nullptr);
-
-    auto pad_sink = gst_element_get_static_pad(audioconvert_in, "sink");
-    auto pad_src = gst_element_get_static_pad(audioconvert_out, "src");
-
-    gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad_sink));
-    gst_element_add_pad(bin, gst_ghost_pad_new("src", pad_src));
-
-    gst_object_unref(GST_OBJECT(pad_sink));
-    gst_object_unref(GST_OBJECT(pad_src));
-
-    g_object_set(stereo_tools, "bypass", false, nullptr);
-
-    bind_to_gsettings();
-
+  if (is_installed("calf-sourceforge-net-plugins-StereoTools")) {
     g_signal_connect(settings, "changed::post-messages",
                      G_CALLBACK(on_post_messages_changed), this);
 
@@ -94,6 +75,24 @@ StereoTools::~StereoTools() {
   util::debug(log_tag + name + " destroyed");
 }
 
+void StereoTools::create_bin() {
+  stereo_tools = gst_element_factory_make(
+      "calf-sourceforge-net-plugins-StereoTools", "stereo_tools");
+
+  auto audioconvert_in = make_converter(stereo_tools, "sink");
+  auto audioconvert_out = make_converter(stereo_tools, "src");
+
+  add_to_bin({audioconvert_in, stereo_tools, audioconvert_out});
+
+  g_object_set(stereo_tools, "bypass", false, nullptr);
+
+  bind_to_gsettings();
+}
+
+void StereoTools::release_bin() {
+  stereo_tools = nullptr;
+}
+
 void StereoTools::bind_to_gsettings() {
   g_settings_bind_with_mapping(
       settings, "input-gain", stereo_tools, "level-in", G_SETTINGS_BIND_DEFAULT,
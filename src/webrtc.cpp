@@ -6,14 +6,7 @@ Webrtc::Webrtc(const std::string& tag,
                const std::string& schema,
                const int& sampling_rate)
     : PluginBase(tag, "webrtc", schema), rate(sampling_rate) {
-  webrtc = gst_element_factory_make("webrtcdsp", nullptr);
-
-  if (is_installed(webrtc)) {
-    build_probe_bin();
-    build_dsp_bin();
-
-    bind_to_gsettings();
-
+  if (is_installed("webrtcdsp")) {
     // useless write just to force callback call
 
     auto enable = g_settings_get_boolean(settings, "state");
@@ -26,6 +19,21 @@ Webrtc::~Webrtc() {
   util::debug(log_tag + name + " destroyed");
 }
 
+void Webrtc::create_bin() {
+  webrtc = gst_element_factory_make("webrtcdsp", nullptr);
+
+  build_probe_bin();
+  build_dsp_bin();
+
+  bind_to_gsettings();
+}
+
+void Webrtc::release_bin() {
+  webrtc = nullptr;
+  probe_bin = nullptr;
+  probe_src = nullptr;
+}
+
 void Webrtc::build_probe_bin() {
   probe_bin = gst_bin_new("probe_bin");
 
@@ -44,10 +52,15 @@ void Webrtc::build_probe_bin() {
   auto caps = gst_caps_from_string(caps_str);
 
   g_object_set(probe_src, "stream-properties", props, nullptr);
+
   g_object_set(probe_src, "buffer-time", 10000, nullptr);
   g_object_set(capsfilter, "caps", caps, nullptr);
   g_object_set(queue, "silent", true, nullptr);
 
+  if (!probe_src_device.empty()) {
+    g_object_set(probe_src, "device", probe_src_device.c_str(), nullptr);
+  }
+
   gst_structure_free(props);
   gst_caps_unref(caps);
 
@@ -59,14 +72,15 @@ void Webrtc::build_probe_bin() {
 }
 
 void Webrtc::build_dsp_bin() {
-  auto in_level = gst_element_factory_make("level", "webrtc_input_level");
+  auto in_level = gst_element_factory_make("pegainmeter", "webrtc_input_level");
   auto audioconvert_in = gst_element_factory_make("audioconvert", nullptr);
   auto audioresample_in = gst_element_factory_make("audioresample", nullptr);
   auto caps_in = gst_element_factory_make("capsfilter", nullptr);
   auto audioconvert_out = gst_element_factory_make("audioconvert", nullptr);
   auto audioresample_out = gst_element_factory_make("audioresample", nullptr);
   auto caps_out = gst_element_factory_make("capsfilter", nullptr);
-  auto out_level = gst_element_factory_make("level", "webrtc_output_level");
+  auto out_level =
+      gst_element_factory_make("pegainmeter", "webrtc_output_level");
 
   auto capsin =
       gst_caps_from_string("audio/x-raw,channels=2,format=S16LE,rate=48000");
@@ -106,6 +120,8 @@ void Webrtc::build_dsp_bin() {
 }
 
 void Webrtc::set_probe_src_device(std::string name) {
+  probe_src_device = name;
+
   if (probe_src) {
     g_object_set(probe_src, "device", name.c_str(), nullptr);
   }